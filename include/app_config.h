@@ -6,10 +6,70 @@
 #define DHT_SENSOR_ENABLED 1
 #define DHT_SENSOR_IS_DHT22 0
 #define DHT_READ_INTERVAL_MS 15000
+#define DHT_RETRY_COUNT 2
+#define DHT_FILTER_WINDOW 5
+#define DHT_MIN_QUALITY 50
+// report-by-exception: send SensorState only when temperature/humidity move past the deadband (0.1 units),
+// at most every SENSOR_MIN_REPORT_INTERVAL_MS and at least every SENSOR_MAX_SILENCE_MS
+#define SENSOR_REPORT_ON_CHANGE 1
+#define SENSOR_DEADBAND_TEMP10 2
+#define SENSOR_DEADBAND_HUM10 10
+#define SENSOR_MIN_REPORT_INTERVAL_MS 5000
+#define SENSOR_MAX_SILENCE_MS 300000
+// sensor readings kept in RTC memory while the master is unreachable, replayed on relink
+#define SENSOR_HISTORY_CAPACITY 240
+#define SENSOR_HISTORY_REPLAY_INTERVAL_MS 250
+// local sensor/weather history on LittleFS (/data/ts), 512-byte blocks, file rotates after N blocks
+#define TIMESERIES_ENABLED 1
+#define TIMESERIES_MAX_BLOCKS 128
+// windowed min/max/mean/variance instead of raw SensorState when the master supports it;
+// raw readings stay available on request (SensorRawReq, served from the local history)
+#define SENSOR_AGGREGATE_ENABLED 1
+#define SENSOR_AGGREGATE_WINDOWS_S 300, 3600
+// aggregates closed while the master is unreachable, kept in RTC memory and sent after relink
+#define SENSOR_AGGREGATE_QUEUE_CAPACITY 12
+// small persisted items go to an append-only key-value log (/data/kv.log); compacted once dead
+// records make up KV_COMPACT_DEAD_PERCENT of a log of at least KV_COMPACT_MIN_BYTES
+#define KV_MAX_KEYS 32
+#define KV_COMPACT_DEAD_PERCENT 50
+#define KV_COMPACT_MIN_BYTES 4096
+// changed values are written at most this long after the first unsaved change (identical ones
+// never); flushed at once on low battery and restart
+#define PERSIST_FLUSH_WINDOW_MS 600000
 
 #define WEATHER_REPORT_ENABLED 1
 #define WEATHER_AREA_INDEX 1
 #define WEATHER_REPORT_INTERVAL_MS 3600000
 #define WEATHER_PROXY_REQUEST_INTERVAL_MS 3600000
 
+// batched sensor/battery/link upload through the master proxy (POST), replaces per-reading frames
+#define TELEMETRY_UPLOAD_ENABLED 0
+#define TELEMETRY_UPLOAD_URL ""
+#define TELEMETRY_BATCH_SIZE 20
+#define TELEMETRY_FLUSH_INTERVAL_MS 300000
+
+// offer ESP-NOW v2 large frames to the master (falls back to 250-byte frames with v1 masters)
+#define ESPNOW_LARGE_FRAME_ENABLED 1
+// ask the master for one XOR parity chunk per N proxy response chunks (0 = off)
+#define PROXY_FEC_GROUP_SIZE 4
+// field-level deltas for Sensor/Weather records when the master supports them, keyframe every N updates
+#define STATE_DELTA_ENABLED 1
+#define STATE_DELTA_KEYFRAME_INTERVAL 10
+
+// stretch sensor/battery/weather/telemetry intervals by battery state (4x when LOW, beacons only when CRITICAL)
+#define POWER_POLICY_ENABLED 1
+#define BATTERY_UPDATE_INTERVAL_MS 5000
+
+// MemStatsState (heap, PSRAM, JSON allocator counters, task stack high-water marks) to the master
+// when it supports FeatureMemStats; stretched by the power policy like telemetry
+#define MEM_STATS_ENABLED 1
+#define MEM_STATS_INTERVAL_MS 900000
+// serial log of the link counters (master request suppression, state delta savings), 0 disables
+#define LINK_STATS_LOG_INTERVAL_MS 900000
+// profiling mode: latency histograms of the radio/pipeline hot sections, per-coroutine and (with
+// FreeRTOS run-time stats in sdkconfig) per-task CPU, reported every PROFILE_REPORT_INTERVAL_MS
+// on serial and as ProfileState when the master supports FeatureProfile
+#define PROFILING_ENABLED 0
+#define PROFILE_REPORT_INTERVAL_MS 60000
+
 #define ENABLE_POWERSAVE 0
\ No newline at end of file
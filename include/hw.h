@@ -2,4 +2,14 @@
 
 #define DHT_SENSOR_PIN 5
 #define INPUT_BATTERY_ADC_PIN 32
-#define INPUT_BATTERY_CHARGE_PIN -1
\ No newline at end of file
+#define INPUT_BATTERY_CHARGE_PIN -1
+// charger status pin (e.g. TP4056 CHRG) level while charging
+#define INPUT_BATTERY_CHARGE_ACTIVE_LEVEL LOW
+// nameplate cell capacity, used with the load until a discharge rate has been measured
+#define INPUT_BATTERY_CAPACITY_MAH 1000
+// average draw: CPU and radio listening between reports, plus the periodic work (DHT reads,
+// transmits, proxy traffic) at normal report rates; the power policy scales the second part
+#define INPUT_BATTERY_BASE_MA 70
+#define INPUT_BATTERY_ACTIVITY_MA 10
+// per-board trim added to the divider-scaled battery voltage
+#define INPUT_BATTERY_OFFSET_MV 0
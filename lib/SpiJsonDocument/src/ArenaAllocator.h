@@ -0,0 +1,150 @@
+#pragma once
+#include "SpiAllocator.h"
+#include <string.h>
+
+struct ArenaStats {
+    size_t capacity = 0;
+    size_t used = 0;
+    size_t highWater = 0;
+    uint32_t allocations = 0;
+    uint32_t fallbackAllocations = 0;
+    size_t fallbackBytes = 0;
+};
+
+/**
+ * @brief Monotonic allocator for one JsonDocument: one block up front, bump allocation, bulk release
+ *
+ * Freeing or shrinking the most recent allocation gives the space back; anything else is only
+ * reclaimed when the arena is destroyed or reset. Requests that do not fit go to the heap
+ * (same caps as SpiAllocator), so a small arena degrades to the old behaviour instead of failing.
+ */
+class ArenaAllocator : public ArduinoJson::Allocator {
+public:
+    /**
+     * @brief Reserve the arena block
+     * @param capacity Arena size in bytes (0 = heap only)
+     * @param caps heap_caps flags for the block itself
+     */
+    explicit ArenaAllocator(size_t capacity, uint32_t caps = MALLOC_CAP_DEFAULT) {
+        if (capacity > 0) {
+            block = static_cast<uint8_t*>(heap_caps_malloc(capacity, caps));
+        }
+        counters.capacity = block != nullptr ? capacity : 0;
+    }
+
+    ~ArenaAllocator() {
+        heap_caps_free(block);
+    }
+
+    ArenaAllocator(const ArenaAllocator&) = delete;
+    ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+    void* allocate(size_t size) override {
+        counters.allocations++;
+        void* pointer = bump(size);
+        if (pointer != nullptr) {
+            return pointer;
+        }
+        counters.fallbackAllocations++;
+        counters.fallbackBytes += size;
+        return SpiAllocator::instance()->allocate(size);
+    }
+
+    void deallocate(void* pointer) override {
+        if (pointer == nullptr) {
+            return;
+        }
+        if (!owns(pointer)) {
+            SpiAllocator::instance()->deallocate(pointer);
+            return;
+        }
+        if (pointer == last) {
+            // the most recent allocation can be popped; older ones wait for the bulk release
+            counters.used = lastOffset;
+            last = nullptr;
+        }
+    }
+
+    void* reallocate(void* pointer, size_t newSize) override {
+        if (pointer == nullptr) {
+            return allocate(newSize);
+        }
+        if (!owns(pointer)) {
+            return SpiAllocator::instance()->reallocate(pointer, newSize);
+        }
+
+        const size_t oldSize = sizeOf(pointer);
+        if (pointer == last && lastOffset + kHeaderBytes + newSize <= counters.capacity) {
+            // grow or shrink in place at the top of the arena
+            setSize(pointer, newSize);
+            counters.used = align(lastOffset + kHeaderBytes + newSize);
+            counters.highWater = counters.used > counters.highWater ? counters.used : counters.highWater;
+            return pointer;
+        }
+        if (newSize <= oldSize) {
+            return pointer;
+        }
+
+        void* moved = allocate(newSize);
+        if (moved != nullptr) {
+            memcpy(moved, pointer, oldSize);
+        }
+        return moved;
+    }
+
+    /**
+     * @brief Drop every arena allocation at once; only valid when no document uses the memory
+     */
+    void reset() {
+        counters.used = 0;
+        last = nullptr;
+        lastOffset = 0;
+    }
+
+    const ArenaStats& stats() const {
+        return counters;
+    }
+
+private:
+    static constexpr size_t kAlign = 8;
+    static constexpr size_t kHeaderBytes = kAlign;  // holds the size, keeps the payload aligned
+
+    static size_t align(size_t value) {
+        return (value + kAlign - 1) & ~(kAlign - 1);
+    }
+
+    bool owns(const void* pointer) const {
+        const auto* bytes = static_cast<const uint8_t*>(pointer);
+        return block != nullptr && bytes >= block && bytes < block + counters.capacity;
+    }
+
+    static size_t sizeOf(const void* pointer) {
+        uint32_t size = 0;
+        memcpy(&size, static_cast<const uint8_t*>(pointer) - kHeaderBytes, sizeof(size));
+        return size;
+    }
+
+    static void setSize(void* pointer, size_t size) {
+        const uint32_t value = static_cast<uint32_t>(size);
+        memcpy(static_cast<uint8_t*>(pointer) - kHeaderBytes, &value, sizeof(value));
+    }
+
+    void* bump(size_t size) {
+        const size_t offset = counters.used;
+        if (block == nullptr || offset + kHeaderBytes + size > counters.capacity) {
+            return nullptr;
+        }
+        void* pointer = block + offset + kHeaderBytes;
+        setSize(pointer, size);
+        last = pointer;
+        lastOffset = offset;
+        counters.used = align(offset + kHeaderBytes + size);
+        counters.highWater = counters.used > counters.highWater ? counters.used : counters.highWater;
+        return pointer;
+    }
+
+    uint8_t* block = nullptr;
+    void* last = nullptr;
+    size_t lastOffset = 0;
+    ArenaStats counters;
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include "ArenaAllocator.h"
+
+// constructed before (and destroyed after) the JsonDocument that allocates from it
+struct ArenaHolder {
+    explicit ArenaHolder(size_t capacity, uint32_t caps) : arena(capacity, caps) {}
+    ArenaAllocator arena;
+};
+
+/**
+ * @brief JsonDocument backed by its own ArenaAllocator
+ *
+ * Meant for documents that are parsed, read and dropped or reloaded (config files, DataStore on
+ * boards without PSRAM): the whole document is one heap block, released in one free, so repeated
+ * parses do not fragment the internal heap. Not copyable; the arena belongs to this document.
+ */
+class ArenaJsonDocument : private ArenaHolder, public ArduinoJson::JsonDocument {
+public:
+    /**
+     * @brief Construct with an arena of `capacity` bytes
+     * @param capacity Arena size; overflow falls back to the heap
+     * @param caps heap_caps flags for the arena block
+     */
+    explicit ArenaJsonDocument(size_t capacity, uint32_t caps = MALLOC_CAP_DEFAULT)
+        : ArenaHolder(capacity, caps), ArduinoJson::JsonDocument(&arena) {
+    }
+
+    ArenaJsonDocument(const ArenaJsonDocument&) = delete;
+    ArenaJsonDocument& operator=(const ArenaJsonDocument&) = delete;
+
+    /**
+     * @brief Empty the document and rewind the arena, so the next parse starts at its first byte
+     */
+    void release() {
+        clear();
+        arena.reset();
+    }
+
+    /**
+     * @brief Arena usage, high-water mark and heap fallbacks
+     */
+    const ArenaStats& arenaStats() const {
+        return arena.stats();
+    }
+};
@@ -1,9 +1,19 @@
 #pragma once
 #include <ArduinoJson.h>
+#include <atomic>
+
+struct SpiAllocatorStats {
+    uint32_t allocations = 0;
+    uint32_t deallocations = 0;
+    uint32_t reallocations = 0;
+    uint32_t failures = 0;
+    size_t liveBytes = 0;
+    size_t peakBytes = 0;
+};
 
 struct SpiAllocator : ArduinoJson::Allocator {
     uint32_t getMemoryType() const {
-        return MALLOC_CAP_SPIRAM | MALLOC_CAP_DEFAULT;
+        return MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
     }
 
     /**
@@ -12,7 +22,15 @@ struct SpiAllocator : ArduinoJson::Allocator {
      * @return Pointer to allocated memory
      */
     void* allocate(size_t size) override {
-        return heap_caps_malloc(size, getMemoryType());
+        // both caps together would require PSRAM and fail outright on boards without it
+        void* pointer = heap_caps_malloc_prefer(size, 2, getMemoryType(), MALLOC_CAP_DEFAULT);
+        if (pointer == nullptr) {
+            failures.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        grow(heap_caps_get_allocated_size(pointer));
+        return pointer;
     }
 
     /**
@@ -20,6 +38,11 @@ struct SpiAllocator : ArduinoJson::Allocator {
      * @param pointer Pointer to memory to free
      */
     void deallocate(void* pointer) override {
+        if (pointer == nullptr) {
+            return;
+        }
+        deallocations.fetch_add(1, std::memory_order_relaxed);
+        liveBytes.fetch_sub(heap_caps_get_allocated_size(pointer), std::memory_order_relaxed);
         heap_caps_free(pointer);
     }
 
@@ -30,7 +53,32 @@ struct SpiAllocator : ArduinoJson::Allocator {
      * @return Pointer to reallocated memory
      */
     void* reallocate(void* ptr, size_t new_size) override {
-        return heap_caps_realloc(ptr, new_size, getMemoryType());
+        const size_t oldSize = ptr != nullptr ? heap_caps_get_allocated_size(ptr) : 0;
+        void* pointer = heap_caps_realloc_prefer(ptr, new_size, 2, getMemoryType(), MALLOC_CAP_DEFAULT);
+        if (pointer == nullptr) {
+            // the old block is still valid and still counted
+            failures.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        reallocations.fetch_add(1, std::memory_order_relaxed);
+        liveBytes.fetch_sub(oldSize, std::memory_order_relaxed);
+        grow(heap_caps_get_allocated_size(pointer));
+        return pointer;
+    }
+
+    /**
+     * @brief Snapshot of the allocation counters (every allocation made through SpiAllocator)
+     * @return Counters since boot; liveBytes/peakBytes include heap block overhead
+     */
+    SpiAllocatorStats stats() const {
+        SpiAllocatorStats out;
+        out.allocations = allocations.load(std::memory_order_relaxed);
+        out.deallocations = deallocations.load(std::memory_order_relaxed);
+        out.reallocations = reallocations.load(std::memory_order_relaxed);
+        out.failures = failures.load(std::memory_order_relaxed);
+        out.liveBytes = liveBytes.load(std::memory_order_relaxed);
+        out.peakBytes = peakBytes.load(std::memory_order_relaxed);
+        return out;
     }
 
     /**
@@ -41,4 +89,19 @@ struct SpiAllocator : ArduinoJson::Allocator {
         static SpiAllocator instance;
         return &instance;
     }
+
+private:
+    void grow(size_t bytes) {
+        const size_t live = liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t peak = peakBytes.load(std::memory_order_relaxed);
+        while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+        }
+    }
+
+    std::atomic<uint32_t> allocations{0};
+    std::atomic<uint32_t> deallocations{0};
+    std::atomic<uint32_t> reallocations{0};
+    std::atomic<uint32_t> failures{0};
+    std::atomic<size_t> liveBytes{0};
+    std::atomic<size_t> peakBytes{0};
 };
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "chunk_assembler.h"
+
+#include <cstring>
+
+namespace app::espnow {
+
+void ChunkAssembler::reset() {
+  active = false;
+  requestId = 0;
+  total = 0;
+  stride = 0;
+  received = 0;
+  dataReceived = 0;
+  receivedMask = 0;
+  lastLen = 0;
+  totalLength = 0;
+  status = 0;
+  statusCode = 0;
+}
+
+bool ChunkAssembler::begin(uint16_t newRequestId, uint16_t newTotal, size_t newStride) {
+  if (active && requestId == newRequestId && total == newTotal && stride == newStride) {
+    return true;
+  }
+
+  if (active && received < total) {
+    count(&Stats::abandoned);
+    finish();
+  }
+
+  reset();
+  if (buffer == nullptr || newTotal == 0 || newTotal > kMaxChunks || newStride == 0 || (newTotal - 1) * newStride >= kMaxBytes) {
+    return false;
+  }
+
+  active = true;
+  requestId = newRequestId;
+  total = newTotal;
+  stride = newStride;
+  return true;
+}
+
+ChunkAssembler::Stats ChunkAssembler::takeWindow() {
+  const Stats taken = window;
+  window = {};
+  return taken;
+}
+
+void ChunkAssembler::count(uint32_t Stats::*field, uint32_t amount) {
+  counters.*field += amount;
+  window.*field += amount;
+}
+
+void ChunkAssembler::finish() {
+  count(&Stats::expectedChunks, total);
+  count(&Stats::lostChunks, total - dataReceived);
+}
+
+void ChunkAssembler::store(uint16_t idx, const uint8_t* data, size_t dataLen) {
+  memcpy(buffer + (idx - 1) * stride, data, dataLen);
+  receivedMask |= 1ULL << (idx - 1);
+  received++;
+  if (idx == total) {
+    lastLen = dataLen;
+  }
+}
+
+ChunkAssembler::Result ChunkAssembler::completeIfDone() {
+  if (received < total) {
+    return Result::Pending;
+  }
+
+  totalLength = (total - 1) * stride + lastLen;
+  active = false;
+  hasCompleted = true;
+  completedId = requestId;
+  count(&Stats::responses);
+  finish();
+  return Result::Complete;
+}
+
+ChunkAssembler::Result ChunkAssembler::addData(uint16_t newRequestId,
+                                               uint16_t idx,
+                                               uint16_t newTotal,
+                                               uint8_t ok,
+                                               int16_t code,
+                                               size_t chunkStride,
+                                               const uint8_t* data,
+                                               size_t dataLen) {
+  if (idx == 0 || idx > newTotal || data == nullptr || dataLen > chunkStride) {
+    return Result::Rejected;
+  }
+
+  if (isLate(newRequestId)) {
+    count(&Stats::late);
+    return Result::Late;
+  }
+
+  if (!begin(newRequestId, newTotal, chunkStride)) {
+    return Result::Rejected;
+  }
+
+  // every chunk but the last is full, which is what lets chunks land at fixed offsets
+  if ((idx < total && dataLen != stride) || (idx - 1) * stride + dataLen > kMaxBytes) {
+    reset();
+    return Result::Rejected;
+  }
+
+  count(&Stats::dataChunks);
+  status = ok;
+  statusCode = code;
+  if (!has(idx)) {
+    store(idx, data, dataLen);
+    dataReceived++;
+  }
+  return completeIfDone();
+}
+
+ChunkAssembler::Result ChunkAssembler::addParity(uint16_t parityRequestId,
+                                                 uint16_t group,
+                                                 uint8_t groupSize,
+                                                 uint16_t parityTotal,
+                                                 uint8_t ok,
+                                                 int16_t code,
+                                                 uint16_t lenXor,
+                                                 const uint8_t* data,
+                                                 size_t dataLen) {
+  if (group == 0 || groupSize == 0 || data == nullptr) {
+    return Result::Rejected;
+  }
+
+  if (isLate(parityRequestId)) {
+    count(&Stats::late);
+    return Result::Late;
+  }
+
+  // parity is padded to the full chunk size, so it also tells us the stride
+  if (!begin(parityRequestId, parityTotal, dataLen)) {
+    return Result::Rejected;
+  }
+
+  count(&Stats::parityChunks);
+  status = ok;
+  statusCode = code;
+  const uint32_t first = static_cast<uint32_t>(group - 1) * groupSize + 1;
+  if (first > total) {
+    return Result::Rejected;
+  }
+  const uint16_t last = static_cast<uint16_t>(min<uint32_t>(first + groupSize - 1, total));
+
+  uint16_t missing = 0;
+  uint16_t missingIdx = 0;
+  for (uint16_t idx = static_cast<uint16_t>(first); idx <= last; ++idx) {
+    if (!has(idx)) {
+      missing++;
+      missingIdx = idx;
+    }
+  }
+
+  if (missing == 0) {
+    return Result::Pending;
+  }
+
+  if (missing > 1) {
+    count(&Stats::unrecoverable);
+    return Result::Pending;
+  }
+
+  uint8_t* target = buffer + (missingIdx - 1) * stride;
+  const size_t writable = min(stride, kMaxBytes - (missingIdx - 1) * stride);
+  uint16_t rebuiltLen = lenXor;
+  memcpy(target, data, writable);
+  for (uint16_t idx = static_cast<uint16_t>(first); idx <= last; ++idx) {
+    if (idx == missingIdx) {
+      continue;
+    }
+
+    const uint8_t* source = buffer + (idx - 1) * stride;
+    const size_t sourceLen = idx == total ? lastLen : stride;
+    for (size_t offset = 0; offset < sourceLen && offset < writable; ++offset) {
+      target[offset] ^= source[offset];
+    }
+    rebuiltLen ^= static_cast<uint16_t>(sourceLen);
+  }
+
+  if (rebuiltLen > writable || (missingIdx < total && rebuiltLen != stride)) {
+    count(&Stats::unrecoverable);
+    return Result::Pending;
+  }
+
+  receivedMask |= 1ULL << (missingIdx - 1);
+  received++;
+  if (missingIdx == total) {
+    lastLen = rebuiltLen;
+  }
+  count(&Stats::recovered);
+  return completeIfDone();
+}
+
+}  // namespace app::espnow
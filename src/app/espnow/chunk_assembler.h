@@ -0,0 +1,95 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace app::espnow {
+
+// Reassembles one proxy response from data chunks that may arrive out of order, and rebuilds a
+// single missing chunk per parity group from an XOR parity chunk. Frames that arrive for the
+// response that just completed (trailing parity, duplicates) are dropped as Late instead of
+// reopening it. Pure logic, no RTOS calls.
+class ChunkAssembler {
+ public:
+  static constexpr size_t kMaxBytes = 1024;
+  static constexpr uint16_t kMaxChunks = 64;
+
+  enum class Result : uint8_t {
+    Pending,
+    Complete,
+    Rejected,
+    Late,
+  };
+
+  struct Stats {
+    uint32_t responses = 0;
+    uint32_t dataChunks = 0;
+    uint32_t parityChunks = 0;
+    uint32_t recovered = 0;
+    uint32_t unrecoverable = 0;
+    uint32_t abandoned = 0;
+    uint32_t late = 0;
+    // data chunks of finished responses and how many of them never arrived as data
+    uint32_t expectedChunks = 0;
+    uint32_t lostChunks = 0;
+
+    float lossRate() const { return expectedChunks > 0 ? static_cast<float>(lostChunks) / expectedChunks : 0.0f; }
+  };
+
+  Result addData(uint16_t requestId,
+                 uint16_t idx,
+                 uint16_t total,
+                 uint8_t ok,
+                 int16_t code,
+                 size_t stride,
+                 const uint8_t* data,
+                 size_t dataLen);
+  Result addParity(uint16_t requestId,
+                   uint16_t group,
+                   uint8_t groupSize,
+                   uint16_t total,
+                   uint8_t ok,
+                   int16_t code,
+                   uint16_t lenXor,
+                   const uint8_t* data,
+                   size_t dataLen);
+  void reset();
+  // Reassembly storage of kMaxBytes, owned by the caller (placed by its memory tier).
+  void attachBuffer(uint8_t* storage) { buffer = storage; }
+
+  const uint8_t* data() const { return buffer; }
+  size_t length() const { return totalLength; }
+  uint16_t chunkCount() const { return total; }
+  uint8_t ok() const { return status; }
+  int16_t code() const { return statusCode; }
+  const Stats& stats() const { return counters; }
+  // Counters since the previous call, so the loss rate follows the current link instead of uptime.
+  Stats takeWindow();
+
+ private:
+  bool begin(uint16_t requestId, uint16_t total, size_t stride);
+  bool has(uint16_t idx) const { return (receivedMask & (1ULL << (idx - 1))) != 0; }
+  void store(uint16_t idx, const uint8_t* data, size_t dataLen);
+  Result completeIfDone();
+  bool isLate(uint16_t requestId) const { return hasCompleted && requestId == completedId; }
+  void count(uint32_t Stats::*field, uint32_t amount = 1);
+  void finish();
+
+  bool active = false;
+  uint16_t requestId = 0;
+  uint16_t total = 0;
+  size_t stride = 0;
+  uint16_t received = 0;
+  uint16_t dataReceived = 0;
+  uint64_t receivedMask = 0;
+  size_t lastLen = 0;
+  size_t totalLength = 0;
+  uint8_t status = 0;
+  int16_t statusCode = 0;
+  uint8_t* buffer = nullptr;
+  bool hasCompleted = false;
+  uint16_t completedId = 0;
+  Stats counters;
+  Stats window;
+};
+
+}  // namespace app::espnow
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Arduino.h>
+#include <esp_now.h>
 
 namespace app::espnow {
 
@@ -9,11 +10,24 @@ enum class PacketType : uint8_t {
   HEARTBEAT = 2,
   COMMAND = 3,
   STATE = 4,
+  STATE_DELTA = 5,  // state_binary::StateDeltaState, only after FeatureStateDelta is negotiated
 };
 
 static constexpr uint8_t PROTOCOL_VERSION = 1;
+static constexpr uint8_t PROTOCOL_VERSION_LARGE = 2;
 static constexpr uint8_t DEFAULT_CHANNEL = 1;
 static constexpr size_t MAX_PAYLOAD_SIZE = 200;
+static constexpr uint32_t HELLO_INTERVAL_MS = 7000;
+
+// ESP-NOW v2 frames (ESP-IDF >= 5.4) carry up to 1470 bytes; used only after the master agrees.
+#if defined(ESP_NOW_MAX_DATA_LEN_V2)
+static constexpr size_t MAX_LARGE_FRAME_SIZE = ESP_NOW_MAX_DATA_LEN_V2;
+static constexpr bool LARGE_FRAMES_SUPPORTED = true;
+#else
+static constexpr size_t MAX_LARGE_FRAME_SIZE = ESP_NOW_MAX_DATA_LEN;
+static constexpr bool LARGE_FRAMES_SUPPORTED = false;
+#endif
+
 static constexpr char MASTER_BEACON_ID[] = "PIO_MASTER_V1";
 static constexpr size_t MASTER_BEACON_ID_LEN = sizeof(MASTER_BEACON_ID) - 1;
 
@@ -30,4 +44,13 @@ struct __attribute__((packed)) Frame {
   uint8_t payload[MAX_PAYLOAD_SIZE];
 };
 
+static constexpr size_t MAX_LARGE_PAYLOAD_SIZE = MAX_LARGE_FRAME_SIZE - sizeof(PacketHeader) - sizeof(uint16_t);
+
+// PROTOCOL_VERSION_LARGE framing: same header, 16-bit payload size.
+struct __attribute__((packed)) LargeFrame {
+  PacketHeader header;
+  uint16_t payloadSize;
+  uint8_t payload[MAX_LARGE_PAYLOAD_SIZE];
+};
+
 }  // namespace app::espnow
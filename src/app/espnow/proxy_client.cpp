@@ -0,0 +1,185 @@
+#include "proxy_client.h"
+
+#include "proxy_frames.h"
+#include "slave.h"
+
+#include "app/telemetry/telemetry_batch.h"
+#include "app/weather/open_meteo_requests.h"
+
+#include <app_config.h>
+
+#include <cstring>
+#include <esp_log.h>
+
+namespace app::espnow {
+
+namespace {
+
+static constexpr const char* TAG = "proxy_client";
+static constexpr uint8_t kMaxTemplateId = 31;
+
+}  // namespace
+
+ProxyClient proxyClient;
+
+bool ProxyClient::registerTemplates(SlaveNode& node) {
+  resetTemplates();
+  bool registered = registerTemplate(node,
+                                     app::weather::kCurrentWeatherTemplateId,
+                                     state_binary::HttpMethod::Get,
+                                     app::weather::kCurrentWeatherTemplate);
+
+  #if TELEMETRY_UPLOAD_ENABLED
+  if (strlen(TELEMETRY_UPLOAD_URL) > 0) {
+    registered = registerTemplate(node,
+                                  app::telemetry::kTelemetryUploadTemplateId,
+                                  state_binary::HttpMethod::Post,
+                                  TELEMETRY_UPLOAD_URL) && registered;
+  }
+  #endif
+
+  return registered;
+}
+
+void ProxyClient::resetTemplates() {
+  ackedTemplates.store(0);
+}
+
+void ProxyClient::handleTemplateAck(const state_binary::ProxyTemplateAckCommand& ack) {
+  if (ack.templateId == 0 || ack.templateId > kMaxTemplateId) {
+    ESP_LOGW(TAG, "Ignoring ack for invalid template id=%u", ack.templateId);
+    return;
+  }
+
+  const uint32_t bit = 1UL << ack.templateId;
+  if (ack.ok == 1) {
+    ackedTemplates.fetch_or(bit);
+    ESP_LOGI(TAG, "Template %u registered with master", ack.templateId);
+  } else {
+    ackedTemplates.fetch_and(~bit);
+    ESP_LOGW(TAG, "Master rejected template %u, using full URL requests", ack.templateId);
+  }
+}
+
+bool ProxyClient::isTemplateAcked(uint8_t templateId) const {
+  if (templateId == 0 || templateId > kMaxTemplateId) {
+    return false;
+  }
+  return (ackedTemplates.load() & (1UL << templateId)) != 0;
+}
+
+bool ProxyClient::requestCurrentWeather(SlaveNode& node, app::weather::Area area) {
+  if (isTemplateAcked(app::weather::kCurrentWeatherTemplateId)) {
+    const auto& request = app::weather::currentWeatherTemplateRequest(area);
+    return node.sendStateBinary(&request, sizeof(request));
+  }
+
+  const auto& request = app::weather::currentWeatherRequest(area);
+  return node.sendStateBinary(&request, sizeof(request));
+}
+
+bool ProxyClient::upload(SlaveNode& node,
+                         uint16_t uploadId,
+                         uint8_t templateId,
+                         state_binary::ContentType contentType,
+                         const uint8_t* body,
+                         size_t bodyLen,
+                         size_t* framesSent,
+                         size_t* airBytes) {
+  if (framesSent != nullptr) {
+    *framesSent = 0;
+  }
+  if (airBytes != nullptr) {
+    *airBytes = 0;
+  }
+
+  if (body == nullptr || bodyLen == 0 || !isTemplateAcked(templateId)) {
+    return false;
+  }
+
+  const bool large = node.largeFramesActive();
+  const size_t chunkBytes = proxy_frames::bodyChunkBytes(large, node.proxyChunkDataBytes());
+  const size_t totalChunks = (bodyLen + chunkBytes - 1) / chunkBytes;
+  if (bodyLen > UINT16_MAX || totalChunks > UINT16_MAX) {
+    ESP_LOGW(TAG, "Upload body too large: %u bytes", static_cast<unsigned>(bodyLen));
+    return false;
+  }
+
+  state_binary::ProxyUploadState start = {};
+  state_binary::initHeader(start.header, state_binary::Type::ProxyUpload);
+  start.uploadId = uploadId;
+  start.templateId = templateId;
+  start.contentType = static_cast<uint8_t>(contentType);
+  start.bodyLen = static_cast<uint16_t>(bodyLen);
+  start.totalChunks = static_cast<uint16_t>(totalChunks);
+  if (!node.sendStateBinary(&start, sizeof(start))) {
+    return false;
+  }
+  size_t frames = 1;
+  size_t bytes = proxy_frames::frameAirBytes(sizeof(start));
+
+  for (size_t index = 0; index < totalChunks; ++index) {
+    const size_t offset = index * chunkBytes;
+    const size_t chunkLen = min(bodyLen - offset, chunkBytes);
+    const size_t size = proxy_frames::buildBodyChunk(frame, min(sizeof(frame), node.maxPayloadSize()), large, uploadId,
+                                                     static_cast<uint16_t>(index + 1),
+                                                     static_cast<uint16_t>(totalChunks), body + offset, chunkLen);
+
+    if (size == 0 || !node.sendStateBinary(frame, size)) {
+      ESP_LOGW(TAG, "Upload %u aborted at chunk %u/%u", uploadId, static_cast<unsigned>(index + 1),
+               static_cast<unsigned>(totalChunks));
+      if (framesSent != nullptr) {
+        *framesSent = frames;
+      }
+      return false;
+    }
+    frames++;
+    bytes += proxy_frames::frameAirBytes(size);
+  }
+
+  if (framesSent != nullptr) {
+    *framesSent = frames;
+  }
+  if (airBytes != nullptr) {
+    *airBytes = bytes;
+  }
+  return true;
+}
+
+bool ProxyClient::registerTemplate(SlaveNode& node,
+                                   uint8_t templateId,
+                                   state_binary::HttpMethod method,
+                                   const char* text) {
+  if (text == nullptr || templateId == 0 || templateId > kMaxTemplateId) {
+    return false;
+  }
+
+  const bool large = node.largeFramesActive();
+  const size_t partBytes = proxy_frames::templateTextBytes(large, node.proxyChunkDataBytes());
+  const size_t length = strlen(text);
+  const size_t totalParts = (length + partBytes - 1) / partBytes;
+  if (totalParts == 0 || totalParts > UINT8_MAX) {
+    ESP_LOGW(TAG, "Template %u has invalid length %u", templateId, static_cast<unsigned>(length));
+    return false;
+  }
+
+  for (size_t part = 0; part < totalParts; ++part) {
+    const size_t offset = part * partBytes;
+    const size_t partLen = min(length - offset, partBytes);
+    const size_t size = proxy_frames::buildTemplatePart(frame, min(sizeof(frame), node.maxPayloadSize()), large,
+                                                        templateId, method, static_cast<uint8_t>(part + 1),
+                                                        static_cast<uint8_t>(totalParts), text + offset, partLen);
+
+    if (size == 0 || !node.sendStateBinary(frame, size)) {
+      ESP_LOGW(TAG, "Failed sending template %u part %u/%u", templateId, static_cast<unsigned>(part + 1),
+               static_cast<unsigned>(totalParts));
+      return false;
+    }
+  }
+
+  ESP_LOGI(TAG, "Template %u sent (%u bytes, %u parts)", templateId, static_cast<unsigned>(length),
+           static_cast<unsigned>(totalParts));
+  return true;
+}
+
+}  // namespace app::espnow
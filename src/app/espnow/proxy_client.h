@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+#include "protocol.h"
+#include "state_binary.h"
+#include "app/weather/open_meteo_locations.h"
+
+namespace app::espnow {
+
+class SlaveNode;
+
+class ProxyClient {
+ public:
+  ProxyClient() = default;
+
+  // Registers every known URL template with the master; call once per master link.
+  bool registerTemplates(SlaveNode& node);
+  void resetTemplates();
+  void handleTemplateAck(const state_binary::ProxyTemplateAckCommand& ack);
+
+  // Sends a template-ID request once the master acknowledged the template, the full URL otherwise.
+  bool requestCurrentWeather(SlaveNode& node, app::weather::Area area);
+
+  bool isTemplateAcked(uint8_t templateId) const;
+
+  // Sends a POST/PATCH body to an acknowledged template as ProxyUpload + body chunk states, sized
+  // by the link (proxy_frames.h).
+  bool upload(SlaveNode& node,
+              uint16_t uploadId,
+              uint8_t templateId,
+              state_binary::ContentType contentType,
+              const uint8_t* body,
+              size_t bodyLen,
+              size_t* framesSent = nullptr,
+              size_t* airBytes = nullptr);
+
+ private:
+  bool registerTemplate(SlaveNode& node, uint8_t templateId, state_binary::HttpMethod method, const char* text);
+
+  std::atomic<uint32_t> ackedTemplates{0};
+  // upstream frame being built; only used from the app task
+  uint8_t frame[MAX_LARGE_PAYLOAD_SIZE] = {0};
+};
+
+extern ProxyClient proxyClient;
+
+}  // namespace app::espnow
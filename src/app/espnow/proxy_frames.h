@@ -0,0 +1,111 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cstring>
+
+#include "protocol.h"
+#include "state_binary.h"
+
+namespace app::espnow::proxy_frames {
+
+// Upstream proxy frames (upload body chunks, template parts). On v1 links they are the fixed
+// structs with kProxyChunkDataBytes / kProxyTemplateTextBytes fields; once large frames are
+// negotiated they are the variable-length *Large records carrying up to the link's chunk size.
+// Pure, so the frame and air-byte counts can be checked on the host.
+
+// Bytes of a STATE frame carrying `payloadSize` bytes, as SlaveNode::sendToMaster frames it: v1
+// framing (8-bit length) up to MAX_PAYLOAD_SIZE, large framing (16-bit length) above.
+inline size_t frameAirBytes(size_t payloadSize) {
+  return sizeof(PacketHeader) + (payloadSize > MAX_PAYLOAD_SIZE ? sizeof(uint16_t) : sizeof(uint8_t)) + payloadSize;
+}
+
+inline size_t bodyChunkBytes(bool large, size_t linkChunkBytes) {
+  return large ? linkChunkBytes : state_binary::kProxyChunkDataBytes;
+}
+
+inline size_t templateTextBytes(bool large, size_t linkChunkBytes) {
+  return large ? linkChunkBytes : state_binary::kProxyTemplateTextBytes;
+}
+
+// Writes one body chunk to `out`; returns the frame size, 0 when it does not fit.
+inline size_t buildBodyChunk(uint8_t* out,
+                             size_t capacity,
+                             bool large,
+                             uint16_t uploadId,
+                             uint16_t idx,
+                             uint16_t total,
+                             const uint8_t* data,
+                             size_t length) {
+  if (large) {
+    state_binary::ProxyBodyChunkLargeState chunk = {};
+    const size_t size = sizeof(chunk) + length;
+    if (size > capacity || length > UINT16_MAX) {
+      return 0;
+    }
+    state_binary::initHeader(chunk.header, state_binary::Type::ProxyBodyChunkLarge);
+    chunk.uploadId = uploadId;
+    chunk.idx = idx;
+    chunk.total = total;
+    chunk.dataLen = static_cast<uint16_t>(length);
+    memcpy(out, &chunk, sizeof(chunk));
+    memcpy(out + sizeof(chunk), data, length);
+    return size;
+  }
+
+  state_binary::ProxyBodyChunkState chunk = {};
+  if (sizeof(chunk) > capacity || length > sizeof(chunk.data)) {
+    return 0;
+  }
+  state_binary::initHeader(chunk.header, state_binary::Type::ProxyBodyChunk);
+  chunk.uploadId = uploadId;
+  chunk.idx = idx;
+  chunk.total = total;
+  chunk.dataLen = static_cast<uint8_t>(length);
+  memcpy(chunk.data, data, length);
+  memcpy(out, &chunk, sizeof(chunk));
+  return sizeof(chunk);
+}
+
+// Writes one template part to `out`; returns the frame size, 0 when it does not fit.
+inline size_t buildTemplatePart(uint8_t* out,
+                                size_t capacity,
+                                bool large,
+                                uint8_t templateId,
+                                state_binary::HttpMethod method,
+                                uint8_t part,
+                                uint8_t totalParts,
+                                const char* text,
+                                size_t length) {
+  if (large) {
+    state_binary::ProxyTemplateLargeState state = {};
+    const size_t size = sizeof(state) + length;
+    if (size > capacity || length > UINT16_MAX) {
+      return 0;
+    }
+    state_binary::initHeader(state.header, state_binary::Type::ProxyTemplateLarge);
+    state.templateId = templateId;
+    state.method = static_cast<uint8_t>(method);
+    state.part = part;
+    state.totalParts = totalParts;
+    state.textLen = static_cast<uint16_t>(length);
+    memcpy(out, &state, sizeof(state));
+    memcpy(out + sizeof(state), text, length);
+    return size;
+  }
+
+  state_binary::ProxyTemplateState state = {};
+  if (sizeof(state) > capacity || length > sizeof(state.text)) {
+    return 0;
+  }
+  state_binary::initHeader(state.header, state_binary::Type::ProxyTemplate);
+  state.templateId = templateId;
+  state.method = static_cast<uint8_t>(method);
+  state.part = part;
+  state.totalParts = totalParts;
+  state.textLen = static_cast<uint8_t>(length);
+  memcpy(state.text, text, length);
+  memcpy(out, &state, sizeof(state));
+  return sizeof(state);
+}
+
+}  // namespace app::espnow::proxy_frames
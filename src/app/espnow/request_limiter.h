@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace app::espnow {
+
+// Token bucket plus a debounce window for master-triggered commands.
+// Not thread-safe: each limiter is owned by the ESP-NOW receive path.
+class RequestLimiter {
+ public:
+  enum class Decision : uint8_t {
+    Allow,
+    Debounced,
+    Limited,
+  };
+
+  struct Stats {
+    uint32_t allowed = 0;
+    uint32_t forced = 0;
+    uint32_t debounced = 0;
+    uint32_t limited = 0;
+  };
+
+  RequestLimiter(uint8_t burst, uint32_t refillMs, uint32_t debounceMs)
+      : burst(burst), refillMs(refillMs), debounceMs(debounceMs), tokens(burst) {}
+
+  Decision check(uint32_t nowMs, bool force = false) {
+    refill(nowMs);
+
+    if (force) {
+      // forced requests always pass but still spend a token when one is available
+      if (tokens > 0) {
+        tokens--;
+      }
+      lastAllowedMs = nowMs;
+      hasAllowed = true;
+      counters.forced++;
+      return Decision::Allow;
+    }
+
+    if (hasAllowed && nowMs - lastAllowedMs < debounceMs) {
+      counters.debounced++;
+      return Decision::Debounced;
+    }
+
+    if (tokens == 0) {
+      counters.limited++;
+      return Decision::Limited;
+    }
+
+    tokens--;
+    lastAllowedMs = nowMs;
+    hasAllowed = true;
+    counters.allowed++;
+    return Decision::Allow;
+  }
+
+  const Stats& stats() const { return counters; }
+
+ private:
+  void refill(uint32_t nowMs) {
+    if (tokens >= burst) {
+      lastRefillMs = nowMs;
+      return;
+    }
+
+    const uint32_t elapsed = nowMs - lastRefillMs;
+    if (elapsed < refillMs) {
+      return;
+    }
+
+    const uint32_t earned = elapsed / refillMs;
+    tokens = static_cast<uint8_t>(min<uint32_t>(burst, tokens + earned));
+    lastRefillMs += earned * refillMs;
+  }
+
+  const uint8_t burst;
+  const uint32_t refillMs;
+  const uint32_t debounceMs;
+  uint8_t tokens;
+  uint32_t lastRefillMs = 0;
+  uint32_t lastAllowedMs = 0;
+  bool hasAllowed = false;
+  Stats counters;
+};
+
+}  // namespace app::espnow
@@ -1,12 +1,21 @@
 #include "slave.h"
 
 #include "payload_codec.h"
+#include "proxy_client.h"
+#include "request_limiter.h"
 #include "state_binary.h"
 #include "weather_pipeline.h"
 
+#include "app/history/series_clock.h"
+#include "app/history/timeseries_store.h"
+#include "app/power/report_policy.h"
+#include "app/telemetry/profiler.h"
+#include "app/telemetry/sensor_history.h"
+#include "app/telemetry/telemetry_batch.h"
 #include "app/weather/open_meteo_locations.h"
 
 #include <app_config.h>
+#include <core/mem_tier.h>
 #include <WiFi.h>
 #include <cstring>
 #include <esp_log.h>
@@ -60,73 +69,108 @@ class SlaveStateSink final : public IStateSink {
     state.windspeed10 = static_cast<int16_t>(windspeed.toFloat() * 10.0f);
     state.winddirection = static_cast<uint16_t>(winddirection.toInt());
 
+    #if TIMESERIES_ENABLED
+    const int32_t values[] = {state.temperature10, state.windspeed10, state.winddirection};
+    app::history::weatherSeries.append(app::history::seriesClock.nowS(), values);
+    #endif
+
+    portENTER_CRITICAL(&cacheLock);
+    cachedState = state;
+    cachedAtMs = millis();
+    hasCachedState = true;
+    portEXIT_CRITICAL(&cacheLock);
+
     return node->sendStateBinary(&state, sizeof(state));
   }
 
+  bool cachedWeather(app::espnow::state_binary::WeatherState& out, uint32_t maxAgeMs) {
+    portENTER_CRITICAL(&cacheLock);
+    const bool fresh = hasCachedState && (millis() - cachedAtMs) <= maxAgeMs;
+    if (fresh) {
+      out = cachedState;
+    }
+    portEXIT_CRITICAL(&cacheLock);
+    return fresh;
+  }
+
  private:
   SlaveNode* node = nullptr;
+  portMUX_TYPE cacheLock = portMUX_INITIALIZER_UNLOCKED;
+  app::espnow::state_binary::WeatherState cachedState = {};
+  uint32_t cachedAtMs = 0;
+  bool hasCachedState = false;
 };
 
+// master-triggered commands: burst of 3, one token back every 10 s, repeats within 2 s are debounced
+static constexpr uint8_t kMasterRequestBurst = 3;
+static constexpr uint32_t kMasterRequestRefillMs = 10000;
+static constexpr uint32_t kMasterRequestDebounceMs = 2000;
+static constexpr uint32_t kWeatherCacheMaxAgeMs = WEATHER_PROXY_REQUEST_INTERVAL_MS;
+
 SlaveStateSink stateSink;
 WeatherCommandPipeline weatherPipeline;
+RequestLimiter identityLimiter(kMasterRequestBurst, kMasterRequestRefillMs, kMasterRequestDebounceMs);
+RequestLimiter weatherSyncLimiter(kMasterRequestBurst, kMasterRequestRefillMs, kMasterRequestDebounceMs);
+uint32_t cachedWeatherReplies = 0;
 
-bool sendIdentityStateNow(SlaveNode& node) {
-  app::espnow::state_binary::IdentityState state = {};
-  app::espnow::state_binary::initHeader(state.header, app::espnow::state_binary::Type::Identity);
-  strncpy(state.id, DEVICE_NAME, sizeof(state.id) - 1);
-  state.id[sizeof(state.id) - 1] = '\0';
-
-  const bool sent = node.sendStateBinary(&state, sizeof(state));
-  if (!sent) {
-    ESP_LOGW("WEATHER", "Failed sending identity before weather request");
-  }
-  return sent;
+const char* decisionName(RequestLimiter::Decision decision) {
+  return decision == RequestLimiter::Decision::Debounced ? "debounced" : "rate limited";
 }
 
-bool sendFeaturesStateNow(SlaveNode& node) {
-  app::espnow::state_binary::FeaturesState state = {};
-  app::espnow::state_binary::initHeader(state.header, app::espnow::state_binary::Type::Features);
-  state.contractVersion = 1;
-  state.featureBits = static_cast<uint32_t>(app::espnow::state_binary::FeatureIdentity)
-                   | static_cast<uint32_t>(app::espnow::state_binary::FeatureSensor)
-                   | static_cast<uint32_t>(app::espnow::state_binary::FeatureWeather)
-                   | static_cast<uint32_t>(app::espnow::state_binary::FeatureProxyClient);
+bool sendWeatherProxyRequestNow(SlaveNode& node) {
+  node.sendIdentityState();
+  node.sendFeaturesState();
 
-  const bool sent = node.sendStateBinary(&state, sizeof(state));
-  if (!sent) {
-    ESP_LOGW("WEATHER", "Failed sending features before weather request");
+  const bool sent = proxyClient.requestCurrentWeather(node, static_cast<app::weather::Area>(WEATHER_AREA_INDEX));
+  if (sent) {
+    ESP_LOGI("WEATHER", "Triggered weather proxy request by master command");
+  } else {
+    ESP_LOGW("WEATHER", "Failed sending weather proxy request to master");
   }
   return sent;
 }
 
-bool sendWeatherProxyRequestNow(SlaveNode& node) {
-  sendIdentityStateNow(node);
-  sendFeaturesStateNow(node);
-
-  const app::weather::Area area = static_cast<app::weather::Area>(WEATHER_AREA_INDEX);
-  const String weatherUrl = app::weather::buildCurrentWeatherUrl(area);
-  if (weatherUrl.isEmpty()) {
-    ESP_LOGW("WEATHER", "Cannot build weather URL for sync request");
-    return false;
+void handleIdentityRequest(SlaveNode& node) {
+  const auto decision = identityLimiter.check(millis());
+  if (decision != RequestLimiter::Decision::Allow) {
+    // the identity sent for the previous request is still current
+    ESP_LOGD("MASTER", "IdentityReq %s", decisionName(decision));
+    return;
   }
 
-  app::espnow::state_binary::ProxyReqState request = {};
-  app::espnow::state_binary::initHeader(request.header, app::espnow::state_binary::Type::ProxyReq);
-  request.method = static_cast<uint8_t>(app::espnow::state_binary::HttpMethod::Get);
-  strncpy(request.url, weatherUrl.c_str(), sizeof(request.url) - 1);
-  request.url[sizeof(request.url) - 1] = '\0';
+  node.sendIdentityState();
+  node.sendFeaturesState();
+}
 
-  const bool sent = node.sendStateBinary(&request, sizeof(request));
-  if (sent) {
-    ESP_LOGI("WEATHER", "Triggered weather proxy request by master command");
-  } else {
-    ESP_LOGW("WEATHER", "Failed sending weather proxy request to master");
+void handleWeatherSyncRequest(SlaveNode& node, const app::espnow::state_binary::WeatherSyncReqCommand& command) {
+  const auto decision = weatherSyncLimiter.check(millis(), command.force != 0);
+  if (decision == RequestLimiter::Decision::Allow) {
+    sendWeatherProxyRequestNow(node);
+    return;
   }
-  return sent;
+
+  app::espnow::state_binary::WeatherState cached = {};
+  if (stateSink.cachedWeather(cached, kWeatherCacheMaxAgeMs)) {
+    cachedWeatherReplies++;
+    node.sendStateBinary(&cached, sizeof(cached));
+    ESP_LOGD("MASTER", "WeatherSyncReq %s, answered from cache", decisionName(decision));
+    return;
+  }
+
+  // nothing cached yet: merged into the request already in flight
+  ESP_LOGD("MASTER", "WeatherSyncReq %s, merged with pending request", decisionName(decision));
 }
 
 }  // namespace
 
+MasterRequestStats masterRequestStats() {
+  return {
+      .identity = identityLimiter.stats(),
+      .weatherSync = weatherSyncLimiter.stats(),
+      .cachedWeatherReplies = cachedWeatherReplies,
+  };
+}
+
 static const char* TAG = "espnow_slave";
 static constexpr uint8_t MIN_SCAN_CHANNEL = 1;
 static constexpr uint8_t MAX_SCAN_CHANNEL = 13;
@@ -164,6 +208,21 @@ bool SlaveNode::begin(uint8_t channel) {
   esp_now_register_send_cb(SlaveNode::onSendStatic);
   esp_now_register_recv_cb(SlaveNode::onReceiveStatic);
 
+  uint32_t espNowVersion = 1;
+  if (esp_now_get_version(&espNowVersion) != ESP_OK) {
+    espNowVersion = 1;
+  }
+  localLargeFrames = ESPNOW_LARGE_FRAME_ENABLED && LARGE_FRAMES_SUPPORTED && espNowVersion >= 2;
+  if (localLargeFrames && largeTxFrame == nullptr) {
+    txLock = xSemaphoreCreateMutexStatic(&txLockControl);
+    largeTxFrame = static_cast<LargeFrame*>(mem::allocate(mem::MemClass::Frame, sizeof(LargeFrame)));
+    if (largeTxFrame == nullptr) {
+      ESP_LOGW(TAG, "No internal RAM for the large-frame buffer, using v1 frames");
+      localLargeFrames = false;
+    }
+  }
+  resetLinkParams();
+
   started = true;
   lastHelloMs = millis();
   lastScanMs = millis();
@@ -171,21 +230,27 @@ bool SlaveNode::begin(uint8_t channel) {
   stateSink.injectNode(this);
   weatherPipeline.injectStateSink(&stateSink);
   if (!weatherPipeline.begin()) {
-    ESP_LOGW(TAG, "Weather pipeline task failed to start");
+    ESP_LOGW(TAG, "Weather pipeline failed to start");
   }
   ESP_LOGI(TAG, "ESP-NOW slave ready");
   return true;
 }
 
+coro::Task SlaveNode::runCommandPipeline() {
+  return weatherPipeline.run();
+}
+
 void SlaveNode::loop() {
   if (!started) {
     return;
   }
+  const app::telemetry::profiler::Scope profile(app::telemetry::profiler::Section::SlaveLoop);
 
   const uint32_t now = millis();
   if (masterKnown && lastMasterSeenMs > 0 && (now - lastMasterSeenMs > MASTER_TIMEOUT_MS)) {
     masterKnown = false;
     memset(masterMac, 0, sizeof(masterMac));
+    resetLinkParams();
     ESP_LOGW(TAG, "Master beacon timeout, returning to channel scan");
   }
 
@@ -194,14 +259,15 @@ void SlaveNode::loop() {
     lastScanMs = now;
   }
 
-  if (masterKnown && (now - lastHelloMs >= 7000)) {
+  if (masterKnown && (now - lastHelloMs >= app::power::reportPolicy.interval(app::power::Activity::Hello,
+                                                                              HELLO_INTERVAL_MS))) {
     static const char hello[] = "slave-online";
     sendToMaster(PacketType::HELLO, hello, sizeof(hello) - 1);
     lastHelloMs = now;
   }
 }
 
-bool SlaveNode::matchesMasterBeacon(const uint8_t* payload, uint8_t payloadSize) const {
+bool SlaveNode::matchesMasterBeacon(const uint8_t* payload, size_t payloadSize) const {
   if (payload == nullptr || payloadSize != MASTER_BEACON_ID_LEN) {
     return false;
   }
@@ -260,6 +326,11 @@ bool SlaveNode::sendToMaster(PacketType type, const void* payload, size_t payloa
   if (!started || !masterKnown) {
     return false;
   }
+  const app::telemetry::profiler::Scope profile(app::telemetry::profiler::Section::SendToMaster);
+
+  if (payloadSize > MAX_PAYLOAD_SIZE && largeFrames) {
+    return sendLargeToMaster(type, payload, payloadSize);
+  }
 
   Frame frame = {};
   frame.header.version = PROTOCOL_VERSION;
@@ -282,6 +353,68 @@ bool SlaveNode::sendToMaster(PacketType type, const void* payload, size_t payloa
   return true;
 }
 
+bool SlaveNode::sendLargeToMaster(PacketType type, const void* payload, size_t payloadSize) {
+  if (payloadSize > largePayloadSize || payload == nullptr) {
+    ESP_LOGW(TAG, "Large payload rejected: %u > %u", static_cast<unsigned>(payloadSize), largePayloadSize);
+    return false;
+  }
+
+  xSemaphoreTake(txLock, portMAX_DELAY);
+  LargeFrame& frame = *largeTxFrame;
+  frame.header.version = PROTOCOL_VERSION_LARGE;
+  frame.header.type = static_cast<uint8_t>(type);
+  frame.header.sequence = sequence++;
+  frame.header.timestampMs = millis();
+  frame.payloadSize = static_cast<uint16_t>(payloadSize);
+  memcpy(frame.payload, payload, payloadSize);
+
+  // esp_now_send copies the frame, so the buffer is free again when it returns
+  const size_t bytes = sizeof(frame.header) + sizeof(frame.payloadSize) + payloadSize;
+  esp_err_t sendErr = esp_now_send(masterMac, reinterpret_cast<const uint8_t*>(&frame), bytes);
+  xSemaphoreGive(txLock);
+  if (sendErr != ESP_OK) {
+    ESP_LOGW(TAG, "Large send to master failed: %s", esp_err_to_name(sendErr));
+    return false;
+  }
+
+  return true;
+}
+
+void SlaveNode::handleMasterFeatures(const state_binary::MasterFeaturesCommand& command) {
+  resetLinkParams();
+  masterFeatureBits = command.featureBits;
+
+  const bool masterLarge = (command.featureBits & state_binary::FeatureLargeFrame) != 0 &&
+                           command.contractVersion >= state_binary::kContractVersionLargeFrame;
+  if (!localLargeFrames || !masterLarge || command.maxPayload <= MAX_PAYLOAD_SIZE) {
+    ESP_LOGI(TAG, "Master features=0x%08lx contract=%u, using v1 frames",
+             static_cast<unsigned long>(command.featureBits), command.contractVersion);
+    return;
+  }
+
+  constexpr size_t kChunkHeaderBytes = sizeof(state_binary::ProxyRespChunkLargeCommand);
+  largePayloadSize = static_cast<uint16_t>(min(static_cast<size_t>(command.maxPayload), MAX_LARGE_PAYLOAD_SIZE));
+  const size_t chunkLimit = largePayloadSize - kChunkHeaderBytes;
+  largeChunkDataBytes = static_cast<uint16_t>(
+      command.chunkDataBytes == 0 ? chunkLimit : min(static_cast<size_t>(command.chunkDataBytes), chunkLimit));
+  largeFrames = true;
+  weatherPipeline.setLargeChunkDataBytes(largeChunkDataBytes);
+  ESP_LOGI(TAG, "Large frames enabled: payload=%u chunk=%u", largePayloadSize, largeChunkDataBytes);
+}
+
+void SlaveNode::resetLinkParams() {
+  largeFrames = false;
+  largePayloadSize = MAX_PAYLOAD_SIZE;
+  largeChunkDataBytes = state_binary::kProxyChunkDataBytes;
+  masterFeatureBits = 0;
+  weatherPipeline.setLargeChunkDataBytes(0);
+
+  // a new (or restarted) master has no delta base
+  portENTER_CRITICAL(&deltaLock);
+  deltaEncoder.reset();
+  portEXIT_CRITICAL(&deltaLock);
+}
+
 bool SlaveNode::sendState(const char* text) {
   if (text == nullptr) {
     return false;
@@ -295,9 +428,100 @@ bool SlaveNode::sendStateBinary(const void* payload, size_t payloadSize) {
     return false;
   }
 
+  if (deltaActive()) {
+    uint8_t encoded[kMaxDeltaRecordBytes];
+    bool delta = false;
+    portENTER_CRITICAL(&deltaLock);
+    const size_t encodedSize =
+        deltaEncoder.encode(static_cast<const uint8_t*>(payload), payloadSize, encoded, sizeof(encoded), delta);
+    portEXIT_CRITICAL(&deltaLock);
+    if (encodedSize > 0) {
+      return sendToMaster(delta ? PacketType::STATE_DELTA : PacketType::STATE, encoded, encodedSize);
+    }
+  }
+
   return sendToMaster(PacketType::STATE, payload, payloadSize);
 }
 
+bool SlaveNode::deltaActive() const {
+  return STATE_DELTA_ENABLED && (masterFeatureBits & state_binary::FeatureStateDelta) != 0;
+}
+
+void SlaveNode::sendKeyframe(uint8_t recordType) {
+  uint8_t encoded[kMaxDeltaRecordBytes];
+  portENTER_CRITICAL(&deltaLock);
+  deltaEncoder.requestKeyframe(recordType);
+  const size_t encodedSize = deltaEncoder.keyframe(recordType, encoded, sizeof(encoded));
+  portEXIT_CRITICAL(&deltaLock);
+
+  // nothing sent yet for this type: the next update goes out as a keyframe anyway
+  if (encodedSize > 0) {
+    sendToMaster(PacketType::STATE, encoded, encodedSize);
+  }
+}
+
+StateDeltaEncoder::Stats SlaveNode::deltaStats() {
+  portENTER_CRITICAL(&deltaLock);
+  const StateDeltaEncoder::Stats stats = deltaEncoder.stats();
+  portEXIT_CRITICAL(&deltaLock);
+  return stats;
+}
+
+bool SlaveNode::sendIdentityState() {
+  app::espnow::state_binary::IdentityState state = {};
+  app::espnow::state_binary::initHeader(state.header, app::espnow::state_binary::Type::Identity);
+  strncpy(state.id, DEVICE_NAME, sizeof(state.id) - 1);
+  state.id[sizeof(state.id) - 1] = '\0';
+
+  const bool sent = sendStateBinary(&state, sizeof(state));
+  if (!sent) {
+    ESP_LOGW(TAG, "Failed sending identity state");
+  }
+  return sent;
+}
+
+bool SlaveNode::sendFeaturesState() {
+  app::espnow::state_binary::FeaturesState state = {};
+  app::espnow::state_binary::initHeader(state.header, app::espnow::state_binary::Type::Features);
+  state.contractVersion = localLargeFrames ? state_binary::kContractVersionLargeFrame : state_binary::kContractVersion;
+  state.featureBits = static_cast<uint32_t>(app::espnow::state_binary::FeatureIdentity)
+                   | static_cast<uint32_t>(app::espnow::state_binary::FeatureSensor)
+                   | static_cast<uint32_t>(app::espnow::state_binary::FeatureWeather)
+                   | static_cast<uint32_t>(app::espnow::state_binary::FeatureProxyClient)
+                   | static_cast<uint32_t>(app::espnow::state_binary::FeatureProxyTemplate)
+                   | static_cast<uint32_t>(app::espnow::state_binary::FeatureBattery)
+                   | static_cast<uint32_t>(app::espnow::state_binary::FeaturePowerPolicy)
+                   | static_cast<uint32_t>(app::espnow::state_binary::FeatureSensorHistory);
+  #if SENSOR_AGGREGATE_ENABLED
+  state.featureBits |= static_cast<uint32_t>(app::espnow::state_binary::FeatureSensorAggregate);
+  #endif
+  #if TELEMETRY_UPLOAD_ENABLED
+  state.featureBits |= static_cast<uint32_t>(app::espnow::state_binary::FeatureProxyUpload);
+  #endif
+  #if MEM_STATS_ENABLED
+  state.featureBits |= static_cast<uint32_t>(app::espnow::state_binary::FeatureMemStats);
+  #endif
+  #if PROFILING_ENABLED
+  state.featureBits |= static_cast<uint32_t>(app::espnow::state_binary::FeatureProfile);
+  #endif
+  if (localLargeFrames) {
+    state.featureBits |= static_cast<uint32_t>(app::espnow::state_binary::FeatureLargeFrame);
+  }
+  #if STATE_DELTA_ENABLED
+  state.featureBits |= static_cast<uint32_t>(app::espnow::state_binary::FeatureStateDelta);
+  #endif
+  #if PROXY_FEC_GROUP_SIZE > 0
+  state.featureBits |= static_cast<uint32_t>(app::espnow::state_binary::FeatureProxyFec);
+  state.fecGroupSize = PROXY_FEC_GROUP_SIZE;
+  #endif
+
+  const bool sent = sendStateBinary(&state, sizeof(state));
+  if (!sent) {
+    ESP_LOGW(TAG, "Failed sending features state");
+  }
+  return sent;
+}
+
 void SlaveNode::onSendStatic(const esp_now_send_info_t* tx_info, esp_now_send_status_t status) {
   if (!activeInstance) {
     return;
@@ -315,6 +539,7 @@ void SlaveNode::onReceiveStatic(const esp_now_recv_info_t* recv_info, const uint
   if (!activeInstance || recv_info == nullptr || data == nullptr || len <= 0) {
     return;
   }
+  const app::telemetry::profiler::Scope profile(app::telemetry::profiler::Section::RxCallback);
 
   if (len < static_cast<int>(sizeof(PacketHeader) + sizeof(uint8_t))) {
     ESP_LOGW(TAG, "Received frame too small: %d", len);
@@ -322,12 +547,31 @@ void SlaveNode::onReceiveStatic(const esp_now_recv_info_t* recv_info, const uint
   }
 
   const auto* header = reinterpret_cast<const PacketHeader*>(data);
-  const auto payloadSize = *(data + sizeof(PacketHeader));
-  const auto* payload = data + sizeof(PacketHeader) + sizeof(uint8_t);
-  const size_t expectedLen = sizeof(PacketHeader) + sizeof(uint8_t) + payloadSize;
-  if (payloadSize > MAX_PAYLOAD_SIZE || expectedLen > static_cast<size_t>(len)) {
-    ESP_LOGW(TAG, "Invalid frame size: payload=%u len=%d", payloadSize, len);
-    return;
+  size_t payloadSize = 0;
+  const uint8_t* payload = nullptr;
+  size_t expectedLen = 0;
+  if (header->version == PROTOCOL_VERSION_LARGE) {
+    if (len < static_cast<int>(sizeof(PacketHeader) + sizeof(uint16_t))) {
+      ESP_LOGW(TAG, "Received large frame too small: %d", len);
+      return;
+    }
+    uint16_t largeSize = 0;
+    memcpy(&largeSize, data + sizeof(PacketHeader), sizeof(largeSize));
+    payloadSize = largeSize;
+    payload = data + sizeof(PacketHeader) + sizeof(uint16_t);
+    expectedLen = sizeof(PacketHeader) + sizeof(uint16_t) + payloadSize;
+    if (!activeInstance->localLargeFrames || payloadSize > MAX_LARGE_PAYLOAD_SIZE || expectedLen > static_cast<size_t>(len)) {
+      ESP_LOGW(TAG, "Invalid large frame size: payload=%u len=%d", static_cast<unsigned>(payloadSize), len);
+      return;
+    }
+  } else {
+    payloadSize = *(data + sizeof(PacketHeader));
+    payload = data + sizeof(PacketHeader) + sizeof(uint8_t);
+    expectedLen = sizeof(PacketHeader) + sizeof(uint8_t) + payloadSize;
+    if (payloadSize > MAX_PAYLOAD_SIZE || expectedLen > static_cast<size_t>(len)) {
+      ESP_LOGW(TAG, "Invalid frame size: payload=%u len=%d", static_cast<unsigned>(payloadSize), len);
+      return;
+    }
   }
 
   const auto type = static_cast<PacketType>(header->type);
@@ -351,6 +595,10 @@ void SlaveNode::onReceiveStatic(const esp_now_recv_info_t* recv_info, const uint
     activeInstance->scanChannel = WiFi.channel();
   }
 
+  if (recv_info->rx_ctrl != nullptr) {
+    activeInstance->masterRssi = static_cast<int8_t>(recv_info->rx_ctrl->rssi);
+  }
+
   switch (type) {
     case PacketType::HELLO: {
       static const char hello[] = "slave-online";
@@ -369,8 +617,53 @@ void SlaveNode::onReceiveStatic(const esp_now_recv_info_t* recv_info, const uint
                                                       payloadSize,
                                                       app::espnow::state_binary::Type::IdentityReq,
                                                       sizeof(app::espnow::state_binary::IdentityReqCommand))) {
-          sendIdentityStateNow(*activeInstance);
-          sendFeaturesStateNow(*activeInstance);
+          handleIdentityRequest(*activeInstance);
+          break;
+        }
+
+        if (app::espnow::state_binary::hasTypeAndSize(payload,
+                                                      payloadSize,
+                                                      app::espnow::state_binary::Type::ProxyTemplateAck,
+                                                      sizeof(app::espnow::state_binary::ProxyTemplateAckCommand))) {
+          proxyClient.handleTemplateAck(
+              *reinterpret_cast<const app::espnow::state_binary::ProxyTemplateAckCommand*>(payload));
+          break;
+        }
+
+        if (app::espnow::state_binary::hasTypeAndSize(payload,
+                                                      payloadSize,
+                                                      app::espnow::state_binary::Type::ProxyUploadResult,
+                                                      sizeof(app::espnow::state_binary::ProxyUploadResultCommand))) {
+          app::telemetry::telemetryBatch.handleUploadResult(
+              *reinterpret_cast<const app::espnow::state_binary::ProxyUploadResultCommand*>(payload));
+          break;
+        }
+
+        if (app::espnow::state_binary::hasTypeAndSize(payload,
+                                                      payloadSize,
+                                                      app::espnow::state_binary::Type::KeyframeReq,
+                                                      sizeof(app::espnow::state_binary::KeyframeReqCommand))) {
+          activeInstance->sendKeyframe(
+              reinterpret_cast<const app::espnow::state_binary::KeyframeReqCommand*>(payload)->recordType);
+          break;
+        }
+
+        if (app::espnow::state_binary::hasTypeAndSize(payload,
+                                                      payloadSize,
+                                                      app::espnow::state_binary::Type::SensorRawReq,
+                                                      sizeof(app::espnow::state_binary::SensorRawReqCommand))) {
+          // served from flash by the network task, never from the receive callback
+          const auto* request = reinterpret_cast<const app::espnow::state_binary::SensorRawReqCommand*>(payload);
+          app::telemetry::sensorHistory.requestRaw(request->fromAgeS, request->toAgeS);
+          break;
+        }
+
+        if (app::espnow::state_binary::hasTypeAndSize(payload,
+                                                      payloadSize,
+                                                      app::espnow::state_binary::Type::MasterFeatures,
+                                                      sizeof(app::espnow::state_binary::MasterFeaturesCommand))) {
+          activeInstance->handleMasterFeatures(
+              *reinterpret_cast<const app::espnow::state_binary::MasterFeaturesCommand*>(payload));
           break;
         }
 
@@ -378,7 +671,8 @@ void SlaveNode::onReceiveStatic(const esp_now_recv_info_t* recv_info, const uint
                                                       payloadSize,
                                                       app::espnow::state_binary::Type::WeatherSyncReq,
                                                       sizeof(app::espnow::state_binary::WeatherSyncReqCommand))) {
-          sendWeatherProxyRequestNow(*activeInstance);
+          handleWeatherSyncRequest(
+              *activeInstance, *reinterpret_cast<const app::espnow::state_binary::WeatherSyncReqCommand*>(payload));
           break;
         }
 
@@ -2,8 +2,16 @@
 
 #include <Arduino.h>
 #include <esp_now.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
 #include "protocol.h"
+#include "request_limiter.h"
+#include "state_delta.h"
+
+#include <app_config.h>
+#include <core/coro.h>
+#include "state_binary.h"
 
 namespace app::espnow {
 
@@ -13,20 +21,38 @@ class SlaveNode {
 
   bool begin(uint8_t channel = 1);
   void loop();
+  // Proxy-response reassembly, spawned on the shared executor after begin().
+  coro::Task runCommandPipeline();
 
   bool sendState(const char* text);
   bool sendStateBinary(const void* payload, size_t payloadSize);
+  bool sendIdentityState();
+  bool sendFeaturesState();
   bool isReady() const { return started; }
   bool isMasterLinked() const { return masterKnown; }
+  int8_t lastMasterRssi() const { return masterRssi; }
+  uint8_t channel() const { return scanChannel; }
+  uint32_t masterFeatures() const { return masterFeatureBits; }
+  StateDeltaEncoder::Stats deltaStats();
+
+  // Runtime link parameters; v1 sizes until the master advertises large-frame support.
+  bool largeFramesActive() const { return largeFrames; }
+  size_t maxPayloadSize() const { return largeFrames ? largePayloadSize : MAX_PAYLOAD_SIZE; }
+  size_t proxyChunkDataBytes() const { return largeFrames ? largeChunkDataBytes : state_binary::kProxyChunkDataBytes; }
 
  private:
   static void onSendStatic(const esp_now_send_info_t* tx_info, esp_now_send_status_t status);
   static void onReceiveStatic(const esp_now_recv_info_t* recv_info, const uint8_t* data, int len);
 
-    bool matchesMasterBeacon(const uint8_t* payload, uint8_t payloadSize) const;
-    void scanNextChannel();
+  bool matchesMasterBeacon(const uint8_t* payload, size_t payloadSize) const;
+  void scanNextChannel();
   bool addMasterPeer(const uint8_t mac[6]);
   bool sendToMaster(PacketType type, const void* payload, size_t payloadSize);
+  bool sendLargeToMaster(PacketType type, const void* payload, size_t payloadSize);
+  void handleMasterFeatures(const state_binary::MasterFeaturesCommand& command);
+  void resetLinkParams();
+  void sendKeyframe(uint8_t recordType);
+  bool deltaActive() const;
 
   static SlaveNode* activeInstance;
 
@@ -35,6 +61,21 @@ class SlaveNode {
   bool masterKnown = false;
   uint8_t masterMac[6] = {0};
   uint8_t scanChannel = DEFAULT_CHANNEL;
+  int8_t masterRssi = 0;
+
+  bool localLargeFrames = false;
+  bool largeFrames = false;
+  uint16_t largePayloadSize = MAX_PAYLOAD_SIZE;
+  uint16_t largeChunkDataBytes = state_binary::kProxyChunkDataBytes;
+  uint32_t masterFeatureBits = 0;
+  // Large frames are built here instead of on the sender's stack (mem::MemClass::Frame, allocated
+  // in begin()). Both app_task and the receive callback send, so txLock guards it.
+  LargeFrame* largeTxFrame = nullptr;
+  SemaphoreHandle_t txLock = nullptr;
+  StaticSemaphore_t txLockControl;
+
+  portMUX_TYPE deltaLock = portMUX_INITIALIZER_UNLOCKED;
+  StateDeltaEncoder deltaEncoder{STATE_DELTA_KEYFRAME_INTERVAL};
 
   uint32_t lastHelloMs = 0;
   uint32_t lastScanMs = 0;
@@ -43,4 +84,13 @@ class SlaveNode {
 
 extern SlaveNode espnowSlave;
 
+// Suppression counters for master-triggered IdentityReq / WeatherSyncReq handling.
+struct MasterRequestStats {
+  RequestLimiter::Stats identity;
+  RequestLimiter::Stats weatherSync;
+  uint32_t cachedWeatherReplies;
+};
+
+MasterRequestStats masterRequestStats();
+
 }  // namespace app::espnow
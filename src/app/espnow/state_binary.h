@@ -18,6 +18,26 @@ enum class Type : uint8_t {
   WeatherSyncReq = 8,
   Features = 9,
   IdentityReq = 10,
+  ProxyTemplate = 11,
+  ProxyTemplateReq = 12,
+  ProxyTemplateAck = 13,
+  ProxyUpload = 14,
+  ProxyBodyChunk = 15,
+  ProxyUploadResult = 16,
+  MasterFeatures = 17,
+  ProxyRespChunkLarge = 18,
+  ProxyRespParity = 19,
+  StateDelta = 20,  // reserved: deltas travel as PacketType::STATE_DELTA without a Header
+  KeyframeReq = 21,
+  Battery = 22,
+  PowerPolicy = 23,
+  SensorHistory = 24,
+  SensorAggregate = 25,
+  SensorRawReq = 26,
+  MemStats = 27,
+  Profile = 28,
+  ProxyBodyChunkLarge = 29,
+  ProxyTemplateLarge = 30,
 };
 
 enum Feature : uint32_t {
@@ -28,14 +48,32 @@ enum Feature : uint32_t {
   FeatureCameraJpeg = 1UL << 4,
   FeatureCameraStream = 1UL << 5,
   FeatureControlBasic = 1UL << 6,
+  FeatureProxyTemplate = 1UL << 7,
+  FeatureProxyUpload = 1UL << 8,
+  FeatureLargeFrame = 1UL << 9,
+  FeatureProxyFec = 1UL << 10,
+  FeatureStateDelta = 1UL << 11,
+  FeatureBattery = 1UL << 12,
+  FeaturePowerPolicy = 1UL << 13,
+  FeatureSensorHistory = 1UL << 14,
+  FeatureSensorAggregate = 1UL << 15,
+  FeatureMemStats = 1UL << 16,
+  FeatureProfile = 1UL << 17,
 };
 
+static constexpr uint16_t kContractVersion = 1;
+static constexpr uint16_t kContractVersionLargeFrame = 2;
+
 enum class HttpMethod : uint8_t {
   Get = 1,
   Post = 2,
   Patch = 3,
 };
 
+enum class ContentType : uint8_t {
+  Json = 1,
+};
+
 struct __attribute__((packed)) Header {
   uint8_t magic;
   uint8_t version;
@@ -60,6 +98,57 @@ struct __attribute__((packed)) ProxyReqState {
   char url[140];
 };
 
+static constexpr size_t kProxyTemplateTextBytes = 120;
+static constexpr size_t kProxyTemplateMaxParams = 4;
+static constexpr uint8_t kProxyTemplateParamDecimals = 7;
+
+// One part of a URL template registered with the master. Parts are concatenated in order;
+// `{n}` placeholders are filled from ProxyTemplateReqState::params[n], printed as fixed point
+// with kProxyTemplateParamDecimals fraction digits.
+struct __attribute__((packed)) ProxyTemplateState {
+  Header header;
+  uint8_t templateId;
+  uint8_t method;
+  uint8_t part;
+  uint8_t totalParts;
+  uint8_t textLen;
+  char text[kProxyTemplateTextBytes];
+};
+
+// A request against a template the master acknowledged (ProxyTemplateAckCommand). Templates are
+// registered again on every link-up; until the ack, or after a rejection, requests go out as
+// full-URL ProxyReqState.
+struct __attribute__((packed)) ProxyTemplateReqState {
+  Header header;
+  uint8_t templateId;
+  uint8_t paramCount;
+  int32_t params[kProxyTemplateMaxParams];
+};
+
+// Changed fields of a delta-tracked record relative to the previous update of the same type,
+// sent as PacketType::STATE_DELTA with no Header. typeSequence holds the index into kDeltaLayouts
+// (state_delta.h) in its top 3 bits and the low 5 bits of the record's sequence below. Bit n of
+// changedMask marks field n of the layout; the changed fields follow in layout order. Once
+// FeatureStateDelta is negotiated, full records of delta-tracked types act as keyframes and
+// carry their full sequence in Header.reserved.
+static constexpr uint8_t kDeltaSequenceBits = 5;
+static constexpr uint8_t kDeltaSequenceMask = (1U << kDeltaSequenceBits) - 1;
+
+struct __attribute__((packed)) StateDeltaState {
+  uint8_t typeSequence;
+  uint8_t changedMask;
+};
+
+// Starts an upstream POST/PATCH to a registered template; the body follows as ProxyBodyChunkState.
+struct __attribute__((packed)) ProxyUploadState {
+  Header header;
+  uint16_t uploadId;
+  uint8_t templateId;
+  uint8_t contentType;
+  uint16_t bodyLen;
+  uint16_t totalChunks;
+};
+
 struct __attribute__((packed)) WeatherState {
   Header header;
   uint8_t ok;
@@ -70,6 +159,140 @@ struct __attribute__((packed)) WeatherState {
   uint16_t winddirection;
 };
 
+// Filtered battery snapshot. `charging` is ChargingState from battery_manager.h
+// (0 unknown, 1 not connected, 2 charging, 3 complete); runtimeMinutes is 0xFFFF when unknown.
+struct __attribute__((packed)) BatteryState {
+  Header header;
+  uint16_t voltageMv;
+  uint8_t percent;
+  uint8_t charging;
+  uint16_t runtimeMinutes;
+};
+
+// Active battery-driven reporting policy; `level` is app::power::PowerLevel
+// (0 normal, 1 saver, 2 low, 3 critical). Intervals of 0 mean the activity is suspended.
+struct __attribute__((packed)) PowerPolicyState {
+  Header header;
+  uint8_t level;
+  uint8_t batteryPercent;
+  uint16_t sensorIntervalS;
+  uint16_t batteryIntervalS;
+  uint16_t weatherIntervalMin;
+  uint16_t helloIntervalS;
+};
+
+struct __attribute__((packed)) SensorHistoryEntry {
+  uint32_t ageS;  // seconds before the frame was sent
+  int16_t temperature10;
+  uint16_t humidity10;
+};
+
+enum class HistorySource : uint8_t {
+  StoreAndForward = 0,  // recorded while the master was unreachable
+  RawRequest = 1,       // answer to SensorRawReqCommand
+};
+
+// Past sensor readings, oldest first; `count` entries follow the struct. `remaining` is how many
+// more entries are still queued after this frame.
+struct __attribute__((packed)) SensorHistoryState {
+  Header header;
+  uint8_t count;
+  uint8_t source;  // HistorySource
+  uint16_t remaining;
+};
+
+// Windowed statistics sent instead of raw SensorState once FeatureSensorAggregate is negotiated.
+// min/max in tenths, mean in hundredths, variance in hundredths squared (population).
+struct __attribute__((packed)) SensorAggregateState {
+  Header header;
+  uint16_t windowS;
+  uint16_t count;
+  uint32_t windowEndAgeS;  // seconds between the window end and this frame
+  int16_t temperatureMin10;
+  int16_t temperatureMax10;
+  int16_t temperatureMean100;
+  uint32_t temperatureVariance10000;
+  uint16_t humidityMin10;
+  uint16_t humidityMax10;
+  uint16_t humidityMean100;
+  uint32_t humidityVariance10000;
+};
+
+static constexpr size_t kMemStatsMaxTasks = 6;
+static constexpr size_t kMemStatsTaskNameBytes = 12;
+
+struct __attribute__((packed)) MemStatsTask {
+  char name[kMemStatsTaskNameBytes];
+  uint16_t stackFreeMin;  // stack high-water mark: fewest bytes ever left free
+  uint16_t reserved;
+};
+
+// Periodic memory health. Heap figures are internal RAM (MALLOC_CAP_INTERNAL); PSRAM fields are
+// 0 on boards without it. json* counters are the SpiAllocator totals since boot (every
+// SpiJsonDocument). `taskCount` MemStatsTask entries follow the struct.
+struct __attribute__((packed)) MemStatsState {
+  Header header;
+  uint32_t uptimeS;
+  uint32_t heapFree;
+  uint32_t heapLargestBlock;
+  uint32_t heapMinFree;  // lowest free internal heap since boot
+  uint32_t psramFree;
+  uint32_t psramTotal;
+  uint32_t jsonAllocations;
+  uint32_t jsonFrees;
+  uint32_t jsonLiveBytes;
+  uint32_t jsonPeakBytes;
+  uint16_t jsonFailures;
+  uint8_t taskCount;
+  uint8_t reserved;
+};
+
+enum class ProfileKind : uint8_t {
+  Sections = 0,    // ProfileSection entries: latency histograms of instrumented code
+  Tasks = 1,       // ProfileCpu entries: FreeRTOS tasks (needs run-time stats in sdkconfig)
+  Coroutines = 2,  // ProfileCpu entries: coroutines on app_task
+};
+
+// Section ids of ProfileSection::section.
+enum class ProfileSectionId : uint8_t {
+  RxCallback = 0,     // SlaveNode::onReceiveStatic
+  SlaveLoop = 1,      // SlaveNode::loop
+  ChunkHandling = 2,  // WeatherCommandPipeline::handleCommand
+  JsonExtract = 3,    // weather field extraction from the proxy body
+  SendToMaster = 4,   // SlaveNode::sendToMaster
+  Count,
+};
+
+static constexpr size_t kProfileBuckets = 10;
+// bucket i counts calls shorter than kProfileFirstBucketUs << i; the last one everything longer
+static constexpr uint32_t kProfileFirstBucketUs = 16;
+static constexpr size_t kProfileMaxCpuEntries = 12;
+static constexpr size_t kProfileNameBytes = 12;
+
+struct __attribute__((packed)) ProfileSection {
+  uint8_t section;  // ProfileSectionId
+  uint8_t reserved;
+  uint32_t count;
+  uint32_t totalUs;
+  uint32_t maxUs;
+  uint16_t buckets[kProfileBuckets];  // saturating
+};
+
+struct __attribute__((packed)) ProfileCpu {
+  char name[kProfileNameBytes];
+  uint16_t permille;  // share of one core over the window
+};
+
+// Profiling report for one window (PROFILING_ENABLED builds only); each kind is its own frame and
+// counters restart with every report. `count` entries follow the struct.
+struct __attribute__((packed)) ProfileState {
+  Header header;
+  uint8_t kind;  // ProfileKind
+  uint8_t count;
+  uint16_t reserved;
+  uint32_t windowMs;
+};
+
 struct __attribute__((packed)) MasterNetState {
   Header header;
   uint8_t online;
@@ -84,7 +307,8 @@ struct __attribute__((packed)) FeaturesState {
   Header header;
   uint32_t featureBits;
   uint16_t contractVersion;
-  uint16_t reserved;
+  uint8_t fecGroupSize;  // data chunks per parity chunk requested with FeatureProxyFec, 0 = none
+  uint8_t reserved;
 };
 
 static constexpr size_t kProxyChunkDataBytes = 160;
@@ -100,6 +324,95 @@ struct __attribute__((packed)) ProxyRespChunkCommand {
   uint8_t data[kProxyChunkDataBytes];
 };
 
+struct __attribute__((packed)) ProxyBodyChunkState {
+  Header header;
+  uint16_t uploadId;
+  uint16_t idx;
+  uint16_t total;
+  uint8_t dataLen;
+  uint8_t data[kProxyChunkDataBytes];
+};
+
+struct __attribute__((packed)) ProxyUploadResultCommand {
+  Header header;
+  uint16_t uploadId;
+  uint8_t ok;
+  int16_t code;
+};
+
+// Variable-length chunk sent once large frames are negotiated; `dataLen` bytes follow the struct.
+struct __attribute__((packed)) ProxyRespChunkLargeCommand {
+  Header header;
+  uint16_t requestId;
+  uint16_t idx;
+  uint16_t total;
+  uint8_t ok;
+  int16_t code;
+  uint16_t dataLen;
+};
+
+// Large-frame variants of ProxyBodyChunkState and ProxyTemplateState, sent once large frames are
+// negotiated; `dataLen` / `textLen` bytes (up to the link's chunk size) follow the struct.
+struct __attribute__((packed)) ProxyBodyChunkLargeState {
+  Header header;
+  uint16_t uploadId;
+  uint16_t idx;
+  uint16_t total;
+  uint16_t dataLen;
+};
+
+struct __attribute__((packed)) ProxyTemplateLargeState {
+  Header header;
+  uint8_t templateId;
+  uint8_t method;
+  uint8_t part;
+  uint8_t totalParts;
+  uint16_t textLen;
+};
+
+// Sent after each group of FeaturesState::fecGroupSize data chunks once FeatureProxyFec is
+// negotiated, so the pipeline rebuilds one lost chunk per group instead of re-requesting the
+// response. XOR of the data chunks idx in [(group - 1) * groupSize + 1, group * groupSize] (clamped to total),
+// each zero-padded to the full chunk size. `dataLen` is that chunk size and `lenXor` the XOR of the
+// chunks' dataLen values; `dataLen` parity bytes follow the struct.
+struct __attribute__((packed)) ProxyRespParityCommand {
+  Header header;
+  uint16_t requestId;
+  uint16_t group;
+  uint16_t total;
+  uint8_t groupSize;
+  uint8_t ok;
+  int16_t code;
+  uint16_t lenXor;
+  uint16_t dataLen;
+};
+
+// Master lost a delta (sequence gap) or has no base for `recordType`; the slave answers with a keyframe.
+struct __attribute__((packed)) KeyframeReqCommand {
+  Header header;
+  uint8_t recordType;
+};
+
+// Asks for the raw readings between fromAgeS and toAgeS seconds ago (fromAgeS >= toAgeS); answered
+// with SensorHistoryState frames marked HistorySource::RawRequest.
+struct __attribute__((packed)) SensorRawReqCommand {
+  Header header;
+  uint32_t fromAgeS;
+  uint32_t toAgeS;
+};
+
+// Master capabilities, sent in reply to FeaturesState. v1 masters never send it, so every opt-in
+// feature stays off until this arrives. FeatureLargeFrame with kContractVersionLargeFrame switches
+// the link to PROTOCOL_VERSION_LARGE framing and the *Large records, sized by maxPayload and
+// chunkDataBytes. The negotiation is reset when the master times out.
+struct __attribute__((packed)) MasterFeaturesCommand {
+  Header header;
+  uint32_t featureBits;
+  uint16_t contractVersion;
+  uint16_t maxPayload;
+  uint16_t chunkDataBytes;
+};
+
 struct __attribute__((packed)) WeatherSyncReqCommand {
   Header header;
   uint8_t force;
@@ -109,7 +422,14 @@ struct __attribute__((packed)) IdentityReqCommand {
   Header header;
 };
 
-inline void initHeader(Header& header, Type type) {
+// Master reply to a template registration, or to a request naming an unknown template (ok = 0).
+struct __attribute__((packed)) ProxyTemplateAckCommand {
+  Header header;
+  uint8_t templateId;
+  uint8_t ok;
+};
+
+constexpr void initHeader(Header& header, Type type) {
   header.magic = kMagic;
   header.version = kVersion;
   header.type = static_cast<uint8_t>(type);
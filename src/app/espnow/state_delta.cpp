@@ -0,0 +1,121 @@
+#include "state_delta.h"
+
+#include <cstring>
+
+namespace app::espnow {
+
+int StateDeltaEncoder::layoutIndex(uint8_t recordType) {
+  for (size_t index = 0; index < kDeltaLayoutCount; ++index) {
+    if (static_cast<uint8_t>(kDeltaLayouts[index].type) == recordType) {
+      return static_cast<int>(index);
+    }
+  }
+  return -1;
+}
+
+void StateDeltaEncoder::requestKeyframe(uint8_t recordType) {
+  const int index = layoutIndex(recordType);
+  if (index >= 0) {
+    slots[index].forceKeyframe = true;
+  }
+}
+
+void StateDeltaEncoder::reset() {
+  for (auto& slot : slots) {
+    slot = Slot{};
+  }
+}
+
+size_t StateDeltaEncoder::writeKeyframe(Slot& slot,
+                                        const uint8_t* record,
+                                        size_t size,
+                                        uint8_t* out,
+                                        size_t capacity) {
+  if (size > capacity) {
+    return 0;
+  }
+
+  memcpy(slot.last, record, size);
+  slot.valid = true;
+  slot.forceKeyframe = false;
+  slot.sinceKeyframe = 0;
+  slot.sequence++;
+
+  memcpy(out, record, size);
+  reinterpret_cast<state_binary::Header*>(out)->reserved = slot.sequence;
+  counters.keyframes++;
+  counters.rawBytes += size;
+  counters.encodedBytes += size;
+  return size;
+}
+
+size_t StateDeltaEncoder::encode(const uint8_t* record, size_t size, uint8_t* out, size_t capacity, bool& delta) {
+  delta = false;
+  if (!state_binary::hasValidHeader(record, size) || out == nullptr) {
+    return 0;
+  }
+
+  const uint8_t recordType = reinterpret_cast<const state_binary::Header*>(record)->type;
+  const int index = layoutIndex(recordType);
+  if (index < 0 || kDeltaLayouts[index].size != size) {
+    return 0;
+  }
+
+  const RecordLayout& layout = kDeltaLayouts[index];
+  Slot& slot = slots[index];
+  if (!slot.valid || slot.forceKeyframe || slot.sinceKeyframe + 1 >= keyframeInterval) {
+    return writeKeyframe(slot, record, size, out, capacity);
+  }
+
+  uint8_t mask = 0;
+  size_t deltaSize = sizeof(state_binary::StateDeltaState);
+  for (uint8_t field = 0; field < layout.fieldCount; ++field) {
+    const FieldSpan& span = layout.fields[field];
+    if (memcmp(record + span.offset, slot.last + span.offset, span.size) != 0) {
+      mask |= static_cast<uint8_t>(1U << field);
+      deltaSize += span.size;
+    }
+  }
+
+  // a delta that is not smaller than the record is pointless, send a keyframe instead
+  if (deltaSize >= size || deltaSize > capacity) {
+    return writeKeyframe(slot, record, size, out, capacity);
+  }
+
+  auto* header = reinterpret_cast<state_binary::StateDeltaState*>(out);
+  slot.sequence++;
+  slot.sinceKeyframe++;
+  header->typeSequence = static_cast<uint8_t>((index << state_binary::kDeltaSequenceBits) |
+                                              (slot.sequence & state_binary::kDeltaSequenceMask));
+  header->changedMask = mask;
+
+  size_t pos = sizeof(state_binary::StateDeltaState);
+  for (uint8_t field = 0; field < layout.fieldCount; ++field) {
+    if ((mask & (1U << field)) == 0) {
+      continue;
+    }
+    const FieldSpan& span = layout.fields[field];
+    memcpy(out + pos, record + span.offset, span.size);
+    pos += span.size;
+  }
+
+  memcpy(slot.last, record, size);
+  delta = true;
+  counters.deltas++;
+  counters.rawBytes += size;
+  counters.encodedBytes += pos;
+  return pos;
+}
+
+size_t StateDeltaEncoder::keyframe(uint8_t recordType, uint8_t* out, size_t capacity) {
+  const int index = layoutIndex(recordType);
+  if (index < 0 || !slots[index].valid) {
+    return 0;
+  }
+
+  uint8_t record[kMaxDeltaRecordBytes];
+  memcpy(record, slots[index].last, kDeltaLayouts[index].size);
+  return writeKeyframe(slots[index], record, kDeltaLayouts[index].size, out, capacity);
+}
+
+}  // namespace app::espnow
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cstddef>
+
+#include "state_binary.h"
+
+namespace app::espnow {
+
+static constexpr size_t kMaxDeltaFields = 8;
+static constexpr size_t kMaxDeltaRecordBytes = 64;
+
+struct FieldSpan {
+  uint8_t offset;
+  uint8_t size;
+};
+
+struct RecordLayout {
+  state_binary::Type type;
+  uint8_t size;
+  uint8_t fieldCount;
+  FieldSpan fields[kMaxDeltaFields];
+};
+
+// Field layouts of delta-tracked records; add an entry here to track a new record type. The
+// index is sent in every delta, so entries are only ever appended. Fields cover every byte after
+// the Header exactly once; WeatherState::time is split so an update that only moves the clock
+// sends "THH:MM" and not the whole string.
+inline constexpr RecordLayout kDeltaLayouts[] = {
+    {state_binary::Type::Sensor,
+     sizeof(state_binary::SensorState),
+     2,
+     {{offsetof(state_binary::SensorState, temperature10), 2}, {offsetof(state_binary::SensorState, humidity10), 2}}},
+    {state_binary::Type::Weather,
+     sizeof(state_binary::WeatherState),
+     7,
+     {{offsetof(state_binary::WeatherState, ok), 3},         // ok and code
+      {offsetof(state_binary::WeatherState, time), 10},      // YYYY-MM-DD
+      {offsetof(state_binary::WeatherState, time) + 10, 6},  // THH:MM
+      {offsetof(state_binary::WeatherState, time) + 16, 4},  // seconds or padding
+      {offsetof(state_binary::WeatherState, temperature10), 2},
+      {offsetof(state_binary::WeatherState, windspeed10), 2},
+      {offsetof(state_binary::WeatherState, winddirection), 2}}},
+};
+
+inline constexpr size_t kDeltaLayoutCount = sizeof(kDeltaLayouts) / sizeof(kDeltaLayouts[0]);
+
+constexpr bool deltaLayoutsValid() {
+  for (const auto& layout : kDeltaLayouts) {
+    if (layout.size > kMaxDeltaRecordBytes || layout.fieldCount > kMaxDeltaFields) {
+      return false;
+    }
+    uint8_t covered[kMaxDeltaRecordBytes] = {};
+    for (uint8_t index = 0; index < layout.fieldCount; ++index) {
+      const FieldSpan& span = layout.fields[index];
+      if (span.offset < sizeof(state_binary::Header) || span.offset + span.size > layout.size) {
+        return false;
+      }
+      for (uint8_t byte = span.offset; byte < span.offset + span.size; ++byte) {
+        covered[byte]++;
+      }
+    }
+    for (size_t byte = sizeof(state_binary::Header); byte < layout.size; ++byte) {
+      if (covered[byte] != 1) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static_assert(deltaLayoutsValid(), "Delta layout exceeds record or field limits, or misses or repeats a byte");
+static_assert(kDeltaLayoutCount <= (1U << (8 - state_binary::kDeltaSequenceBits)),
+              "More delta layouts than StateDeltaState::typeSequence can index");
+
+// Turns full records into keyframes or field-level deltas. Pure logic; callers serialize access.
+class StateDeltaEncoder {
+ public:
+  struct Stats {
+    uint32_t keyframes = 0;
+    uint32_t deltas = 0;
+    uint32_t rawBytes = 0;
+    uint32_t encodedBytes = 0;
+  };
+
+  explicit StateDeltaEncoder(uint8_t keyframeInterval) : keyframeInterval(keyframeInterval) {}
+
+  // Writes the bytes to send for `record` into `out` and sets `delta` when they are a
+  // StateDeltaState (PacketType::STATE_DELTA) rather than a keyframe (PacketType::STATE).
+  // Returns 0 when the record type is not delta-tracked, so the caller sends it unchanged.
+  size_t encode(const uint8_t* record, size_t size, uint8_t* out, size_t capacity, bool& delta);
+
+  // Rebuilds a keyframe from the last record of `recordType`; returns 0 when none was sent yet.
+  size_t keyframe(uint8_t recordType, uint8_t* out, size_t capacity);
+
+  void requestKeyframe(uint8_t recordType);
+  void reset();
+  const Stats& stats() const { return counters; }
+
+ private:
+  struct Slot {
+    uint8_t last[kMaxDeltaRecordBytes] = {0};
+    bool valid = false;
+    bool forceKeyframe = true;
+    uint8_t sequence = 0;
+    uint8_t sinceKeyframe = 0;
+  };
+
+  static int layoutIndex(uint8_t recordType);
+  size_t writeKeyframe(Slot& slot, const uint8_t* record, size_t size, uint8_t* out, size_t capacity);
+
+  const uint8_t keyframeInterval;
+  Slot slots[kDeltaLayoutCount];
+  Stats counters;
+};
+
+}  // namespace app::espnow
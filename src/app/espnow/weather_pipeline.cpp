@@ -3,7 +3,10 @@
 #include "payload_codec.h"
 #include "state_binary.h"
 #include <app_config.h>
+#include "app/static_config.h"
+#include "app/telemetry/profiler.h"
 
+#include <core/mem_tier.h>
 #include <esp_log.h>
 
 namespace app::espnow {
@@ -19,120 +22,192 @@ void WeatherCommandPipeline::injectStateSink(IStateSink* sink) {
 }
 
 bool WeatherCommandPipeline::begin() {
-  if (queue != nullptr && task != nullptr) {
+  if (commands != nullptr) {
     return true;
   }
 
-  queue = xQueueCreate(kQueueDepth, sizeof(CommandJob));
-  if (queue == nullptr) {
-    ESP_LOGE(TAG, "Failed creating command queue");
+  // written from the receive callback; static storage stays in internal RAM (queue tier)
+  commands = xRingbufferCreateStatic(kCommandBufferBytes, RINGBUF_TYPE_NOSPLIT, commandStorage, &commandControl);
+  if (commands == nullptr) {
+    ESP_LOGE(TAG, "Failed creating command buffer");
     return false;
   }
+  mem::place(mem::MemClass::Queue, commandStorage, sizeof(commandStorage));
 
-  const BaseType_t created = xTaskCreatePinnedToCore(
-      taskEntry,
-      "weather_pipe",
-      kTaskStackWords,
-      this,
-      kTaskPriority,
-      &task,
-      tskNO_AFFINITY);
-
-  if (created != pdPASS) {
-    ESP_LOGE(TAG, "Failed creating weather pipeline task");
+  auto* storage = static_cast<uint8_t*>(mem::allocate(mem::MemClass::Bulk, ChunkAssembler::kMaxBytes));
+  if (storage == nullptr) {
+    ESP_LOGE(TAG, "Failed allocating reassembly buffer");
     return false;
   }
+  assembler.attachBuffer(storage);
 
   ESP_LOGI(TAG, "Weather pipeline ready");
   return true;
 }
 
 bool WeatherCommandPipeline::submitCommand(const uint8_t* payload, size_t payloadSize) {
-  if (queue == nullptr || payload == nullptr || payloadSize == 0 || payloadSize > MAX_PAYLOAD_SIZE) {
+  if (commands == nullptr || payload == nullptr || payloadSize == 0 || payloadSize > kMaxCommandBytes) {
     return false;
   }
 
-  CommandJob job;
-  memcpy(job.payload, payload, payloadSize);
-  job.payloadSize = static_cast<uint8_t>(payloadSize);
-
-  if (xQueueSend(queue, &job, 0) != pdTRUE) {
-    ESP_LOGW(TAG, "Command queue full, dropping payload");
+  if (xRingbufferSend(commands, payload, payloadSize, 0) != pdTRUE) {
+    ESP_LOGW(TAG, "Command buffer full, dropping payload");
     return false;
   }
 
   return true;
 }
 
-void WeatherCommandPipeline::taskEntry(void* context) {
-  auto* self = static_cast<WeatherCommandPipeline*>(context);
-  if (self == nullptr) {
-    vTaskDelete(nullptr);
-    return;
-  }
+coro::Task WeatherCommandPipeline::run() {
+  while (true) {
+    // drain everything the receive callback queued since the last pass
+    size_t itemSize = 0;
+    uint8_t* item = nullptr;
+    while (commands != nullptr &&
+           (item = static_cast<uint8_t*>(xRingbufferReceive(commands, &itemSize, 0))) != nullptr) {
+      handleCommand(item, itemSize);
+      vRingbufferReturnItem(commands, item);
+    }
 
-  self->taskLoop();
+    co_await coro::delay(kPollIntervalMs);
+  }
 }
 
-void WeatherCommandPipeline::taskLoop() {
-  CommandJob job;
-  while (true) {
-    if (xQueueReceive(queue, &job, portMAX_DELAY) != pdTRUE) {
-      continue;
+bool WeatherCommandPipeline::parseChunk(const uint8_t* payload, size_t payloadSize, ChunkView& out) const {
+  using namespace app::espnow::state_binary;
+
+  if (hasTypeAndSize(payload, payloadSize, Type::ProxyRespChunk, sizeof(ProxyRespChunkCommand))) {
+    const auto* command = reinterpret_cast<const ProxyRespChunkCommand*>(payload);
+    if (command->dataLen > kProxyChunkDataBytes) {
+      return false;
     }
+    out = {command->requestId,
+           command->idx,
+           command->total,
+           command->ok,
+           command->code,
+           kProxyChunkDataBytes,
+           command->data,
+           command->dataLen};
+    return true;
+  }
 
-    handleCommand(job.payload, job.payloadSize);
+  if (!hasValidHeader(payload, payloadSize) || payloadSize < sizeof(ProxyRespChunkLargeCommand)) {
+    return false;
   }
+
+  const auto* command = reinterpret_cast<const ProxyRespChunkLargeCommand*>(payload);
+  if (command->header.type != static_cast<uint8_t>(Type::ProxyRespChunkLarge) ||
+      payloadSize != sizeof(ProxyRespChunkLargeCommand) + command->dataLen) {
+    return false;
+  }
+
+  out = {command->requestId,
+         command->idx,
+         command->total,
+         command->ok,
+         command->code,
+         largeChunkDataBytes,
+         payload + sizeof(ProxyRespChunkLargeCommand),
+         command->dataLen};
+  return true;
 }
 
-void WeatherCommandPipeline::handleCommand(const uint8_t* payload, uint8_t payloadSize) {
-  if (!app::espnow::state_binary::hasTypeAndSize(payload,
-                                                  payloadSize,
-                                                  app::espnow::state_binary::Type::ProxyRespChunk,
-                                                  sizeof(app::espnow::state_binary::ProxyRespChunkCommand))) {
-    ESP_LOGW(TAG, "Invalid command struct, ignored");
-    return;
+bool WeatherCommandPipeline::handleParity(const uint8_t* payload, size_t payloadSize) {
+  using namespace app::espnow::state_binary;
+
+  if (!hasValidHeader(payload, payloadSize) || payloadSize < sizeof(ProxyRespParityCommand)) {
+    return false;
   }
 
-  const auto* command = reinterpret_cast<const app::espnow::state_binary::ProxyRespChunkCommand*>(payload);
-  if (command->idx == 0 || command->total == 0 || command->idx > command->total ||
-      command->dataLen > app::espnow::state_binary::kProxyChunkDataBytes) {
-    ESP_LOGW(TAG, "Invalid proxy chunk fields");
-    return;
+  const auto* command = reinterpret_cast<const ProxyRespParityCommand*>(payload);
+  if (command->header.type != static_cast<uint8_t>(Type::ProxyRespParity) ||
+      payloadSize != sizeof(ProxyRespParityCommand) + command->dataLen) {
+    return false;
   }
 
-  const String dataChunk(reinterpret_cast<const char*>(command->data), command->dataLen);
+  const auto recoveredBefore = assembler.stats().recovered;
+  const auto result = assembler.addParity(command->requestId,
+                                          command->group,
+                                          command->groupSize,
+                                          command->total,
+                                          command->ok,
+                                          command->code,
+                                          command->lenXor,
+                                          payload + sizeof(ProxyRespParityCommand),
+                                          command->dataLen);
+  if (assembler.stats().recovered != recoveredBefore) {
+    ESP_LOGI(TAG, "Rebuilt lost chunk from parity id=%u group=%u", command->requestId, command->group);
+  }
 
-  if (command->idx == 1 || String(command->requestId) != chunk.id) {
-    chunk.id = String(command->requestId);
-    chunk.total = command->total;
-    chunk.nextIndex = 1;
-    chunk.buffer = "";
+  if (result == ChunkAssembler::Result::Complete) {
+    completeAssembly();
+  } else if (result == ChunkAssembler::Result::Rejected) {
+    ESP_LOGW(TAG, "Invalid parity chunk id=%u group=%u", command->requestId, command->group);
   }
+  return true;
+}
 
-  if (String(command->requestId) != chunk.id || command->total != chunk.total || command->idx != chunk.nextIndex) {
-    ESP_LOGW(TAG,
-             "Out-of-order chunk id=%u idx=%u expected=%u",
-             command->requestId,
-             command->idx,
-             chunk.nextIndex);
+void WeatherCommandPipeline::handleCommand(const uint8_t* payload, size_t payloadSize) {
+  const app::telemetry::profiler::Scope profile(app::telemetry::profiler::Section::ChunkHandling);
+  if (handleParity(payload, payloadSize)) {
     return;
   }
 
-  if (chunk.buffer.length() + dataChunk.length() > kMaxAssembledBytes) {
-    ESP_LOGW(TAG, "Chunk assembly overflow, reset");
-    chunk = ChunkState{};
+  ChunkView command;
+  if (!parseChunk(payload, payloadSize, command)) {
+    ESP_LOGW(TAG, "Invalid command struct, ignored");
+    return;
+  }
+
+  const auto result = assembler.addData(command.requestId,
+                                        command.idx,
+                                        command.total,
+                                        command.ok,
+                                        command.code,
+                                        command.stride,
+                                        command.data,
+                                        command.dataLen);
+  if (result == ChunkAssembler::Result::Rejected) {
+    ESP_LOGW(TAG, "Invalid proxy chunk id=%u idx=%u total=%u len=%u",
+             command.requestId, command.idx, command.total, static_cast<unsigned>(command.dataLen));
     return;
   }
 
-  chunk.buffer += dataChunk;
-  chunk.nextIndex++;
+  if (result == ChunkAssembler::Result::Complete) {
+    completeAssembly();
+  }
+}
 
-  if (command->idx == command->total) {
-    ESP_LOGI(TAG, "Chunk assemble complete (%u chunks)", command->total);
-    handleProxyPayload(command->ok, command->code, chunk.buffer);
-    chunk = ChunkState{};
+void WeatherCommandPipeline::completeAssembly() {
+  const auto& stats = assembler.stats();
+  ESP_LOGI(TAG, "Chunk assemble complete (%u chunks, %u bytes)", assembler.chunkCount(),
+           static_cast<unsigned>(assembler.length()));
+  if (stats.parityChunks > 0) {
+    ESP_LOGI(TAG,
+             "FEC: parity=%lu/%lu data (%.0f%% overhead) recovered=%lu unrecoverable=%lu",
+             static_cast<unsigned long>(stats.parityChunks),
+             static_cast<unsigned long>(stats.dataChunks),
+             stats.dataChunks > 0 ? 100.0f * stats.parityChunks / stats.dataChunks : 0.0f,
+             static_cast<unsigned long>(stats.recovered),
+             static_cast<unsigned long>(stats.unrecoverable));
   }
+  if (++windowResponses >= kLossWindowResponses) {
+    const auto window = assembler.takeWindow();
+    windowResponses = 0;
+    ESP_LOGI(TAG,
+             "Chunk loss over last %lu responses: %.1f%% (%lu/%lu chunks) recovered=%lu abandoned=%lu late=%lu",
+             static_cast<unsigned long>(window.responses),
+             100.0f * window.lossRate(),
+             static_cast<unsigned long>(window.lostChunks),
+             static_cast<unsigned long>(window.expectedChunks),
+             static_cast<unsigned long>(window.recovered),
+             static_cast<unsigned long>(window.abandoned),
+             static_cast<unsigned long>(window.late));
+  }
+
+  const String responseBody(reinterpret_cast<const char*>(assembler.data()), assembler.length());
+  handleProxyPayload(assembler.ok(), assembler.code(), responseBody);
 }
 
 void WeatherCommandPipeline::handleProxyPayload(uint8_t ok, int16_t code, const String& responseBody) {
@@ -177,6 +252,7 @@ bool WeatherCommandPipeline::parseWeatherFields(const String& proxyData,
                                                 String& temperature,
                                                 String& windspeed,
                                                 String& winddirection) {
+  const app::telemetry::profiler::Scope profile(app::telemetry::profiler::Section::JsonExtract);
   weatherCode = "";
   time = "";
   temperature = "";
@@ -2,9 +2,11 @@
 
 #include <Arduino.h>
 #include <freertos/FreeRTOS.h>
-#include <freertos/queue.h>
-#include <freertos/task.h>
+#include <freertos/ringbuf.h>
+#include <core/coro.h>
 
+#include "app/static_config.h"
+#include "chunk_assembler.h"
 #include "protocol.h"
 
 namespace app::espnow {
@@ -27,29 +29,37 @@ class WeatherCommandPipeline : public ICommandTaskSink {
 
   void injectStateSink(IStateSink* sink);
   bool begin();
+  // Chunk reassembly loop; spawned on the shared executor after begin().
+  coro::Task run();
   bool submitCommand(const uint8_t* payload, size_t payloadSize) override;
 
- private:
-  static constexpr uint8_t kQueueDepth = 10;
-  static constexpr size_t kMaxAssembledBytes = 1024;
-  static constexpr uint16_t kTaskStackWords = 6144;
-  static constexpr UBaseType_t kTaskPriority = 2;
+  // Chunk size of ProxyRespChunkLarge data, follows the negotiated link parameters.
+  void setLargeChunkDataBytes(size_t bytes) { largeChunkDataBytes = bytes; }
+  const ChunkAssembler::Stats& chunkStats() const { return assembler.stats(); }
 
-  struct CommandJob {
-    uint8_t payload[MAX_PAYLOAD_SIZE] = {0};
-    uint8_t payloadSize = 0;
-  };
+ private:
+  // byte ring instead of a fixed-slot queue so v1 and large-frame commands share one buffer
+  static constexpr size_t kCommandBufferBytes = app::static_config::kCommandRingBytes;
+  static constexpr size_t kMaxCommandBytes = LARGE_FRAMES_SUPPORTED ? MAX_LARGE_PAYLOAD_SIZE : MAX_PAYLOAD_SIZE;
+  static constexpr uint32_t kPollIntervalMs = 10;
+  // responses per logged loss-rate window
+  static constexpr uint32_t kLossWindowResponses = 16;
 
-  struct ChunkState {
-    String id;
+  struct ChunkView {
+    uint16_t requestId = 0;
+    uint16_t idx = 0;
     uint16_t total = 0;
-    uint16_t nextIndex = 1;
-    String buffer;
+    uint8_t ok = 0;
+    int16_t code = 0;
+    size_t stride = 0;
+    const uint8_t* data = nullptr;
+    size_t dataLen = 0;
   };
 
-  static void taskEntry(void* context);
-  void taskLoop();
-  void handleCommand(const uint8_t* payload, uint8_t payloadSize);
+  void handleCommand(const uint8_t* payload, size_t payloadSize);
+  bool parseChunk(const uint8_t* payload, size_t payloadSize, ChunkView& out) const;
+  bool handleParity(const uint8_t* payload, size_t payloadSize);
+  void completeAssembly();
   void handleProxyPayload(uint8_t ok, int16_t code, const String& responseBody);
   bool parseWeatherFields(const String& proxyData,
                           String& weatherCode,
@@ -61,9 +71,12 @@ class WeatherCommandPipeline : public ICommandTaskSink {
   bool extractJsonField(const String& objectText, const char* field, String& valueOut);
 
   IStateSink* stateSink = nullptr;
-  QueueHandle_t queue = nullptr;
-  TaskHandle_t task = nullptr;
-  ChunkState chunk;
+  RingbufHandle_t commands = nullptr;
+  StaticRingbuffer_t commandControl;
+  alignas(4) uint8_t commandStorage[kCommandBufferBytes];
+  volatile size_t largeChunkDataBytes = 0;
+  ChunkAssembler assembler;
+  uint32_t windowResponses = 0;
 };
 
 }  // namespace app::espnow
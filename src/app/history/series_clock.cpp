@@ -0,0 +1,78 @@
+#include "series_clock.h"
+
+#include "app/storage/persistence.h"
+
+#include <app_config.h>
+
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_rtc_time.h>
+
+namespace app::history {
+
+namespace {
+
+static constexpr const char* TAG = "series_clock";
+static constexpr const char* kFloorKey = "clock.floor";
+static constexpr uint32_t kClockMagic = 0x53434B31;  // "SCK1"
+
+struct RtcClock {
+  uint32_t magic;
+  uint32_t magicInverse;
+  uint32_t offsetS;
+};
+
+// not cleared on reset; validated in begin()
+RTC_NOINIT_ATTR RtcClock rtcClock;
+
+// a staged floor may be lost to a power cut; the one already on flash must still be ahead
+static_assert(PERSIST_FLUSH_WINDOW_MS / 1000 < SeriesClock::kFloorStepS / 2,
+              "Clock floor could fall behind while a new one waits for the persistence flush");
+
+uint32_t rtcSeconds() {
+  return static_cast<uint32_t>(esp_rtc_get_time_us() / 1000000ULL);
+}
+
+}  // namespace
+
+SeriesClock seriesClock;
+
+void SeriesClock::begin() {
+  String text;
+  const uint32_t stored = app::storage::persistence.load(kFloorKey, text) ? strtoul(text.c_str(), nullptr, 10) : 0;
+  floorS = stored;
+
+  const bool valid = rtcClock.magic == kClockMagic && rtcClock.magicInverse == ~kClockMagic;
+  if (!valid) {
+    // power-on: the RTC timer started over, resume at the persisted floor
+    rtcClock.offsetS = stored - rtcSeconds();
+    rtcClock.magic = kClockMagic;
+    rtcClock.magicInverse = ~kClockMagic;
+    ESP_LOGI(TAG, "Power-on, resuming at %lu s", static_cast<unsigned long>(stored));
+  }
+
+  advanceFloor();
+}
+
+uint32_t SeriesClock::nowS() const {
+  return rtcClock.offsetS + rtcSeconds();
+}
+
+void SeriesClock::loop() {
+  advanceFloor();
+}
+
+void SeriesClock::advanceFloor() {
+  const uint32_t now = nowS();
+  if (now + kFloorStepS / 2 < floorS) {
+    return;
+  }
+
+  // moved on even when the save fails so a full flash is not retried every loop
+  floorS = now + kFloorStepS;
+  if (!app::storage::persistence.save(kFloorKey, String(floorS))) {
+    ESP_LOGW(TAG, "Failed to persist clock floor");
+  }
+}
+
+}  // namespace app::history
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace app::history {
+
+// Time base for history samples and sensor aggregates: seconds that only move forward, across
+// software resets, deep sleep and power cycles. It is the RTC timer (which keeps counting through
+// resets and sleep) plus an offset in RTC memory. A power-on loses both, so the clock resumes at
+// a floor saved through persistence up to kFloorStepS ahead of now: a power cycle skips forward
+// by at most that much, never back behind samples already on flash. Nothing on the slave sets the
+// system clock, so time(nullptr) restarts near 0 on every boot and is not used for history.
+class SeriesClock {
+ public:
+  static constexpr uint32_t kFloorStepS = 3600;
+
+  // After persistence.begin(), before anything stamps samples.
+  void begin();
+  uint32_t nowS() const;
+  // Moves the persisted floor ahead before now reaches it (one small record per step).
+  void loop();
+
+ private:
+  void advanceFloor();
+
+  uint32_t floorS = 0;
+};
+
+extern SeriesClock seriesClock;
+
+}  // namespace app::history
@@ -0,0 +1,216 @@
+#include "timeseries_store.h"
+
+#include <LittleFS.h>
+#include <esp_log.h>
+
+namespace app::history {
+
+namespace {
+
+static constexpr const char* TAG = "timeseries";
+static constexpr const char* kSeriesDir = "/data/ts";
+
+struct DownsampleContext {
+  Downsampler* downsampler;
+};
+
+void addToDownsampler(void* context, uint32_t timeS, const int32_t* values) {
+  static_cast<DownsampleContext*>(context)->downsampler->add(timeS, values);
+}
+
+}  // namespace
+
+TimeSeriesStore sensorSeries("sensor", 2, TIMESERIES_MAX_BLOCKS);
+TimeSeriesStore weatherSeries("weather", 3, TIMESERIES_MAX_BLOCKS);
+
+TimeSeriesStore::TimeSeriesStore(const char* name, uint8_t channels, uint16_t blocks)
+    : currentPath(String(kSeriesDir) + "/" + name + ".bin"),
+      oldPath(String(kSeriesDir) + "/" + name + ".old"),
+      channelCount(channels > kMaxChannels ? kMaxChannels : channels),
+      maxBlocks(blocks) {
+  encoder.reset(channelCount);
+}
+
+bool TimeSeriesStore::begin() {
+  if (started) {
+    return true;
+  }
+
+  lock = xSemaphoreCreateMutexStatic(&lockControl);
+  if (lock == nullptr) {
+    return false;
+  }
+
+  if (!LittleFS.exists("/data")) {
+    LittleFS.mkdir("/data");
+  }
+  if (!LittleFS.exists(kSeriesDir)) {
+    LittleFS.mkdir(kSeriesDir);
+  }
+
+  File file = LittleFS.open(currentPath, "r");
+  if (file) {
+    fileBlocks = static_cast<uint16_t>(file.size() / kBlockBytes);
+    file.close();
+  }
+
+  started = true;
+  ESP_LOGI(TAG, "%s: %u blocks on flash", currentPath.c_str(), fileBlocks);
+  return true;
+}
+
+bool TimeSeriesStore::append(uint32_t timeS, const int32_t* values) {
+  if (!started) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  bool ok = encoder.append(timeS, values);
+  if (!ok) {
+    // block full (or the clock went backwards): seal it for loop() and start the next one; a
+    // block sealed before it was written goes out here
+    writeSealedLocked();
+    memcpy(sealed, encoder.data(), kBlockBytes);
+    sealedPending = !encoder.empty();
+    encoder.reset(channelCount);
+    ok = encoder.append(timeS, values);
+  }
+  if (ok) {
+    counters.samples++;
+  }
+  xSemaphoreGive(lock);
+  return ok;
+}
+
+bool TimeSeriesStore::loop() {
+  if (!started) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  const bool ok = writeSealedLocked();
+  xSemaphoreGive(lock);
+  return ok;
+}
+
+bool TimeSeriesStore::sync() {
+  if (!started) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  bool ok = writeSealedLocked();
+  if (!encoder.empty()) {
+    ok = writeBlock(encoder.data()) && ok;
+    encoder.reset(channelCount);
+  }
+  xSemaphoreGive(lock);
+  return ok;
+}
+
+bool TimeSeriesStore::writeSealedLocked() {
+  if (!sealedPending) {
+    return true;
+  }
+  // a failed write drops the block like it did before sealing; the error is counted
+  sealedPending = false;
+  return writeBlock(sealed);
+}
+
+bool TimeSeriesStore::writeBlock(const uint8_t* block) {
+  if (fileBlocks >= maxBlocks) {
+    LittleFS.remove(oldPath);
+    LittleFS.rename(currentPath, oldPath);
+    fileBlocks = 0;
+    counters.rotations++;
+  }
+
+  File file = LittleFS.open(currentPath, "a");
+  if (!file) {
+    counters.writeErrors++;
+    ESP_LOGW(TAG, "Failed to open %s for append", currentPath.c_str());
+    return false;
+  }
+
+  const size_t written = file.write(block, kBlockBytes);
+  file.close();
+  if (written != kBlockBytes) {
+    counters.writeErrors++;
+    ESP_LOGW(TAG, "Short block write to %s (%u bytes)", currentPath.c_str(), static_cast<unsigned>(written));
+    return false;
+  }
+
+  fileBlocks++;
+  counters.blocksWritten++;
+  counters.bytesWritten += kBlockBytes;
+  return true;
+}
+
+size_t TimeSeriesStore::scanBlock(const uint8_t* block, uint32_t fromS, uint32_t toS, SampleFn fn, void* context) {
+  BlockDecoder decoder;
+  if (!decoder.open(block, kBlockBytes) || decoder.header().count == 0) {
+    return 0;
+  }
+  if (decoder.header().lastTimeS < fromS || decoder.header().firstTimeS > toS) {
+    return 0;
+  }
+
+  size_t matched = 0;
+  uint32_t timeS = 0;
+  int32_t values[kMaxChannels] = {0};
+  while (decoder.next(timeS, values)) {
+    if (timeS < fromS) {
+      continue;
+    }
+    if (timeS > toS) {
+      break;
+    }
+    fn(context, timeS, values);
+    matched++;
+  }
+  return matched;
+}
+
+size_t TimeSeriesStore::scanFile(const String& path, uint32_t fromS, uint32_t toS, SampleFn fn, void* context) {
+  File file = LittleFS.open(path, "r");
+  if (!file) {
+    return 0;
+  }
+
+  uint8_t block[kBlockBytes];
+  size_t matched = 0;
+  while (file.read(block, kBlockBytes) == kBlockBytes) {
+    matched += scanBlock(block, fromS, toS, fn, context);
+  }
+  file.close();
+  return matched;
+}
+
+size_t TimeSeriesStore::forEach(uint32_t fromS, uint32_t toS, SampleFn fn, void* context) {
+  if (!started || fn == nullptr || fromS > toS) {
+    return 0;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  size_t matched = scanFile(oldPath, fromS, toS, fn, context);
+  matched += scanFile(currentPath, fromS, toS, fn, context);
+  if (sealedPending) {
+    matched += scanBlock(sealed, fromS, toS, fn, context);
+  }
+  matched += scanBlock(encoder.data(), fromS, toS, fn, context);
+  xSemaphoreGive(lock);
+  return matched;
+}
+
+size_t TimeSeriesStore::downsample(uint32_t fromS, uint32_t toS, uint32_t windowS, WindowAggregate* out, size_t maxOut) {
+  if (out == nullptr || maxOut == 0) {
+    return 0;
+  }
+
+  Downsampler downsampler(windowS, channelCount, out, maxOut);
+  DownsampleContext context = {.downsampler = &downsampler};
+  forEach(fromS, toS, addToDownsampler, &context);
+  return downsampler.finish();
+}
+
+}  // namespace app::history
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "ts_codec.h"
+
+#include <app_config.h>
+
+namespace app::history {
+
+struct StoreStats {
+  uint32_t samples = 0;
+  uint32_t blocksWritten = 0;
+  uint32_t bytesWritten = 0;
+  uint32_t rotations = 0;
+  uint32_t writeErrors = 0;
+};
+
+// Append-only time series on LittleFS, one file per series. Samples collect in a RAM block that
+// is written whole (kBlockBytes) once full, so flash only ever sees block-sized appends. A full
+// block is sealed in RAM and written by loop(), so append() never touches flash. When the file
+// reaches maxBlocks it becomes <name>.old and a new file starts; queries cover both files plus
+// the sealed and unsealed RAM blocks. append() from one task; queries from any task.
+class TimeSeriesStore {
+ public:
+  using SampleFn = void (*)(void* context, uint32_t timeS, const int32_t* values);
+
+  TimeSeriesStore(const char* name, uint8_t channels, uint16_t maxBlocks);
+
+  bool begin();
+  bool append(uint32_t timeS, const int32_t* values);
+  // Writes a sealed block, if any; called from the storage coroutine.
+  bool loop();
+  // Writes the unsealed block padded to full size (before sleep/shutdown); the next sample
+  // starts a fresh block.
+  bool sync();
+
+  // Calls fn for every sample in [fromS, toS], oldest first; returns the number of samples.
+  size_t forEach(uint32_t fromS, uint32_t toS, SampleFn fn, void* context);
+  // min/max/avg per windowS-aligned window over [fromS, toS]; returns the number of windows.
+  size_t downsample(uint32_t fromS, uint32_t toS, uint32_t windowS, WindowAggregate* out, size_t maxOut);
+
+  uint8_t channels() const { return channelCount; }
+  StoreStats stats() const { return counters; }
+
+ private:
+  bool writeBlock(const uint8_t* block);
+  bool writeSealedLocked();
+  size_t scanFile(const String& path, uint32_t fromS, uint32_t toS, SampleFn fn, void* context);
+  static size_t scanBlock(const uint8_t* block, uint32_t fromS, uint32_t toS, SampleFn fn, void* context);
+
+  String currentPath;
+  String oldPath;
+  uint8_t channelCount;
+  uint16_t maxBlocks;
+  uint16_t fileBlocks = 0;
+  bool started = false;
+
+  SemaphoreHandle_t lock = nullptr;
+  StaticSemaphore_t lockControl;
+  BlockEncoder encoder;
+  uint8_t sealed[kBlockBytes] = {0};
+  bool sealedPending = false;
+  StoreStats counters;
+};
+
+// DHT readings: temperature10, humidity10
+extern TimeSeriesStore sensorSeries;
+// master weather: temperature10, windspeed10, winddirection
+extern TimeSeriesStore weatherSeries;
+
+}  // namespace app::history
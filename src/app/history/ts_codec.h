@@ -0,0 +1,253 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace app::history {
+
+// Block-structured time-series encoding. Every block is kBlockBytes, self-contained and written
+// to flash as a whole: a fixed header, then the first sample's values as zigzag varints, then
+// one entry per further sample with the delta-of-delta timestamp and per-channel value deltas,
+// all zigzag varints. Regular 15 s samples of slowly moving values cost ~1 byte per field.
+// Pure logic, shared by the on-device store and host tools.
+
+static constexpr size_t kBlockBytes = 512;
+static constexpr size_t kMaxChannels = 4;
+static constexpr uint16_t kBlockMagic = 0x5453;  // "TS"
+static constexpr uint8_t kBlockVersion = 1;
+
+struct __attribute__((packed)) BlockHeader {
+  uint16_t magic;
+  uint8_t version;
+  uint8_t channels;
+  uint16_t count;
+  uint16_t used;  // payload bytes after the header
+  uint32_t firstTimeS;
+  uint32_t lastTimeS;
+};
+
+static constexpr size_t kBlockPayloadBytes = kBlockBytes - sizeof(BlockHeader);
+
+inline uint32_t zigzagEncode(int32_t value) {
+  return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+inline int32_t zigzagDecode(uint32_t value) {
+  return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+inline size_t putVarint(uint8_t* out, uint32_t value) {
+  size_t length = 0;
+  while (value >= 0x80) {
+    out[length++] = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  out[length++] = static_cast<uint8_t>(value);
+  return length;
+}
+
+inline bool getVarint(const uint8_t* data, size_t size, size_t& pos, uint32_t& value) {
+  value = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    if (pos >= size) {
+      return false;
+    }
+    const uint8_t byte = data[pos++];
+    value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+class BlockEncoder {
+ public:
+  void reset(uint8_t channelCount) {
+    memset(block, 0, sizeof(block));
+    channels = channelCount > kMaxChannels ? kMaxChannels : channelCount;
+    header().magic = kBlockMagic;
+    header().version = kBlockVersion;
+    header().channels = channels;
+    prevDelta = 0;
+  }
+
+  // Returns false when the sample does not fit; seal the block and start a new one.
+  bool append(uint32_t timeS, const int32_t* values) {
+    uint8_t scratch[5 * (1 + kMaxChannels)];
+    size_t length = 0;
+    BlockHeader& head = header();
+
+    if (head.count == 0) {
+      for (uint8_t channel = 0; channel < channels; ++channel) {
+        length += putVarint(scratch + length, zigzagEncode(values[channel]));
+      }
+    } else {
+      if (timeS < head.lastTimeS) {
+        return false;
+      }
+      const int32_t delta = static_cast<int32_t>(timeS - head.lastTimeS);
+      length += putVarint(scratch + length, zigzagEncode(delta - prevDelta));
+      for (uint8_t channel = 0; channel < channels; ++channel) {
+        length += putVarint(scratch + length, zigzagEncode(values[channel] - prev[channel]));
+      }
+      if (head.used + length > kBlockPayloadBytes) {
+        return false;
+      }
+      prevDelta = delta;
+    }
+
+    memcpy(block + sizeof(BlockHeader) + head.used, scratch, length);
+    head.used = static_cast<uint16_t>(head.used + length);
+    if (head.count == 0) {
+      head.firstTimeS = timeS;
+    }
+    head.lastTimeS = timeS;
+    head.count++;
+    memcpy(prev, values, channels * sizeof(int32_t));
+    return true;
+  }
+
+  bool empty() const { return constHeader().count == 0; }
+  uint16_t count() const { return constHeader().count; }
+  uint8_t channelCount() const { return channels; }
+  const uint8_t* data() const { return block; }
+
+ private:
+  BlockHeader& header() { return *reinterpret_cast<BlockHeader*>(block); }
+  const BlockHeader& constHeader() const { return *reinterpret_cast<const BlockHeader*>(block); }
+
+  uint8_t block[kBlockBytes] = {0};
+  uint8_t channels = 0;
+  int32_t prev[kMaxChannels] = {0};
+  int32_t prevDelta = 0;
+};
+
+class BlockDecoder {
+ public:
+  bool open(const uint8_t* data, size_t size) {
+    if (data == nullptr || size < sizeof(BlockHeader)) {
+      return false;
+    }
+    memcpy(&head, data, sizeof(head));
+    if (head.magic != kBlockMagic || head.version != kBlockVersion || head.channels == 0 ||
+        head.channels > kMaxChannels || head.used > kBlockPayloadBytes ||
+        sizeof(BlockHeader) + head.used > size) {
+      return false;
+    }
+    payload = data + sizeof(BlockHeader);
+    pos = 0;
+    index = 0;
+    prevTime = head.firstTimeS;
+    prevDelta = 0;
+    return true;
+  }
+
+  const BlockHeader& header() const { return head; }
+
+  bool next(uint32_t& timeS, int32_t* values) {
+    if (index >= head.count) {
+      return false;
+    }
+
+    uint32_t raw = 0;
+    if (index == 0) {
+      for (uint8_t channel = 0; channel < head.channels; ++channel) {
+        if (!getVarint(payload, head.used, pos, raw)) {
+          return false;
+        }
+        prev[channel] = zigzagDecode(raw);
+      }
+    } else {
+      if (!getVarint(payload, head.used, pos, raw)) {
+        return false;
+      }
+      prevDelta += zigzagDecode(raw);
+      prevTime += static_cast<uint32_t>(prevDelta);
+      for (uint8_t channel = 0; channel < head.channels; ++channel) {
+        if (!getVarint(payload, head.used, pos, raw)) {
+          return false;
+        }
+        prev[channel] += zigzagDecode(raw);
+      }
+    }
+
+    timeS = prevTime;
+    memcpy(values, prev, head.channels * sizeof(int32_t));
+    index++;
+    return true;
+  }
+
+ private:
+  BlockHeader head = {};
+  const uint8_t* payload = nullptr;
+  size_t pos = 0;
+  uint16_t index = 0;
+  uint32_t prevTime = 0;
+  int32_t prevDelta = 0;
+  int32_t prev[kMaxChannels] = {0};
+};
+
+struct WindowAggregate {
+  uint32_t startS = 0;
+  uint16_t count = 0;
+  int32_t min[kMaxChannels] = {0};
+  int32_t max[kMaxChannels] = {0};
+  int32_t avg[kMaxChannels] = {0};
+};
+
+// Folds time-ordered samples into fixed windows aligned to multiples of windowS.
+class Downsampler {
+ public:
+  Downsampler(uint32_t windowSeconds, uint8_t channelCount, WindowAggregate* output, size_t capacity)
+      : windowS(windowSeconds == 0 ? 1 : windowSeconds),
+        channels(channelCount > kMaxChannels ? kMaxChannels : channelCount),
+        out(output),
+        maxOut(capacity) {}
+
+  void add(uint32_t timeS, const int32_t* values) {
+    const uint32_t start = timeS - (timeS % windowS);
+    if (!open || start != current.startS) {
+      finish();
+      if (written >= maxOut) {
+        return;
+      }
+      current = WindowAggregate{};
+      current.startS = start;
+      memset(sums, 0, sizeof(sums));
+      open = true;
+    }
+
+    for (uint8_t channel = 0; channel < channels; ++channel) {
+      if (current.count == 0 || values[channel] < current.min[channel]) current.min[channel] = values[channel];
+      if (current.count == 0 || values[channel] > current.max[channel]) current.max[channel] = values[channel];
+      sums[channel] += values[channel];
+    }
+    current.count++;
+  }
+
+  // Closes the last window; returns the number of windows written.
+  size_t finish() {
+    if (open && current.count > 0 && written < maxOut) {
+      for (uint8_t channel = 0; channel < channels; ++channel) {
+        current.avg[channel] = static_cast<int32_t>(sums[channel] / current.count);
+      }
+      out[written++] = current;
+    }
+    open = false;
+    return written;
+  }
+
+ private:
+  uint32_t windowS;
+  uint8_t channels;
+  WindowAggregate* out;
+  size_t maxOut;
+  size_t written = 0;
+  bool open = false;
+  WindowAggregate current;
+  int64_t sums[kMaxChannels] = {0};
+};
+
+}  // namespace app::history
@@ -0,0 +1,69 @@
+#ifndef BATTERY_FILTER_H
+#define BATTERY_FILTER_H
+
+#include <stdint.h>
+
+// Divider ratio in thousandths, rounded (1.47 -> 1470).
+inline uint16_t batteryDividerX1000(float ratio) {
+    return static_cast<uint16_t>(ratio * 1000.0f + 0.5f);
+}
+
+// Scales a calibrated ADC pin voltage back up through the resistor divider.
+// dividerX1000 is the divider ratio in thousandths (2.0 -> 2000), offsetMv a per-board trim.
+inline uint16_t batteryMvFromPinMv(uint32_t pinMv, uint16_t dividerX1000, int16_t offsetMv = 0) {
+    int32_t mv = static_cast<int32_t>((pinMv * dividerX1000 + 500) / 1000) + offsetMv;
+    if (mv < 0) mv = 0;
+    if (mv > 0xFFFF) mv = 0xFFFF;
+    return static_cast<uint16_t>(mv);
+}
+
+// Median-of-3 spike rejection followed by an integer EMA. Pure logic, no ADC access.
+class BatteryFilter {
+public:
+    // alphaShift: EMA weight of a new sample is 1 / 2^alphaShift
+    explicit BatteryFilter(uint8_t alphaShift = 2) : shift(alphaShift) {}
+
+    uint16_t update(uint16_t sampleMv) {
+        history[0] = history[1];
+        history[1] = history[2];
+        history[2] = sampleMv;
+        if (count < 3) count++;
+
+        // until the window is full there is nothing to vote against
+        const uint16_t median = count < 3 ? sampleMv : medianOf3(history[0], history[1], history[2]);
+
+        if (!primed) {
+            emaScaled = static_cast<uint32_t>(median) << shift;
+            primed = true;
+        } else {
+            // the decay term is rounded like value(), otherwise the EMA settles up to 1 mV above
+            // a falling input
+            emaScaled = emaScaled - ((emaScaled + (1u << shift >> 1)) >> shift) + median;
+        }
+        return value();
+    }
+
+    uint16_t value() const { return static_cast<uint16_t>((emaScaled + (1u << shift >> 1)) >> shift); }
+    bool hasValue() const { return primed; }
+
+    void reset() {
+        count = 0;
+        primed = false;
+        emaScaled = 0;
+    }
+
+private:
+    static uint16_t medianOf3(uint16_t a, uint16_t b, uint16_t c) {
+        if (a > b) { const uint16_t t = a; a = b; b = t; }
+        if (b > c) { b = c; }
+        return a > b ? a : b;
+    }
+
+    uint8_t shift;
+    uint16_t history[3] = {0, 0, 0};
+    uint8_t count = 0;
+    bool primed = false;
+    uint32_t emaScaled = 0;
+};
+
+#endif // BATTERY_FILTER_H
@@ -1,27 +1,43 @@
 #include "battery_manager.h"
 
 #include <app_config.h>
+#include <soc/soc_caps.h>
 
 #define BATTERY_CRITICAL   10    // Critical battery level
 #define BATTERY_LOW        25    // Low battery level
 #define BATTERY_MEDIUM     50    // Medium battery level
 #define BATTERY_HIGH       75    // High battery level
-#define BATTERY_SAMPLES    10    // Number of samples to average for stable reading
+#define BATTERY_SAMPLES    4     // One-shot samples averaged when continuous mode is unavailable
+#define BATTERY_CONVERSIONS 64   // Conversions averaged by the driver per continuous frame
+#define BATTERY_FRAME_TIMEOUT_MS 200
 
 #define BATTERY_NOTIFY_CRITICAL true  // Notify when battery is critical
 #define BATTERY_NOTIFY_LOW      true  // Notify when battery is low
 
-BatteryManager::BatteryManager() {
-    voltageMax = 4.2;
-    voltageMin = 3.3;
+static SocEstimator::Config socConfig() {
+    SocEstimator::Config config;
+    config.capacityMah = INPUT_BATTERY_CAPACITY_MAH;
+    return config;
+}
+
+BatteryManager::BatteryManager() : socEstimator(socConfig()) {
     voltageDivider = 2;
     adcResolution = 4095.0; // 12-bit ADC
+    offsetMv = INPUT_BATTERY_OFFSET_MV;
     batteryPin = INPUT_BATTERY_ADC_PIN;
     chargePin = INPUT_BATTERY_CHARGE_PIN;
     updateInterval = 5000; // 5 seconds
 
     lastUpdate = 0;
     currentVoltage = 0;
+    currentVoltageMv = 0;
+    continuousActive = false;
+    temperature10 = 250;
+    temperatureValid = false;
+    loadMa = INPUT_BATTERY_BASE_MA + INPUT_BATTERY_ACTIVITY_MA;
+    runtimeMinutes = SocEstimator::kRuntimeUnknown;
+    sampling = false;
+    samplingStarted = 0;
     currentLevel = 0;
     currentState = BATTERY_STATE_CRITICAL;
     chargingState = CHARGING_UNKNOWN;
@@ -37,8 +53,8 @@ BatteryManager::BatteryManager() {
 BatteryManager::~BatteryManager() {
 }
 
-void BatteryManager::init(int pin){
-    setPin(pin);
+void BatteryManager::init(int pin, int charger){
+    setPin(pin, charger);
     setup();
 }
 
@@ -47,87 +63,159 @@ void BatteryManager::setup() {
     analogReadResolution(12); // Set ADC resolution to 12 bits (0-4095)
     adcResolution = 4095.0;   // 12-bit ADC = 2^12 - 1
     
-    // Get initial readings
-    update();
-    printStatus();
-}
+    if (chargePin >= 0) {
+        pinMode(chargePin, INPUT_PULLUP);
+    }
 
-void BatteryManager::setVoltage(float min, float max, float divider){
-    // Update member variables
-    setVoltageMin(min);
-    setVoltageMax(max);
-    setVoltageDivider(divider);
+    // Seed the filter with a one-shot reading so the level is valid right away. On arduino-esp32
+    // 3.x a one-shot read takes the pin over and deinits continuous mode, so it comes first.
+    processSample(readPinMilliVolts());
+    continuousActive = startContinuous();
+    lastUpdate = millis();
+    printStatus();
 }
 
 void BatteryManager::update() {
     unsigned long currentTime = millis();
-    
+
+    // A continuous frame finishes in the background; pick it up without blocking
+    if (sampling) {
+        uint32_t pinMv = 0;
+        if (pollContinuous(pinMv)) {
+            processSample(pinMv);
+        } else if ((currentTime - samplingStarted) >= BATTERY_FRAME_TIMEOUT_MS) {
+            analogContinuousStop();
+            sampling = false;
+            ESP_LOGW("battery", "continuous ADC frame timed out, using one-shot read");
+            processSample(readPinMilliVolts());
+            // the one-shot read released continuous mode; set it up again for the next update
+            continuousActive = startContinuous();
+        }
+        return;
+    }
+
     // Only update at the specified interval
     if ((currentTime - lastUpdate) >= updateInterval) {
-        // Read and calculate battery voltage and level
-        currentVoltage = readVoltage();
-        currentLevel = calculateLevel(currentVoltage);
-        BatteryState newState = determineState(currentLevel);
-        
-        // Check if state has changed
-        if (newState != currentState) {
-            currentState = newState;
-            
-            // Handle notifications for low and critical states
-            if (currentState == BATTERY_STATE_CRITICAL && notifyCritical && !wasCriticalNotified) {
-                // Critical battery notification
-                wasCriticalNotified = true;
-            } 
-            else if (currentState == BATTERY_STATE_LOW && notifyLow && !wasLowNotified) {
-                // Low battery notification
-                wasLowNotified = true;
-            }
-            
-            // Reset notification flags if battery level improved
-            if (currentState > BATTERY_STATE_LOW) {
-                wasLowNotified = false;
-            }
-            if (currentState > BATTERY_STATE_CRITICAL) {
-                wasCriticalNotified = false;
-            }
-        }
-        
-        // Update timestamp
         lastUpdate = currentTime;
+        if (continuousActive && analogContinuousStart()) {
+            sampling = true;
+            samplingStarted = currentTime;
+            return;
+        }
+        processSample(readPinMilliVolts());
+        if (continuousActive) {
+            continuousActive = startContinuous();
+        }
+    }
+}
+
+#if SOC_ADC_DMA_SUPPORTED
+static volatile bool adcFrameReady = false;
+
+static void ARDUINO_ISR_ATTR onAdcFrame() {
+    adcFrameReady = true;
+}
+#endif
+
+bool BatteryManager::startContinuous() {
+#if SOC_ADC_DMA_SUPPORTED
+    // DMA sampling averages BATTERY_CONVERSIONS readings per frame and reports
+    // eFuse-calibrated millivolts; it is only started for the duration of one frame
+    const uint8_t pins[] = {static_cast<uint8_t>(batteryPin)};
+    analogContinuousSetWidth(12);
+    analogContinuousSetAtten(ADC_11db);
+    if (!analogContinuous(pins, 1, BATTERY_CONVERSIONS, SOC_ADC_SAMPLE_FREQ_THRES_LOW, &onAdcFrame)) {
+        ESP_LOGW("battery", "continuous ADC unavailable on GPIO %d, using one-shot reads", batteryPin);
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool BatteryManager::pollContinuous(uint32_t& pinMv) {
+#if SOC_ADC_DMA_SUPPORTED
+    if (!adcFrameReady) {
+        return false;
+    }
+
+    adc_continuous_result_t* result = nullptr;
+    const bool ok = analogContinuousRead(&result, 0);
+    adcFrameReady = false;
+    analogContinuousStop();
+    sampling = false;
+    if (!ok || result == nullptr) {
+        return false;
     }
+
+    pinMv = static_cast<uint32_t>(result[0].avg_read_mvolts);
+    return true;
+#else
+    (void)pinMv;
+    return false;
+#endif
 }
 
-float BatteryManager::readVoltage() {
-    // Take multiple samples to stabilize reading
+uint32_t BatteryManager::readPinMilliVolts() {
     uint32_t sum = 0;
     for (int i = 0; i < BATTERY_SAMPLES; i++) {
-        sum += static_cast<uint32_t>(analogRead(batteryPin));
+        sum += analogReadMilliVolts(batteryPin);
     }
-    
-    // Average the readings
-    float rawValue = static_cast<float>(sum) / static_cast<float>(BATTERY_SAMPLES);
-    
-    // Convert ADC reading to voltage (considering voltage divider)
-    // First calculate the voltage at the ADC pin: ADC value * (3.3V reference / resolution)
-    float adcVoltage = rawValue * (3.3 / adcResolution);
-    
-    // Then calculate the actual battery voltage using the voltage divider formula
-    // For two equal resistors (100k), the voltage is doubled from what the ADC reads
-    float voltage = adcVoltage * voltageDivider;
-    ESP_LOGI("battery", "battery voltage=%.2f", voltage);
-    
-    return voltage;
+    return sum / BATTERY_SAMPLES;
 }
 
-int BatteryManager::calculateLevel(float voltage) {
-    // Calculate battery percentage based on voltage
-    // Linear mapping from min voltage (0%) to max voltage (100%)
-    if (voltage <= voltageMin) return 0;
-    if (voltage >= voltageMax) return 100;
-    
-    // Linear interpolation
-    int level = (int)(((voltage - voltageMin) / (voltageMax - voltageMin)) * 100.0);
-    return constrain(level, 0, 100); // Ensure level is between 0-100
+void BatteryManager::processSample(uint32_t pinMv) {
+    currentVoltageMv = filter.update(batteryMvFromPinMv(pinMv, batteryDividerX1000(voltageDivider), offsetMv));
+    currentVoltage = static_cast<float>(currentVoltageMv) / 1000.0f;
+    readChargingPin();
+
+    SocEstimator::Input input;
+    input.voltageMv = currentVoltageMv;
+    input.temperature10 = temperature10;
+    input.temperatureValid = temperatureValid;
+    input.loadMa = loadMa;
+    input.charging = chargingState == CHARGING_IN_PROGRESS;
+    input.nowMs = millis();
+    const SocEstimator::Estimate estimate = socEstimator.update(input);
+    currentLevel = estimate.percent;
+    runtimeMinutes = estimate.runtimeMinutes;
+    BatteryState newState = determineState(currentLevel);
+
+    // Check if state has changed
+    if (newState != currentState) {
+        currentState = newState;
+
+        // Handle notifications for low and critical states
+        if (currentState == BATTERY_STATE_CRITICAL && notifyCritical && !wasCriticalNotified) {
+            // Critical battery notification
+            wasCriticalNotified = true;
+        }
+        else if (currentState == BATTERY_STATE_LOW && notifyLow && !wasLowNotified) {
+            // Low battery notification
+            wasLowNotified = true;
+        }
+
+        // Reset notification flags if battery level improved
+        if (currentState > BATTERY_STATE_LOW) {
+            wasLowNotified = false;
+        }
+        if (currentState > BATTERY_STATE_CRITICAL) {
+            wasCriticalNotified = false;
+        }
+    }
+
+    ESP_LOGD("battery", "battery pin=%lumV voltage=%umV resting=%umV level=%d runtime=%umin",
+             static_cast<unsigned long>(pinMv), currentVoltageMv, estimate.restingMv, currentLevel, runtimeMinutes);
+}
+
+void BatteryManager::readChargingPin() {
+    // Without a status pin the state stays whatever setChargingState() last set
+    if (chargePin < 0) {
+        return;
+    }
+    chargingState = digitalRead(chargePin) == INPUT_BATTERY_CHARGE_ACTIVE_LEVEL ? CHARGING_IN_PROGRESS
+                                                                                : CHARGING_NOT_CONNECTED;
 }
 
 BatteryState BatteryManager::determineState(int level) {
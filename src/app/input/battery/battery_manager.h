@@ -3,6 +3,9 @@
 
 #include <Arduino.h>
 
+#include "battery_filter.h"
+#include "soc_estimator.h"
+
 // Battery level states
 enum BatteryState {
     BATTERY_STATE_CRITICAL,
@@ -20,19 +23,24 @@ enum ChargingState {
     CHARGING_COMPLETE
 };
 
+// Samples the battery with the continuous (DMA) ADC driver, one frame per update, and falls back to
+// the blocking one-shot read for the boot seed, when continuous mode is unavailable, or when a
+// frame times out. On arduino-esp32 3.x a one-shot read releases continuous mode, so it is set up
+// again afterwards. Samples go through BatteryFilter and SocEstimator; the load comes from the
+// power policy and board trim, capacity and charger pin from hw.h.
 class BatteryManager {
 private:
     int batteryPin;                  // ADC pin for battery measurement
     int chargePin;                   //
-    float voltageMax;                // Maximum voltage
-    float voltageMin;                // Minimum voltage
     float voltageDivider;            // Voltage divider ratio
     float adcResolution;
+    int16_t offsetMv;                // Per-board calibration trim
     
     unsigned long lastUpdate;        // Last update timestamp
     unsigned long updateInterval;    // Update interval in ms
     
     float currentVoltage;            // Current measured voltage
+    uint16_t currentVoltageMv;       // Filtered voltage in mV
     int currentLevel;                // Current battery percentage (0-100)
     BatteryState currentState;       // Current battery state
     ChargingState chargingState;     // Current charging state
@@ -42,18 +50,31 @@ private:
     bool wasLowNotified;             // Whether low notification was shown
     bool wasCriticalNotified;        // Whether critical notification was shown
     
+    BatteryFilter filter;            // Median + EMA over calibrated samples
+    SocEstimator socEstimator;       // LiPo lookup table, temperature/load compensation, runtime
+    int16_t temperature10;           // Cell temperature in 0.1 C (from the DHT)
+    bool temperatureValid;
+    uint16_t loadMa;                 // Average load current, from the power policy
+    uint16_t runtimeMinutes;         // Remaining runtime, SocEstimator::kRuntimeUnknown if unknown
+    bool continuousActive;           // DMA continuous sampling available
+    bool sampling;                   // A continuous conversion frame is in flight
+    unsigned long samplingStarted;
+
     void setup();
 
     // Private methods
-    float readVoltage();             // Read raw voltage from ADC
-    int calculateLevel(float voltage); // Calculate percentage from voltage
+    bool startContinuous();
+    bool pollContinuous(uint32_t& pinMv);
+    uint32_t readPinMilliVolts();    // Blocking one-shot fallback (calibrated)
+    void processSample(uint32_t pinMv);
+    void readChargingPin();
     BatteryState determineState(int level); // Determine state from percentage
     
 public:
     BatteryManager();
     ~BatteryManager();
     
-    void init(int pin);
+    void init(int pin, int charger = -1);
     void update();
 
     // Setters
@@ -61,15 +82,17 @@ public:
         batteryPin = battery;
         chargePin = charger;
     };
-    void setVoltage(float min, float max, float divider);
-    void setVoltageMax(float value) { voltageMax = value; }
-    void setVoltageMin(float value) { voltageMin = value; }
     void setVoltageDivider(float value) { voltageDivider = value; }
     void setAdcResolution(float value) { adcResolution = value; };
+    void setOffsetMv(int16_t value) { offsetMv = value; }
+    void setTemperature(int16_t value10) { temperature10 = value10; temperatureValid = true; }
+    void setLoadMa(uint16_t value) { loadMa = value; }
     
     // Getters
     float getVoltage() const { return currentVoltage; }
+    uint16_t getVoltageMv() const { return currentVoltageMv; }
     int getLevel() const { return currentLevel; }
+    uint16_t getRuntimeMinutes() const { return runtimeMinutes; }
     BatteryState getState() const { return currentState; }
     ChargingState getChargingState() const { return chargingState; }
     
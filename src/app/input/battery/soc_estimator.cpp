@@ -0,0 +1,124 @@
+#include "soc_estimator.h"
+
+namespace {
+
+struct OcvPoint {
+    uint16_t mv;
+    uint16_t socCenti;
+};
+
+// Typical LiPo resting voltage vs. state of charge at 25 C, descending. The curve is flat
+// between ~3.75 V and ~3.95 V, which is why a linear 3.3-4.2 V mapping jumps around.
+constexpr OcvPoint kOcvTable[] = {
+    {4200, 10000}, {4150, 9500}, {4110, 9000}, {4080, 8500}, {4020, 8000}, {3980, 7500},
+    {3950, 7000},  {3910, 6500}, {3870, 6000}, {3850, 5500}, {3840, 5000}, {3820, 4500},
+    {3800, 4000},  {3790, 3500}, {3770, 3000}, {3750, 2500}, {3730, 2000}, {3710, 1500},
+    {3690, 1000},  {3610, 500},  {3270, 0},
+};
+
+constexpr size_t kOcvPoints = sizeof(kOcvTable) / sizeof(kOcvTable[0]);
+
+constexpr uint32_t kMsPerHour = 3600UL * 1000UL;
+
+}  // namespace
+
+SocEstimator::SocEstimator(const Config& initial) : config(initial) {}
+
+void SocEstimator::reset() {
+    estimate = Estimate{};
+    haveReference = false;
+    rateCentiPerHour = 0;
+}
+
+uint16_t SocEstimator::socFromRestingMv(uint16_t mv) {
+    if (mv >= kOcvTable[0].mv) return kOcvTable[0].socCenti;
+    if (mv <= kOcvTable[kOcvPoints - 1].mv) return 0;
+
+    for (size_t i = 1; i < kOcvPoints; i++) {
+        const OcvPoint& upper = kOcvTable[i - 1];
+        const OcvPoint& lower = kOcvTable[i];
+        if (mv >= lower.mv) {
+            const uint32_t span = upper.mv - lower.mv;
+            const uint32_t offset = mv - lower.mv;
+            return static_cast<uint16_t>(lower.socCenti + (upper.socCenti - lower.socCenti) * offset / span);
+        }
+    }
+    return 0;
+}
+
+uint16_t SocEstimator::restingVoltage(const Input& input) const {
+    int32_t mv = input.voltageMv;
+
+    // IR drop under load: the terminal voltage sits below the resting voltage
+    if (!input.charging) {
+        mv += static_cast<int32_t>(input.loadMa) * config.internalResistanceMilliOhm / 1000;
+    }
+
+    // a cold cell reads low for the same charge
+    if (input.temperatureValid) {
+        mv += (250 - input.temperature10) * static_cast<int32_t>(config.tempCoeffMicroVoltPerC) / 10000;
+    }
+
+    if (mv < 0) mv = 0;
+    if (mv > 0xFFFF) mv = 0xFFFF;
+    return static_cast<uint16_t>(mv);
+}
+
+void SocEstimator::updateRate(uint32_t nowMs, uint16_t socCenti) {
+    if (!haveReference) {
+        haveReference = true;
+        referenceMs = nowMs;
+        referenceSoc = socCenti;
+        return;
+    }
+
+    const uint32_t elapsed = nowMs - referenceMs;
+    if (elapsed < config.rateWindowMs) {
+        return;
+    }
+
+    if (socCenti < referenceSoc) {
+        const uint32_t sample = static_cast<uint32_t>(
+            static_cast<uint64_t>(referenceSoc - socCenti) * kMsPerHour / elapsed);
+        // EMA over windows, weight 1/4 for the new window
+        rateCentiPerHour = rateCentiPerHour == 0 ? sample : (rateCentiPerHour * 3 + sample) / 4;
+    }
+
+    referenceMs = nowMs;
+    referenceSoc = socCenti;
+}
+
+uint16_t SocEstimator::runtimeMinutes(const Input& input, uint16_t socCenti) const {
+    if (input.charging) {
+        return kRuntimeUnknown;
+    }
+
+    uint32_t minutes = 0;
+    if (rateCentiPerHour > 0) {
+        minutes = static_cast<uint32_t>(static_cast<uint64_t>(socCenti) * 60 / rateCentiPerHour);
+    } else if (input.loadMa > 0) {
+        // no measured rate yet: fall back to nameplate capacity over the estimated load
+        minutes = static_cast<uint32_t>(static_cast<uint64_t>(config.capacityMah) * socCenti * 60 /
+                                        (10000ULL * input.loadMa));
+    } else {
+        return kRuntimeUnknown;
+    }
+
+    return minutes >= kRuntimeUnknown ? kRuntimeUnknown - 1 : static_cast<uint16_t>(minutes);
+}
+
+SocEstimator::Estimate SocEstimator::update(const Input& input) {
+    estimate.restingMv = restingVoltage(input);
+    estimate.socCenti = socFromRestingMv(estimate.restingMv);
+    estimate.percent = static_cast<uint8_t>((estimate.socCenti + 50) / 100);
+
+    if (input.charging) {
+        // charging voltage says nothing about the discharge rate
+        haveReference = false;
+    } else {
+        updateRate(input.nowMs, estimate.socCenti);
+    }
+
+    estimate.runtimeMinutes = runtimeMinutes(input, estimate.socCenti);
+    return estimate;
+}
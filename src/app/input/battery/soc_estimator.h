@@ -0,0 +1,62 @@
+#ifndef SOC_ESTIMATOR_H
+#define SOC_ESTIMATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Single-cell LiPo state-of-charge from a resting-voltage lookup table, with temperature and
+// load compensation and a remaining-runtime estimate from the measured discharge rate.
+// Pure logic: the caller supplies voltage, temperature, load and the clock.
+class SocEstimator {
+public:
+    static constexpr uint16_t kRuntimeUnknown = 0xFFFF;
+
+    struct Config {
+        uint16_t capacityMah = 1000;
+        uint16_t internalResistanceMilliOhm = 150;   // cell + protection + wiring
+        uint16_t tempCoeffMicroVoltPerC = 1500;       // resting voltage drop per degree below 25 C
+        uint32_t rateWindowMs = 10UL * 60UL * 1000UL; // minimum span for one discharge-rate sample
+    };
+
+    struct Input {
+        uint16_t voltageMv = 0;
+        int16_t temperature10 = 250;
+        bool temperatureValid = false;
+        uint16_t loadMa = 0;
+        bool charging = false;
+        uint32_t nowMs = 0;
+    };
+
+    struct Estimate {
+        uint16_t socCenti = 0;                  // 0..10000 (0.01 %)
+        uint8_t percent = 0;
+        uint16_t restingMv = 0;                 // compensated open-circuit voltage
+        uint16_t runtimeMinutes = kRuntimeUnknown;
+    };
+
+    explicit SocEstimator(const Config& config);
+
+    Estimate update(const Input& input);
+    void reset();
+
+    const Estimate& last() const { return estimate; }
+    // measured discharge rate in 0.01 %/hour, 0 until one window has elapsed
+    uint32_t dischargeRateCentiPerHour() const { return rateCentiPerHour; }
+
+    // Lookup-table SoC (0.01 %) for a resting cell voltage at 25 C.
+    static uint16_t socFromRestingMv(uint16_t mv);
+
+private:
+    uint16_t restingVoltage(const Input& input) const;
+    void updateRate(uint32_t nowMs, uint16_t socCenti);
+    uint16_t runtimeMinutes(const Input& input, uint16_t socCenti) const;
+
+    Config config;
+    Estimate estimate;
+    bool haveReference = false;
+    uint32_t referenceMs = 0;
+    uint16_t referenceSoc = 0;
+    uint32_t rateCentiPerHour = 0;
+};
+
+#endif // SOC_ESTIMATOR_H
@@ -0,0 +1,89 @@
+#include "report_policy.h"
+
+#include <app_config.h>
+#include <esp_log.h>
+
+namespace app::power {
+
+namespace {
+
+static constexpr const char* TAG = "power_policy";
+
+// Interval multiplier per level (rows) and activity (columns); 0 suspends the activity.
+static constexpr uint8_t kMultipliers[4][static_cast<size_t>(Activity::Count)] = {
+    // Sensor, Battery, WeatherProxy, Telemetry, Hello
+    {1, 1, 1, 1, 1},  // Normal
+    {2, 2, 2, 2, 1},  // Saver
+    {4, 4, 4, 4, 2},  // Low
+    {0, 0, 0, 0, 2},  // Critical
+};
+
+PowerLevel levelFor(BatteryState battery, ChargingState charging) {
+  if (charging == CHARGING_IN_PROGRESS || charging == CHARGING_COMPLETE) {
+    return PowerLevel::Normal;
+  }
+
+  switch (battery) {
+    case BATTERY_STATE_CRITICAL:
+      return PowerLevel::Critical;
+    case BATTERY_STATE_LOW:
+      return PowerLevel::Low;
+    case BATTERY_STATE_MEDIUM:
+      return PowerLevel::Saver;
+    default:
+      return PowerLevel::Normal;
+  }
+}
+
+}  // namespace
+
+ReportPolicy reportPolicy;
+
+void ReportPolicy::update(BatteryState battery, ChargingState charging, uint8_t batteryPercent) {
+  percent.store(batteryPercent, std::memory_order_relaxed);
+#if POWER_POLICY_ENABLED
+  const PowerLevel next = levelFor(battery, charging);
+  const uint8_t previous = currentLevel.exchange(static_cast<uint8_t>(next), std::memory_order_relaxed);
+  if (previous != static_cast<uint8_t>(next)) {
+    changes.fetch_add(1, std::memory_order_relaxed);
+    ESP_LOGI(TAG, "Power level %s -> %s", levelName(static_cast<PowerLevel>(previous)), levelName(next));
+  }
+#else
+  (void)battery;
+  (void)charging;
+#endif
+}
+
+uint8_t ReportPolicy::multiplier(Activity activity) const {
+  const size_t row = static_cast<size_t>(level());
+  const size_t column = static_cast<size_t>(activity);
+  if (row >= 4 || column >= static_cast<size_t>(Activity::Count)) {
+    return 1;
+  }
+  return kMultipliers[row][column];
+}
+
+uint32_t ReportPolicy::interval(Activity activity, uint32_t baseMs) const {
+  return baseMs * multiplier(activity);
+}
+
+uint16_t ReportPolicy::loadMa() const {
+  const uint8_t stretch = multiplier(Activity::Sensor);
+  return static_cast<uint16_t>(INPUT_BATTERY_BASE_MA + (stretch == 0 ? 0 : INPUT_BATTERY_ACTIVITY_MA / stretch));
+}
+
+const char* ReportPolicy::levelName(PowerLevel level) {
+  switch (level) {
+    case PowerLevel::Normal:
+      return "normal";
+    case PowerLevel::Saver:
+      return "saver";
+    case PowerLevel::Low:
+      return "low";
+    case PowerLevel::Critical:
+      return "critical";
+  }
+  return "unknown";
+}
+
+}  // namespace app::power
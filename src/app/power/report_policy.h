@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+#include "app/input/battery/battery_manager.h"
+
+namespace app::power {
+
+enum class PowerLevel : uint8_t {
+  Normal = 0,    // charging, FULL or HIGH
+  Saver = 1,     // MEDIUM
+  Low = 2,       // LOW
+  Critical = 3,  // CRITICAL: only alive beacons
+};
+
+enum class Activity : uint8_t {
+  Sensor = 0,
+  Battery,
+  WeatherProxy,
+  Telemetry,
+  Hello,
+  Count,
+};
+
+// Scales every periodic activity by battery state. Updated from the input task, read from
+// any task; interval() returns 0 when the activity is suspended at the current level.
+class ReportPolicy {
+ public:
+  void update(BatteryState battery, ChargingState charging, uint8_t percent);
+
+  PowerLevel level() const { return static_cast<PowerLevel>(currentLevel.load(std::memory_order_relaxed)); }
+  // bumped on every level change so consumers can re-apply intervals
+  uint32_t generation() const { return changes.load(std::memory_order_relaxed); }
+  uint8_t batteryPercent() const { return percent.load(std::memory_order_relaxed); }
+
+  uint8_t multiplier(Activity activity) const;
+  bool allowed(Activity activity) const { return multiplier(activity) != 0; }
+  uint32_t interval(Activity activity, uint32_t baseMs) const;
+  // Average battery load at the current level: the radio listens all the time, the periodic work
+  // shrinks as its intervals stretch.
+  uint16_t loadMa() const;
+
+  static const char* levelName(PowerLevel level);
+
+ private:
+  std::atomic<uint8_t> currentLevel{static_cast<uint8_t>(PowerLevel::Normal)};
+  std::atomic<uint32_t> changes{0};
+  std::atomic<uint8_t> percent{0};
+};
+
+extern ReportPolicy reportPolicy;
+
+}  // namespace app::power
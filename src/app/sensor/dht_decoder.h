@@ -0,0 +1,88 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace app::sensor {
+
+struct DhtReading {
+  float temperatureC = 0.0f;
+  float humidityPercent = 0.0f;
+  bool valid = false;
+};
+
+// 0 bits are ~26-28 us high, 1 bits ~70 us high.
+static constexpr uint32_t kDhtBitOneThresholdUs = 48;
+static constexpr size_t kDhtFrameBits = 40;
+
+enum class DhtDecodeStatus : uint8_t {
+  Ok,
+  TooFewEdges,
+  BadChecksum,
+};
+
+// Decodes a 40-bit DHT frame from captured edges: `edgeUs` holds edge timestamps in microseconds
+// and `levels` the line level right after each edge. Only the last 40 complete high pulses are
+// used, so missing the start/response edges does not matter. Pure function, no hardware access.
+inline DhtDecodeStatus decodeDhtEdges(const uint32_t* edgeUs,
+                                      const uint8_t* levels,
+                                      size_t edgeCount,
+                                      uint8_t (&raw)[5]) {
+  memset(raw, 0, sizeof(raw));
+
+  uint32_t widths[kDhtFrameBits] = {0};
+  size_t found = 0;
+  for (size_t index = edgeCount; index > 1 && found < kDhtFrameBits; --index) {
+    const size_t falling = index - 1;
+    if (levels[falling] == 0 && levels[falling - 1] == 1) {
+      widths[kDhtFrameBits - 1 - found] = edgeUs[falling] - edgeUs[falling - 1];
+      found++;
+      --index;
+    }
+  }
+
+  if (found < kDhtFrameBits) {
+    return DhtDecodeStatus::TooFewEdges;
+  }
+
+  for (size_t bit = 0; bit < kDhtFrameBits; ++bit) {
+    raw[bit / 8] = static_cast<uint8_t>(raw[bit / 8] << 1);
+    if (widths[bit] > kDhtBitOneThresholdUs) {
+      raw[bit / 8] |= 1;
+    }
+  }
+
+  const uint8_t checksum = static_cast<uint8_t>(raw[0] + raw[1] + raw[2] + raw[3]);
+  return checksum == raw[4] ? DhtDecodeStatus::Ok : DhtDecodeStatus::BadChecksum;
+}
+
+// Measuring ranges from the datasheets. The checksum is a plain byte sum, so a frame read shifted
+// by one pulse can pass it; such frames land far outside these ranges.
+static constexpr float kDht22MinC = -40.0f;
+static constexpr float kDht22MaxC = 80.0f;
+static constexpr float kDht11MinC = 0.0f;
+static constexpr float kDht11MaxC = 50.0f;
+
+// `valid` is false when the values are outside the sensor's measuring range.
+inline DhtReading convertDhtBytes(const uint8_t (&raw)[5], bool dht22) {
+  DhtReading out;
+  if (dht22) {
+    const uint16_t rawHum = (static_cast<uint16_t>(raw[0]) << 8) | raw[1];
+    const uint16_t rawTemp = (static_cast<uint16_t>(raw[2]) << 8) | raw[3];
+
+    out.humidityPercent = static_cast<float>(rawHum) * 0.1f;
+    out.temperatureC = static_cast<float>(rawTemp & 0x7FFF) * 0.1f;
+    if (rawTemp & 0x8000) {
+      out.temperatureC = -out.temperatureC;
+    }
+  } else {
+    out.humidityPercent = static_cast<float>(raw[0]);
+    out.temperatureC = static_cast<float>(raw[2]);
+  }
+
+  const float minC = dht22 ? kDht22MinC : kDht11MinC;
+  const float maxC = dht22 ? kDht22MaxC : kDht11MaxC;
+  out.valid = out.humidityPercent <= 100.0f && out.temperatureC >= minC && out.temperatureC <= maxC;
+  return out;
+}
+
+}  // namespace app::sensor
@@ -0,0 +1,164 @@
+#include "dht_filter.h"
+
+#include <algorithm>
+
+namespace app::sensor {
+
+namespace {
+
+static constexpr uint8_t kFailurePenalty = 15;
+static constexpr uint8_t kRejectPenalty = 20;
+static constexpr uint8_t kEmptySlotPenalty = 10;
+
+template <typename T>
+T medianOf(const T* values, uint8_t count) {
+  T sorted[DhtFilter::kMaxWindow];
+  std::copy(values, values + count, sorted);
+  std::sort(sorted, sorted + count);
+  if ((count % 2) != 0) {
+    return sorted[count / 2];
+  }
+  return static_cast<T>((static_cast<int32_t>(sorted[count / 2 - 1]) + sorted[count / 2]) / 2);
+}
+
+uint16_t distance(int32_t a, int32_t b) {
+  return static_cast<uint16_t>(a > b ? a - b : b - a);
+}
+
+}  // namespace
+
+DhtFilter::Config DhtFilter::defaultConfig(bool dht22, uint32_t intervalMs) {
+  Config config;
+  config.intervalMs = intervalMs;
+  if (!dht22) {
+    // DHT11: 0..50 C, 20..90 %RH, integer resolution, 1 s minimum sampling period
+    config.retrySpacingMs = 1000;
+    config.minTemperature10 = 0;
+    config.maxTemperature10 = 500;
+    config.maxHumidity10 = 950;
+  }
+  return config;
+}
+
+DhtFilter::DhtFilter(const Config& initial) : config(initial) {
+  config.windowSize = std::clamp<uint8_t>(config.windowSize, 1, kMaxWindow);
+}
+
+void DhtFilter::begin(uint32_t nowMs) {
+  nextReadMs = nowMs + config.intervalMs;
+}
+
+void DhtFilter::reset() {
+  count = 0;
+  head = 0;
+  failedAttempts = 0;
+  consecutiveRejects = 0;
+  recentRejects = 0;
+}
+
+bool DhtFilter::inRange(int16_t temperature10, uint16_t humidity10) const {
+  return temperature10 >= config.minTemperature10 && temperature10 <= config.maxTemperature10 &&
+         humidity10 <= config.maxHumidity10;
+}
+
+void DhtFilter::push(int16_t temperature10, uint16_t humidity10) {
+  temperatures[head] = temperature10;
+  humidities[head] = humidity10;
+  sampleFailures[head] = failedAttempts;
+  head = static_cast<uint8_t>((head + 1) % config.windowSize);
+  if (count < config.windowSize) {
+    count++;
+  }
+}
+
+int16_t DhtFilter::medianTemperature() const {
+  return medianOf(temperatures, count);
+}
+
+uint16_t DhtFilter::medianHumidity() const {
+  return medianOf(humidities, count);
+}
+
+uint8_t DhtFilter::score() const {
+  int32_t quality = 100;
+  for (uint8_t index = 0; index < count; ++index) {
+    quality -= static_cast<int32_t>(sampleFailures[index]) * kFailurePenalty / count;
+  }
+  quality -= static_cast<int32_t>(recentRejects) * kRejectPenalty;
+  // a short window cannot outvote a glitch yet
+  if (config.windowSize > 1) {
+    quality -= static_cast<int32_t>(config.windowSize - count) * kEmptySlotPenalty;
+  }
+  return static_cast<uint8_t>(std::clamp<int32_t>(quality, 0, 100));
+}
+
+DhtFilter::Result DhtFilter::onRead(uint32_t nowMs,
+                                    bool ok,
+                                    int16_t temperature10,
+                                    uint16_t humidity10,
+                                    Output& out) {
+  counters.reads++;
+
+  if (ok && !inRange(temperature10, humidity10)) {
+    counters.rangeRejected++;
+    ok = false;
+  }
+
+  if (!ok) {
+    counters.failures++;
+    if (failedAttempts < config.retryCount) {
+      failedAttempts++;
+      counters.retries++;
+      nextReadMs = nowMs + config.retrySpacingMs;
+      return Result::None;
+    }
+
+    // burst exhausted: give up on this cycle, the window keeps its last good values
+    failedAttempts = 0;
+    nextReadMs = nowMs + config.intervalMs;
+    return Result::None;
+  }
+
+  nextReadMs = nowMs + config.intervalMs;
+
+  if (count > 0) {
+    const bool tooFar = distance(temperature10, medianTemperature()) > config.maxTemperatureStep10 ||
+                        distance(humidity10, medianHumidity()) > config.maxHumidityStep10;
+    if (tooFar) {
+      counters.stepRejected++;
+      consecutiveRejects++;
+      if (recentRejects < config.windowSize) {
+        recentRejects++;
+      }
+      failedAttempts = 0;
+      if (consecutiveRejects < config.windowSize) {
+        return Result::None;
+      }
+
+      // the same "outlier" keeps coming back: the environment really moved, re-seed the window
+      reset();
+    }
+  }
+
+  push(temperature10, humidity10);
+  failedAttempts = 0;
+  consecutiveRejects = 0;
+  if (recentRejects > 0 && count == config.windowSize) {
+    recentRejects--;
+  }
+
+  out.temperature10 = medianTemperature();
+  out.humidity10 = medianHumidity();
+  out.samples = count;
+  out.quality = score();
+
+  if (out.quality < config.minQuality) {
+    counters.gated++;
+    return Result::LowQuality;
+  }
+
+  counters.published++;
+  return Result::Publish;
+}
+
+}  // namespace app::sensor
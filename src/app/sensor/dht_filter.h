@@ -0,0 +1,88 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace app::sensor {
+
+// Sits between DhtSensor and the publisher: schedules reads (with a short retry burst after a
+// failed frame), keeps a median-of-N window, drops implausible steps and scores each output.
+// Pure logic on tenths-of-unit integers; the caller passes the clock and the raw read result.
+class DhtFilter {
+ public:
+  static constexpr size_t kMaxWindow = 7;
+
+  struct Config {
+    uint32_t intervalMs = 15000;
+    uint32_t retrySpacingMs = 2000;  // datasheet minimum between reads (DHT22 2 s, DHT11 1 s)
+    uint8_t retryCount = 2;
+    uint8_t windowSize = 5;
+    int16_t minTemperature10 = -400;
+    int16_t maxTemperature10 = 800;
+    uint16_t maxHumidity10 = 1000;
+    uint16_t maxTemperatureStep10 = 50;
+    uint16_t maxHumidityStep10 = 150;
+    uint8_t minQuality = 50;
+  };
+
+  struct Output {
+    int16_t temperature10 = 0;
+    uint16_t humidity10 = 0;
+    uint8_t quality = 0;  // 0..100
+    uint8_t samples = 0;  // samples in the median window
+  };
+
+  enum class Result : uint8_t {
+    None,       // nothing to publish (retry scheduled, sample rejected, ...)
+    Publish,    // `out` holds a filtered value that passed the quality gate
+    LowQuality, // `out` holds a filtered value below minQuality; not to be published
+  };
+
+  struct Stats {
+    uint32_t reads = 0;
+    uint32_t failures = 0;
+    uint32_t retries = 0;
+    uint32_t rangeRejected = 0;
+    uint32_t stepRejected = 0;
+    uint32_t published = 0;
+    uint32_t gated = 0;
+  };
+
+  static Config defaultConfig(bool dht22, uint32_t intervalMs);
+
+  explicit DhtFilter(const Config& config);
+
+  void begin(uint32_t nowMs);
+  void setIntervalMs(uint32_t intervalMs) { config.intervalMs = intervalMs; }
+  bool due(uint32_t nowMs) const { return static_cast<int32_t>(nowMs - nextReadMs) >= 0; }
+
+  // Feeds the outcome of one DhtSensor::read attempt and schedules the next one.
+  Result onRead(uint32_t nowMs, bool ok, int16_t temperature10, uint16_t humidity10, Output& out);
+
+  void reset();
+  const Stats& stats() const { return counters; }
+
+ private:
+  bool inRange(int16_t temperature10, uint16_t humidity10) const;
+  void push(int16_t temperature10, uint16_t humidity10);
+  int16_t medianTemperature() const;
+  uint16_t medianHumidity() const;
+  uint8_t score() const;
+
+  Config config;
+  uint32_t nextReadMs = 0;
+  uint8_t failedAttempts = 0;
+  uint8_t consecutiveRejects = 0;
+
+  int16_t temperatures[kMaxWindow] = {0};
+  uint16_t humidities[kMaxWindow] = {0};
+  uint8_t count = 0;
+  uint8_t head = 0;
+
+  // failed attempts behind each sample currently in the window, for the quality score
+  uint8_t sampleFailures[kMaxWindow] = {0};
+  uint8_t recentRejects = 0;
+
+  Stats counters;
+};
+
+}  // namespace app::sensor
@@ -1,6 +1,8 @@
 #include "dht_sensor.h"
 
+#include <driver/gpio.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 
 namespace app::sensor {
 
@@ -23,95 +25,90 @@ bool DhtSensor::begin(uint8_t pin, bool isDht22) {
   return true;
 }
 
-bool DhtSensor::waitForLevel(uint8_t expectedLevel, uint32_t timeoutUs) {
-  const uint32_t start = micros();
-  while (digitalRead(dataPin) != expectedLevel) {
-    if ((micros() - start) > timeoutUs) {
-      return false;
-    }
+void IRAM_ATTR DhtSensor::onEdge(void* context) {
+  auto* self = static_cast<DhtSensor*>(context);
+  const size_t index = self->edgeCount;
+  if (index >= kMaxEdges) {
+    return;
   }
-  return true;
+
+  self->edgeUs[index] = static_cast<uint32_t>(esp_timer_get_time());
+  self->edgeLevel[index] = static_cast<uint8_t>(gpio_get_level(static_cast<gpio_num_t>(self->dataPin)));
+  self->edgeCount = index + 1;
 }
 
-bool DhtSensor::read(DhtReading& out) {
-  out.valid = false;
+uint32_t DhtSensor::requestFrame() {
   if (!started) {
-    return false;
+    return 0;
   }
 
-  uint8_t raw[5] = {0, 0, 0, 0, 0};
+  edgeCount = 0;
+  capturing = true;
+  armed = false;
 
+  // start signal: hold the line low for startLowMs()
   pinMode(dataPin, OUTPUT);
   digitalWrite(dataPin, LOW);
-  delay(dht22 ? 2 : 20);
-  noInterrupts();
-  digitalWrite(dataPin, HIGH);
-  delayMicroseconds(30);
-  pinMode(dataPin, INPUT_PULLUP);
+  requestedAtUs = micros();
+  return startLowMs();
+}
 
-  if (!waitForLevel(LOW, 100)) {
-    interrupts();
-    ESP_LOGW(TAG, "Timeout waiting DHT response (LOW)");
-    return false;
+uint32_t DhtSensor::armCapture() {
+  if (!capturing) {
+    return 0;
   }
 
-  if (!waitForLevel(HIGH, 100)) {
-    interrupts();
-    ESP_LOGW(TAG, "Timeout waiting DHT response (HIGH)");
-    return false;
+  if (micros() - requestedAtUs < startLowMs() * 1000UL) {
+    ESP_LOGW(TAG, "Start pulse cut short after %lu us", static_cast<unsigned long>(micros() - requestedAtUs));
+    pinMode(dataPin, INPUT_PULLUP);
+    capturing = false;
+    return 0;
   }
 
-  if (!waitForLevel(LOW, 100)) {
-    interrupts();
-    ESP_LOGW(TAG, "Timeout waiting DHT data start");
+  // arm edge capture before releasing the line so the sensor response is never missed;
+  // the ISR only timestamps edges, interrupts stay enabled for the whole frame
+  attachInterruptArg(dataPin, DhtSensor::onEdge, this, CHANGE);
+  pinMode(dataPin, INPUT_PULLUP);
+  armed = true;
+  return kCaptureWindowMs;
+}
+
+bool DhtSensor::finishFrame(DhtReading& out) {
+  out.valid = false;
+  if (!armed) {
     return false;
   }
 
-  for (int bitIndex = 0; bitIndex < 40; ++bitIndex) {
-    if (!waitForLevel(HIGH, 70)) {
-      interrupts();
-      ESP_LOGW(TAG, "Timeout waiting DHT bit high");
-      return false;
-    }
-
-    const uint32_t pulseStart = micros();
-    if (!waitForLevel(LOW, 2000)) {
-      interrupts();
-      ESP_LOGW(TAG, "Timeout waiting DHT bit low after %d tries", bitIndex);
-      return false;
-    }
-
-    const uint32_t pulseWidth = micros() - pulseStart;
-    const uint8_t byteIndex = static_cast<uint8_t>(bitIndex / 8);
-    raw[byteIndex] <<= 1;
-    if (pulseWidth > 45) {
-      raw[byteIndex] |= 1;
-    }
-  }
+  detachInterrupt(dataPin);
+  capturing = false;
+  armed = false;
 
-  interrupts();
+  uint32_t edges[kMaxEdges];
+  uint8_t levels[kMaxEdges];
+  const size_t count = edgeCount;
+  for (size_t index = 0; index < count; ++index) {
+    edges[index] = edgeUs[index];
+    levels[index] = edgeLevel[index];
+  }
 
-  const uint8_t checksum = static_cast<uint8_t>(raw[0] + raw[1] + raw[2] + raw[3]);
-  if (checksum != raw[4]) {
-    ESP_LOGW(TAG, "Checksum mismatch: got=%u expected=%u", raw[4], checksum);
+  uint8_t raw[5] = {0, 0, 0, 0, 0};
+  const DhtDecodeStatus status = decodeDhtEdges(edges, levels, count, raw);
+  if (status == DhtDecodeStatus::TooFewEdges) {
+    ESP_LOGW(TAG, "Incomplete DHT frame: %u edges", static_cast<unsigned>(count));
     return false;
   }
 
-  if (dht22) {
-    uint16_t rawHum = (static_cast<uint16_t>(raw[0]) << 8) | raw[1];
-    uint16_t rawTemp = (static_cast<uint16_t>(raw[2]) << 8) | raw[3];
-
-    out.humidityPercent = static_cast<float>(rawHum) * 0.1f;
-    out.temperatureC = static_cast<float>(rawTemp & 0x7FFF) * 0.1f;
-    if (rawTemp & 0x8000) {
-      out.temperatureC = -out.temperatureC;
-    }
-  } else {
-    out.humidityPercent = static_cast<float>(raw[0]);
-    out.temperatureC = static_cast<float>(raw[2]);
+  if (status == DhtDecodeStatus::BadChecksum) {
+    ESP_LOGW(TAG, "Checksum mismatch: got=%u expected=%u", raw[4],
+             static_cast<uint8_t>(raw[0] + raw[1] + raw[2] + raw[3]));
+    return false;
   }
 
-  out.valid = true;
+  out = convertDhtBytes(raw, dht22);
+  if (!out.valid) {
+    ESP_LOGW(TAG, "DHT frame out of range: %.1f C %.1f %%RH", out.temperatureC, out.humidityPercent);
+    return false;
+  }
   return true;
 }
 
@@ -2,27 +2,48 @@
 
 #include <Arduino.h>
 
-namespace app::sensor {
+#include "dht_decoder.h"
 
-struct DhtReading {
-  float temperatureC = 0.0f;
-  float humidityPercent = 0.0f;
-  bool valid = false;
-};
+namespace app::sensor {
 
 class DhtSensor {
  public:
   DhtSensor() = default;
 
+  // longest DHT frame (response plus 40 bits of 1) is about 5 ms
+  static constexpr uint32_t kCaptureWindowMs = 8;
+
   bool begin(uint8_t pin, bool isDht22 = true);
-  bool read(DhtReading& out);
+
+  // A read in three steps; each of the first two returns how long to co_await before the next,
+  // so the start pulse (20 ms on a DHT11) and the frame never block the app task:
+  //   requestFrame() pulls the line low and returns startLowMs(),
+  //   armCapture() releases it, timestamps edges from the ISR and returns kCaptureWindowMs,
+  //   finishFrame() decodes the edges.
+  // 0 means the read failed. armCapture() before the start pulse is long enough returns 0 rather
+  // than waiting out the rest, so a missing co_await shows up as a failed read. A late resume
+  // only stretches the start pulse or the idle line after the frame.
+  uint32_t requestFrame();
+  uint32_t startLowMs() const { return dht22 ? 2 : 20; }
+  uint32_t armCapture();
+  bool finishFrame(DhtReading& out);
 
  private:
-  bool waitForLevel(uint8_t expectedLevel, uint32_t timeoutUs);
+  // start + response + 40 bits is 84 edges; a little slack for a trailing release edge
+  static constexpr size_t kMaxEdges = 96;
+
+  static void IRAM_ATTR onEdge(void* context);
 
   uint8_t dataPin = 255;
   bool dht22 = true;
   bool started = false;
+  bool capturing = false;
+  bool armed = false;
+  uint32_t requestedAtUs = 0;
+
+  volatile uint32_t edgeUs[kMaxEdges] = {0};
+  volatile uint8_t edgeLevel[kMaxEdges] = {0};
+  volatile size_t edgeCount = 0;
 };
 
 extern DhtSensor dhtSensor;
@@ -0,0 +1,54 @@
+#include "report_gate.h"
+
+namespace app::sensor {
+
+namespace {
+
+uint16_t distance(int32_t a, int32_t b) {
+  return static_cast<uint16_t>(a > b ? a - b : b - a);
+}
+
+}  // namespace
+
+ReportGate::Decision ReportGate::evaluate(uint32_t nowMs, int16_t temperature10, uint16_t humidity10) {
+  counters.evaluated++;
+
+  Decision decision = Decision::Changed;
+  if (hasReported) {
+    const uint32_t silentMs = nowMs - lastReportMs;
+    const bool moved = distance(temperature10, lastTemperature10) >= config.temperatureDeadband10 ||
+                       distance(humidity10, lastHumidity10) >= config.humidityDeadband10;
+
+    if (silentMs < config.minIntervalMs) {
+      decision = Decision::Suppressed;
+    } else if (moved) {
+      decision = Decision::Changed;
+    } else if (silentMs >= config.maxSilenceMs) {
+      decision = Decision::Heartbeat;
+    } else {
+      decision = Decision::Suppressed;
+    }
+  }
+
+  if (decision == Decision::Suppressed) {
+    counters.suppressed++;
+    suppressedRun++;
+    return decision;
+  }
+
+  if (decision == Decision::Heartbeat) {
+    counters.heartbeats++;
+  } else {
+    counters.changed++;
+  }
+
+  hasReported = true;
+  lastReportMs = nowMs;
+  lastTemperature10 = temperature10;
+  lastHumidity10 = humidity10;
+  counters.suppressedBeforeLastReport = suppressedRun;
+  suppressedRun = 0;
+  return decision;
+}
+
+}  // namespace app::sensor
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace app::sensor {
+
+// Report-by-exception for filtered sensor values: a reading is sent only when it moved past a
+// deadband since the last report, no sooner than minIntervalMs after it, and at least every
+// maxSilenceMs as a heartbeat. Pure logic; the caller passes the clock.
+class ReportGate {
+ public:
+  struct Config {
+    uint16_t temperatureDeadband10 = 2;
+    uint16_t humidityDeadband10 = 10;
+    uint32_t minIntervalMs = 5000;
+    uint32_t maxSilenceMs = 300000;
+  };
+
+  enum class Decision : uint8_t {
+    Changed,
+    Heartbeat,
+    Suppressed,
+  };
+
+  struct Stats {
+    uint32_t evaluated = 0;
+    uint32_t changed = 0;
+    uint32_t heartbeats = 0;
+    uint32_t suppressed = 0;
+    uint32_t suppressedBeforeLastReport = 0;  // run of suppressed readings the last report ended
+  };
+
+  explicit ReportGate(const Config& initial) : config(initial) {}
+
+  // Decides whether to send; a Changed/Heartbeat decision records the value as reported.
+  Decision evaluate(uint32_t nowMs, int16_t temperature10, uint16_t humidity10);
+  static bool sends(Decision decision) { return decision != Decision::Suppressed; }
+  const Stats& stats() const { return counters; }
+
+ private:
+  Config config;
+  bool hasReported = false;
+  uint32_t lastReportMs = 0;
+  int16_t lastTemperature10 = 0;
+  uint16_t lastHumidity10 = 0;
+  uint32_t suppressedRun = 0;
+  Stats counters;
+};
+
+}  // namespace app::sensor
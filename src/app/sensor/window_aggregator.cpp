@@ -0,0 +1,65 @@
+#include "window_aggregator.h"
+
+namespace app::sensor {
+
+bool WindowAggregator::add(uint32_t timeS, const int16_t (&values)[kChannels], Window& closed) {
+  const uint32_t start = timeS - (timeS % windowS);
+  bool emitted = false;
+  if (count > 0 && start != startS) {
+    finish(closed);
+    count = 0;
+    emitted = true;
+  }
+
+  if (count == 0) {
+    startS = start;
+    for (size_t channel = 0; channel < kChannels; ++channel) {
+      acc[channel] = {values[channel], values[channel], 0, 0};
+    }
+  }
+
+  for (size_t channel = 0; channel < kChannels; ++channel) {
+    Accumulator& a = acc[channel];
+    const int32_t value = values[channel];
+    if (value < a.min) a.min = static_cast<int16_t>(value);
+    if (value > a.max) a.max = static_cast<int16_t>(value);
+    a.sum += value;
+    a.sumSquares += static_cast<int64_t>(value) * value;
+  }
+  if (count < UINT16_MAX) {
+    count++;
+  }
+  return emitted;
+}
+
+bool WindowAggregator::flush(Window& closed) {
+  if (count == 0) {
+    return false;
+  }
+  finish(closed);
+  count = 0;
+  return true;
+}
+
+void WindowAggregator::finish(Window& out) const {
+  out = Window{};
+  out.startS = startS;
+  out.windowS = windowS;
+  out.count = count;
+
+  const int64_t n = count;
+  for (size_t channel = 0; channel < kChannels; ++channel) {
+    const Accumulator& a = acc[channel];
+    Channel& c = out.channels[channel];
+    c.min = a.min;
+    c.max = a.max;
+    // tenths -> hundredths, rounded half away from zero
+    const int64_t scaled = a.sum * 10;
+    c.mean100 = static_cast<int32_t>((scaled + (scaled >= 0 ? n / 2 : -n / 2)) / n);
+    // population variance in tenths^2, scaled to hundredths^2: 100 * (n * sum(x^2) - sum(x)^2) / n^2
+    const int64_t numerator = n * a.sumSquares - a.sum * a.sum;
+    c.variance10000 = numerator > 0 ? static_cast<uint32_t>(numerator * 100 / (n * n)) : 0;
+  }
+}
+
+}  // namespace app::sensor
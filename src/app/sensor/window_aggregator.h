@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace app::sensor {
+
+// Streaming min/max/mean/variance of one sensor over fixed windows aligned to multiples of
+// windowS. Integer only: inputs in tenths, mean in hundredths, variance in hundredths squared
+// (0.0001 unit^2). O(1) state per channel.
+class WindowAggregator {
+ public:
+  static constexpr size_t kChannels = 2;  // temperature10, humidity10
+
+  struct Channel {
+    int16_t min = 0;
+    int16_t max = 0;
+    int32_t mean100 = 0;
+    uint32_t variance10000 = 0;
+  };
+
+  struct Window {
+    uint32_t startS = 0;
+    uint16_t windowS = 0;
+    uint16_t count = 0;
+    Channel channels[kChannels];
+  };
+
+  // not explicit so a list of window lengths can initialize an array of aggregators
+  WindowAggregator(uint16_t windowSeconds) : windowS(windowSeconds == 0 ? 1 : windowSeconds) {}
+
+  // Adds one sample; when it falls into a new window the previous one is returned in `closed`.
+  bool add(uint32_t timeS, const int16_t (&values)[kChannels], Window& closed);
+  // Closes the open window early (e.g. before sleep); false when it is empty.
+  bool flush(Window& closed);
+
+  uint16_t window() const { return windowS; }
+
+ private:
+  struct Accumulator {
+    int16_t min;
+    int16_t max;
+    int64_t sum;
+    int64_t sumSquares;
+  };
+
+  void finish(Window& out) const;
+
+  uint16_t windowS;
+  uint32_t startS = 0;
+  uint16_t count = 0;
+  Accumulator acc[kChannels] = {};
+};
+
+}  // namespace app::sensor
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/ringbuf.h>
+#include <freertos/task.h>
+
+#include <app_config.h>
+
+#include "app/espnow/protocol.h"
+#include "core/coro.h"
+
+// Sizes of everything created from static storage at boot: the app task (stack and TCB), the
+// coroutine frame arena and executor, the outgoing radio queue and the weather command ring
+// buffer. Nothing here comes from the heap, so startup cannot fail on allocation and the heap
+// stays free for ArduinoJson and Strings. The total is checked against STATIC_RAM_BUDGET_BYTES, set per env in
+// platformio.ini; growing any of these past the board's budget fails the build.
+
+#ifndef STATIC_RAM_BUDGET_BYTES
+#define STATIC_RAM_BUDGET_BYTES 20480
+#endif
+
+namespace app::static_config {
+
+inline constexpr uint32_t kAppTaskStackBytes = 8192;
+inline constexpr UBaseType_t kAppTaskPriority = 2;
+// Coroutines startAppTask spawns: radio, link, weather_sched, weather_pipe, input and storage, plus
+// mem_stats and profile when enabled. The frame arena gets one slot per coroutine; frame sizes are
+// logged at boot and a frame that does not fit falls back to the heap (counted in overflows).
+inline constexpr size_t coroutineCount(bool memStats, bool profiling) {
+  return 6 + (memStats ? 1 : 0) + (profiling ? 1 : 0);
+}
+inline constexpr size_t kCoroutineCount = coroutineCount(MEM_STATS_ENABLED, PROFILING_ENABLED);
+inline constexpr size_t kCoroutineFrameSlotBytes = 512;
+inline constexpr size_t kCoroutineFrameBytes = kCoroutineCount * kCoroutineFrameSlotBytes;
+inline constexpr size_t kOutgoingQueueDepth = 10;
+// upper bound for networkTask's OutgoingJob (payload plus size and type), checked there
+inline constexpr size_t kOutgoingItemBytes = app::espnow::MAX_PAYLOAD_SIZE + 4;
+// byte ring so v1 and large-frame commands share one buffer; NOSPLIT needs a multiple of 4
+inline constexpr size_t kCommandRingBytes = 4096;
+
+inline constexpr size_t kAppTaskBytes = kAppTaskStackBytes + sizeof(StaticTask_t);
+inline constexpr size_t kOutgoingQueueBytes = kOutgoingQueueDepth * kOutgoingItemBytes + sizeof(StaticQueue_t);
+inline constexpr size_t kCommandRingTotalBytes = kCommandRingBytes + sizeof(StaticRingbuffer_t);
+inline constexpr size_t kExecutorBytes = sizeof(coro::Executor);
+inline constexpr size_t kStaticBytes =
+    kAppTaskBytes + kCoroutineFrameBytes + kExecutorBytes + kOutgoingQueueBytes + kCommandRingTotalBytes;
+
+static_assert(kCoroutineCount <= coro::Executor::kMaxTasks, "More coroutines than executor slots");
+static_assert(coroutineCount(true, true) <= coro::Executor::kMaxTasks,
+              "Enabling mem_stats and profile would run out of executor slots");
+static_assert(kCommandRingBytes % 4 == 0, "Command ring size must be 32-bit aligned");
+static_assert(kStaticBytes <= STATIC_RAM_BUDGET_BYTES, "Static tasks/queues exceed STATIC_RAM_BUDGET_BYTES for this board");
+
+}  // namespace app::static_config
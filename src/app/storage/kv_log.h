@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace app::storage {
+
+// Append-only key-value log format. Each record is a fixed header, the key bytes and the value
+// bytes; the CRC covers the header (with crc = 0), key and value, so a torn write at the tail is
+// detected on replay. Later records for a key supersede earlier ones; Delete drops the key.
+// Pure logic, shared by the on-device store and host tools.
+
+static constexpr uint16_t kRecordMagic = 0x4B56;  // "KV"
+static constexpr size_t kMaxKeyBytes = 31;
+static constexpr size_t kMaxValueBytes = 1024;
+
+enum class RecordKind : uint8_t {
+  Put = 1,
+  Delete = 2,
+};
+
+struct __attribute__((packed)) RecordHeader {
+  uint16_t magic;
+  uint8_t kind;  // RecordKind
+  uint8_t keyLength;
+  uint16_t valueLength;
+  uint32_t crc;
+};
+
+inline size_t recordBytes(size_t keyLength, size_t valueLength) {
+  return sizeof(RecordHeader) + keyLength + valueLength;
+}
+
+// CRC-32 (IEEE, reflected), nibble table; small enough for both flash and host builds.
+inline uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length) {
+  static constexpr uint32_t kTable[16] = {
+      0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+      0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+  };
+  crc = ~crc;
+  for (size_t index = 0; index < length; ++index) {
+    crc = kTable[(crc ^ data[index]) & 0x0F] ^ (crc >> 4);
+    crc = kTable[(crc ^ (data[index] >> 4)) & 0x0F] ^ (crc >> 4);
+  }
+  return ~crc;
+}
+
+// Header CRC seed; continue with crc32Update over key and value.
+inline uint32_t headerCrc(const RecordHeader& header) {
+  RecordHeader copy = header;
+  copy.crc = 0;
+  return crc32Update(0, reinterpret_cast<const uint8_t*>(&copy), sizeof(copy));
+}
+
+inline RecordHeader makeRecord(RecordKind kind, const char* key, const void* value, size_t valueLength) {
+  RecordHeader header = {};
+  header.magic = kRecordMagic;
+  header.kind = static_cast<uint8_t>(kind);
+  header.keyLength = static_cast<uint8_t>(strlen(key));
+  header.valueLength = static_cast<uint16_t>(valueLength);
+  uint32_t crc = headerCrc(header);
+  crc = crc32Update(crc, reinterpret_cast<const uint8_t*>(key), header.keyLength);
+  crc = crc32Update(crc, static_cast<const uint8_t*>(value), valueLength);
+  header.crc = crc;
+  return header;
+}
+
+// Cheap checks before reading the body; the CRC decides in the end.
+inline bool headerPlausible(const RecordHeader& header) {
+  const bool knownKind = header.kind == static_cast<uint8_t>(RecordKind::Put) ||
+                         header.kind == static_cast<uint8_t>(RecordKind::Delete);
+  return header.magic == kRecordMagic && knownKind && header.keyLength > 0 && header.keyLength <= kMaxKeyBytes &&
+         header.valueLength <= kMaxValueBytes;
+}
+
+inline bool validKey(const char* key) {
+  if (key == nullptr) {
+    return false;
+  }
+  const size_t length = strlen(key);
+  return length > 0 && length <= kMaxKeyBytes;
+}
+
+}  // namespace app::storage
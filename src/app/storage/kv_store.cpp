@@ -0,0 +1,382 @@
+#include "kv_store.h"
+
+#include <LittleFS.h>
+#include <esp_log.h>
+
+namespace app::storage {
+
+namespace {
+
+static constexpr const char* TAG = "kv_store";
+static constexpr size_t kCopyChunkBytes = 64;
+
+// Reads `length` body bytes, folding them into the CRC; copies them to `out` when given.
+bool readBody(File& file, size_t length, uint32_t& crc, File* out) {
+  uint8_t chunk[kCopyChunkBytes];
+  while (length > 0) {
+    const size_t step = length < sizeof(chunk) ? length : sizeof(chunk);
+    if (file.read(chunk, step) != step) {
+      return false;
+    }
+    crc = crc32Update(crc, chunk, step);
+    if (out != nullptr && out->write(chunk, step) != step) {
+      return false;
+    }
+    length -= step;
+  }
+  return true;
+}
+
+}  // namespace
+
+KvStore kvStore("kv", KV_COMPACT_DEAD_PERCENT, KV_COMPACT_MIN_BYTES);
+
+KvStore::KvStore(const char* name, uint8_t deadPercent, uint32_t minBytes)
+    : path(String("/data/") + name + ".log"),
+      tempPath(String("/data/") + name + ".tmp"),
+      compactDeadPercent(deadPercent),
+      compactMinBytes(minBytes) {}
+
+bool KvStore::begin() {
+  if (started) {
+    return true;
+  }
+
+  lock = xSemaphoreCreateMutexStatic(&lockControl);
+  if (lock == nullptr) {
+    return false;
+  }
+
+  if (!LittleFS.exists("/data")) {
+    LittleFS.mkdir("/data");
+  }
+  // an interrupted compaction; the log itself is only replaced by the final rename
+  if (LittleFS.exists(tempPath)) {
+    LittleFS.remove(tempPath);
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  tornTail = !replay();
+  if (tornTail) {
+    // rewrite the valid prefix so new records never land behind garbage
+    compactLocked();
+  }
+  started = true;
+  xSemaphoreGive(lock);
+
+  ESP_LOGI(TAG, "%s: %u keys, %lu/%lu bytes live", path.c_str(), static_cast<unsigned>(keyCount),
+           static_cast<unsigned long>(liveBytes), static_cast<unsigned long>(logBytes));
+  return true;
+}
+
+bool KvStore::replay() {
+  keyCount = 0;
+  logBytes = 0;
+  liveBytes = 0;
+
+  File file = LittleFS.open(path, "r");
+  if (!file) {
+    return true;
+  }
+
+  const uint32_t fileBytes = static_cast<uint32_t>(file.size());
+  uint32_t offset = 0;
+  while (offset < fileBytes) {
+    RecordHeader header;
+    char key[kMaxKeyBytes + 1] = {0};
+    if (file.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) != sizeof(header) ||
+        !headerPlausible(header) ||
+        file.read(reinterpret_cast<uint8_t*>(key), header.keyLength) != header.keyLength) {
+      break;
+    }
+
+    uint32_t crc = crc32Update(headerCrc(header), reinterpret_cast<const uint8_t*>(key), header.keyLength);
+    if (!readBody(file, header.valueLength, crc, nullptr) || crc != header.crc) {
+      break;
+    }
+
+    if (header.kind == static_cast<uint8_t>(RecordKind::Put)) {
+      setIndex(key, offset, header.valueLength);
+    } else {
+      dropIndex(find(key));
+    }
+    offset += recordBytes(header.keyLength, header.valueLength);
+  }
+  file.close();
+
+  logBytes = offset;
+  if (offset == fileBytes) {
+    return true;
+  }
+
+  counters.droppedBytes += fileBytes - offset;
+  ESP_LOGW(TAG, "%s: dropped %lu bytes of torn tail at %lu", path.c_str(),
+           static_cast<unsigned long>(fileBytes - offset), static_cast<unsigned long>(offset));
+  return false;
+}
+
+int KvStore::find(const char* key) const {
+  for (size_t slot = 0; slot < keyCount; ++slot) {
+    if (strcmp(index[slot].key, key) == 0) {
+      return static_cast<int>(slot);
+    }
+  }
+  return -1;
+}
+
+void KvStore::setIndex(const char* key, uint32_t offset, uint16_t valueLength) {
+  int slot = find(key);
+  if (slot >= 0) {
+    liveBytes -= recordBytes(strlen(index[slot].key), index[slot].valueLength);
+  } else {
+    if (keyCount == kMaxKeys) {
+      ESP_LOGW(TAG, "Index full, dropping key %s", key);
+      return;
+    }
+    slot = static_cast<int>(keyCount++);
+    strncpy(index[slot].key, key, kMaxKeyBytes);
+    index[slot].key[kMaxKeyBytes] = '\0';
+  }
+
+  index[slot].offset = offset;
+  index[slot].valueLength = valueLength;
+  liveBytes += recordBytes(strlen(key), valueLength);
+}
+
+void KvStore::dropIndex(int slot) {
+  if (slot < 0) {
+    return;
+  }
+  liveBytes -= recordBytes(strlen(index[slot].key), index[slot].valueLength);
+  index[slot] = index[keyCount - 1];
+  keyCount--;
+}
+
+bool KvStore::append(RecordKind kind, const char* key, const void* value, size_t length, uint32_t& offset) {
+  // a record written behind a torn one would be lost on replay and misplace the index
+  if (tornTail && !compactLocked()) {
+    return false;
+  }
+
+  const RecordHeader header = makeRecord(kind, key, value, length);
+
+  File file = LittleFS.open(path, "a");
+  if (!file) {
+    counters.writeErrors++;
+    ESP_LOGW(TAG, "Failed to open %s for append", path.c_str());
+    return false;
+  }
+
+  size_t written = file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+  written += file.write(reinterpret_cast<const uint8_t*>(key), header.keyLength);
+  if (length > 0) {
+    written += file.write(static_cast<const uint8_t*>(value), length);
+  }
+  file.close();
+
+  const size_t expected = recordBytes(header.keyLength, length);
+  counters.bytesWritten += written;
+  if (written != expected) {
+    // LittleFS cannot truncate through the Arduino API: drop the partial record by compacting now,
+    // or before the next append if there is no room for that yet
+    counters.writeErrors++;
+    ESP_LOGW(TAG, "Short record write to %s (%u/%u bytes)", path.c_str(), static_cast<unsigned>(written),
+             static_cast<unsigned>(expected));
+    tornTail = written > 0;
+    if (tornTail) {
+      compactLocked();
+    }
+    return false;
+  }
+
+  offset = logBytes;
+  logBytes += expected;
+  return true;
+}
+
+bool KvStore::put(const char* key, const void* value, size_t length) {
+  if (!started || !validKey(key) || length > kMaxValueBytes || (value == nullptr && length > 0)) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  bool ok = find(key) >= 0 || keyCount < kMaxKeys;
+  uint32_t offset = 0;
+  if (ok) {
+    ok = append(RecordKind::Put, key, value, length, offset);
+  }
+  if (ok) {
+    setIndex(key, offset, static_cast<uint16_t>(length));
+    counters.puts++;
+  }
+  xSemaphoreGive(lock);
+  return ok;
+}
+
+bool KvStore::put(const char* key, const String& value) {
+  return put(key, value.c_str(), value.length());
+}
+
+bool KvStore::get(const char* key, void* value, size_t capacity, size_t* length) {
+  if (!started || !validKey(key)) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  const int slot = find(key);
+  bool ok = slot >= 0;
+  if (ok) {
+    const IndexEntry& entry = index[slot];
+    if (length != nullptr) {
+      *length = entry.valueLength;
+    }
+
+    const size_t copy = entry.valueLength < capacity ? entry.valueLength : capacity;
+    if (copy > 0) {
+      File file = LittleFS.open(path, "r");
+      ok = file && file.seek(entry.offset + sizeof(RecordHeader) + strlen(entry.key)) &&
+           file.read(static_cast<uint8_t*>(value), copy) == copy;
+      file.close();
+    }
+  }
+  xSemaphoreGive(lock);
+  return ok;
+}
+
+bool KvStore::get(const char* key, String& value) {
+  value = "";
+
+  size_t length = 0;
+  if (!get(key, nullptr, 0, &length)) {
+    return false;
+  }
+
+  const size_t capacity = length;
+  auto* buffer = static_cast<char*>(malloc(capacity + 1));
+  if (buffer == nullptr) {
+    return false;
+  }
+  // the value may have been replaced between the two calls; never read past what was copied
+  const bool ok = get(key, buffer, capacity, &length);
+  if (ok) {
+    value = String(buffer, length < capacity ? length : capacity);
+  }
+  free(buffer);
+  return ok;
+}
+
+bool KvStore::remove(const char* key) {
+  if (!started || !validKey(key)) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  const int slot = find(key);
+  uint32_t offset = 0;
+  const bool ok = slot < 0 || append(RecordKind::Delete, key, nullptr, 0, offset);
+  if (slot >= 0 && ok) {
+    dropIndex(slot);
+    counters.deletes++;
+  }
+  xSemaphoreGive(lock);
+  return ok;
+}
+
+bool KvStore::contains(const char* key) {
+  if (!started || !validKey(key)) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  const bool found = find(key) >= 0;
+  xSemaphoreGive(lock);
+  return found;
+}
+
+void KvStore::loop() {
+  if (!started) {
+    return;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  const uint32_t deadBytes = logBytes - liveBytes;
+  if (logBytes >= compactMinBytes && deadBytes * 100 >= static_cast<uint32_t>(compactDeadPercent) * logBytes) {
+    compactLocked();
+  }
+  xSemaphoreGive(lock);
+}
+
+bool KvStore::compact() {
+  if (!started) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  const bool ok = compactLocked();
+  xSemaphoreGive(lock);
+  return ok;
+}
+
+bool KvStore::compactLocked() {
+  const uint32_t before = logBytes;
+
+  File source = LittleFS.open(path, "r");
+  if (!source && keyCount > 0) {
+    // renaming an empty copy over the log would lose every key
+    counters.writeErrors++;
+    ESP_LOGW(TAG, "Failed to open %s for compaction", path.c_str());
+    return false;
+  }
+  File target = LittleFS.open(tempPath, "w");
+  if (!target) {
+    source.close();
+    counters.writeErrors++;
+    return false;
+  }
+
+  uint32_t offset = 0;
+  bool ok = true;
+  for (size_t slot = 0; slot < keyCount && ok && source; ++slot) {
+    IndexEntry& entry = index[slot];
+    const size_t bytes = recordBytes(strlen(entry.key), entry.valueLength);
+    uint32_t crc = 0;
+    ok = source.seek(entry.offset) && readBody(source, bytes, crc, &target);
+    entry.offset = offset;
+    offset += bytes;
+  }
+  source.close();
+  target.close();
+
+  if (!ok || !LittleFS.rename(tempPath, path)) {
+    // offsets were already moved; rebuild them from the untouched log
+    LittleFS.remove(tempPath);
+    counters.writeErrors++;
+    tornTail = !replay();
+    ESP_LOGW(TAG, "Compaction of %s failed", path.c_str());
+    return false;
+  }
+
+  logBytes = offset;
+  tornTail = false;
+  counters.bytesWritten += offset;
+  counters.compactions++;
+  ESP_LOGI(TAG, "Compacted %s: %lu -> %lu bytes, %u keys", path.c_str(), static_cast<unsigned long>(before),
+           static_cast<unsigned long>(logBytes), static_cast<unsigned>(keyCount));
+  return true;
+}
+
+KvStats KvStore::stats() {
+  if (lock != nullptr) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+  }
+  KvStats out = counters;
+  out.logBytes = logBytes;
+  out.liveBytes = liveBytes;
+  out.keys = static_cast<uint16_t>(keyCount);
+  if (lock != nullptr) {
+    xSemaphoreGive(lock);
+  }
+  return out;
+}
+
+}  // namespace app::storage
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "kv_log.h"
+
+#include <app_config.h>
+
+namespace app::storage {
+
+struct KvStats {
+  uint32_t puts = 0;
+  uint32_t deletes = 0;
+  uint32_t bytesWritten = 0;  // log appends plus compaction copies
+  uint32_t compactions = 0;
+  uint32_t droppedBytes = 0;  // torn tail discarded on replay
+  uint32_t writeErrors = 0;
+  uint32_t logBytes = 0;
+  uint32_t liveBytes = 0;
+  uint16_t keys = 0;
+};
+
+// Key-value store on LittleFS as one append-only log (/data/<name>.log). Every put/remove appends
+// a CRC-protected record instead of rewriting a file; a RAM index maps each key to its latest
+// record, so get() is an index lookup plus one read. begin() rebuilds the index by replaying the
+// log and drops a torn tail, as does a short write. loop() compacts (live records copied to <name>.tmp, renamed over
+// the log) once dead records pass compactDeadPercent of the file. Safe to call from any task.
+class KvStore {
+ public:
+  static constexpr size_t kMaxKeys = KV_MAX_KEYS;
+
+  KvStore(const char* name, uint8_t compactDeadPercent, uint32_t compactMinBytes);
+
+  bool begin();
+
+  bool put(const char* key, const void* value, size_t length);
+  bool put(const char* key, const String& value);
+  // Copies the value into `value` (up to capacity); `length` gets the stored size.
+  bool get(const char* key, void* value, size_t capacity, size_t* length = nullptr);
+  bool get(const char* key, String& value);
+  bool remove(const char* key);
+  bool contains(const char* key);
+
+  // Background compaction check; cheap when there is nothing to do.
+  void loop();
+  bool compact();
+
+  KvStats stats();
+
+ private:
+  struct IndexEntry {
+    char key[kMaxKeyBytes + 1];
+    uint32_t offset;
+    uint16_t valueLength;
+  };
+
+  int find(const char* key) const;
+  bool append(RecordKind kind, const char* key, const void* value, size_t length, uint32_t& offset);
+  bool replay();
+  bool compactLocked();
+  void setIndex(const char* key, uint32_t offset, uint16_t valueLength);
+  void dropIndex(int slot);
+
+  String path;
+  String tempPath;
+  uint8_t compactDeadPercent;
+  uint32_t compactMinBytes;
+  bool started = false;
+
+  IndexEntry index[kMaxKeys] = {};
+  size_t keyCount = 0;
+  uint32_t logBytes = 0;
+  uint32_t liveBytes = 0;
+  // garbage behind logBytes (short write, torn replay) that must be compacted away before appending
+  bool tornTail = false;
+
+  SemaphoreHandle_t lock = nullptr;
+  StaticSemaphore_t lockControl;
+  KvStats counters;
+};
+
+// small settings and caches (last proxy request, ...)
+extern KvStore kvStore;
+
+}  // namespace app::storage
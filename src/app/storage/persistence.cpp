@@ -0,0 +1,190 @@
+#include "persistence.h"
+
+#include "kv_store.h"
+
+#include <esp_log.h>
+
+namespace app::storage {
+
+namespace {
+
+static constexpr const char* TAG = "persistence";
+
+}  // namespace
+
+Persistence persistence(PERSIST_FLUSH_WINDOW_MS);
+
+Persistence::Persistence(uint32_t windowMs) : flushWindowMs(windowMs) {}
+
+bool Persistence::begin() {
+  if (started) {
+    return true;
+  }
+
+  lock = xSemaphoreCreateMutexStatic(&lockControl);
+  if (lock == nullptr) {
+    return false;
+  }
+  started = true;
+  return true;
+}
+
+uint32_t Persistence::hashOf(const String& value) {
+  return crc32Update(0, reinterpret_cast<const uint8_t*>(value.c_str()), value.length());
+}
+
+int Persistence::slotFor(const char* key) {
+  for (size_t index = 0; index < slotCount; ++index) {
+    if (strcmp(slots[index].key, key) == 0) {
+      return static_cast<int>(index);
+    }
+  }
+  if (slotCount == kMaxKeys) {
+    return -1;
+  }
+
+  // first use of the key since boot: hash what is already on flash so a reboot does not cost a write
+  Slot& slot = slots[slotCount];
+  strncpy(slot.key, key, kMaxKeyBytes);
+  slot.key[kMaxKeyBytes] = '\0';
+  String stored;
+  slot.stored = kvStore.get(key, stored);
+  slot.hash = slot.stored ? hashOf(stored) : 0;
+  slot.length = static_cast<uint16_t>(stored.length());
+  slot.dirty = false;
+  slot.value = String();
+  return static_cast<int>(slotCount++);
+}
+
+bool Persistence::save(const char* key, const String& value) {
+  if (!started || !validKey(key)) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  const int index = slotFor(key);
+  bool ok = index >= 0;
+  if (!ok) {
+    // more keys than slots: no coalescing, but the value still lands
+    ok = kvStore.put(key, value);
+  } else {
+    Slot& slot = slots[index];
+    const uint32_t hash = hashOf(value);
+    if (slot.dirty && value == slot.value) {
+      counters.skippedUnchanged++;
+    } else if (slot.stored && hash == slot.hash && value.length() == slot.length) {
+      // back to what is on flash: nothing left to write for this key
+      if (slot.dirty) {
+        slot.dirty = false;
+        slot.value = String();
+        counters.coalesced++;
+      }
+      counters.skippedUnchanged++;
+    } else {
+      if (slot.dirty) {
+        counters.coalesced++;
+      }
+      slot.value = value;
+      slot.dirty = true;
+      counters.staged++;
+      if (!anyDirty) {
+        anyDirty = true;
+        firstDirtyMs = millis();
+      }
+    }
+  }
+  xSemaphoreGive(lock);
+  return ok;
+}
+
+bool Persistence::load(const char* key, String& value) {
+  if (!started || !validKey(key)) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  bool found = false;
+  for (size_t index = 0; index < slotCount; ++index) {
+    if (slots[index].dirty && strcmp(slots[index].key, key) == 0) {
+      value = slots[index].value;
+      found = true;
+      break;
+    }
+  }
+  xSemaphoreGive(lock);
+  return found || kvStore.get(key, value);
+}
+
+void Persistence::loop(uint32_t nowMs, bool urgent) {
+  if (!started) {
+    return;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (anyDirty && (urgent || nowMs - firstDirtyMs >= flushWindowMs)) {
+    flushLocked();
+  }
+  xSemaphoreGive(lock);
+}
+
+bool Persistence::flush() {
+  if (!started) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  const bool ok = flushLocked();
+  xSemaphoreGive(lock);
+  return ok;
+}
+
+bool Persistence::flushLocked() {
+  if (!anyDirty) {
+    return true;
+  }
+
+  bool ok = true;
+  for (size_t index = 0; index < slotCount; ++index) {
+    Slot& slot = slots[index];
+    if (!slot.dirty) {
+      continue;
+    }
+    if (!kvStore.put(slot.key, slot.value)) {
+      // stays dirty; retried on the next flush
+      counters.writeErrors++;
+      ok = false;
+      continue;
+    }
+    slot.hash = hashOf(slot.value);
+    slot.length = static_cast<uint16_t>(slot.value.length());
+    slot.stored = true;
+    slot.dirty = false;
+    slot.value = String();
+    counters.writes++;
+  }
+
+  anyDirty = !ok;
+  firstDirtyMs = millis();
+  counters.flushes++;
+  ESP_LOGD(TAG, "Flushed, %lu writes total, %lu unchanged skipped", static_cast<unsigned long>(counters.writes),
+           static_cast<unsigned long>(counters.skippedUnchanged));
+  return ok;
+}
+
+PersistStats Persistence::stats() {
+  if (lock != nullptr) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+  }
+  PersistStats out = counters;
+  uint8_t pending = 0;
+  for (size_t index = 0; index < slotCount; ++index) {
+    pending += slots[index].dirty ? 1 : 0;
+  }
+  out.pending = pending;
+  if (lock != nullptr) {
+    xSemaphoreGive(lock);
+  }
+  return out;
+}
+
+}  // namespace app::storage
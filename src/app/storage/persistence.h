@@ -0,0 +1,73 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "kv_log.h"
+
+#include <app_config.h>
+
+namespace app::storage {
+
+struct PersistStats {
+  uint32_t staged = 0;
+  uint32_t skippedUnchanged = 0;  // identical to what is stored or already staged
+  uint32_t coalesced = 0;         // replaced a staged value before it was flushed
+  uint32_t flushes = 0;
+  uint32_t writes = 0;
+  uint32_t writeErrors = 0;
+  uint8_t pending = 0;
+};
+
+// Write-coalescing front end for kvStore. save() hashes the value and drops it when it matches
+// what is stored; otherwise it is kept in RAM and written on the next flush, at most
+// flushWindowMs after the first unsaved change. Several saves of one key inside the window cost
+// one flash write. Callers flush() early on shutdown and low battery. Safe to call from any task.
+class Persistence {
+ public:
+  static constexpr size_t kMaxKeys = 8;
+
+  explicit Persistence(uint32_t flushWindowMs);
+
+  bool begin();
+
+  bool save(const char* key, const String& value);
+  // Staged value if there is one, otherwise the stored one.
+  bool load(const char* key, String& value);
+
+  // Flushes once the window has passed; `urgent` writes through without waiting.
+  void loop(uint32_t nowMs, bool urgent);
+  bool flush();
+
+  PersistStats stats();
+
+ private:
+  struct Slot {
+    char key[kMaxKeyBytes + 1];
+    uint32_t hash;    // CRC-32 of the stored value
+    uint16_t length;  // of the stored value
+    bool stored;
+    bool dirty;
+    String value;  // staged value while dirty
+  };
+
+  static uint32_t hashOf(const String& value);
+  int slotFor(const char* key);
+  bool flushLocked();
+
+  uint32_t flushWindowMs;
+  Slot slots[kMaxKeys] = {};
+  size_t slotCount = 0;
+  uint32_t firstDirtyMs = 0;
+  bool anyDirty = false;
+  bool started = false;
+
+  SemaphoreHandle_t lock = nullptr;
+  StaticSemaphore_t lockControl;
+  PersistStats counters;
+};
+
+extern Persistence persistence;
+
+}  // namespace app::storage
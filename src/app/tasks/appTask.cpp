@@ -0,0 +1,245 @@
+#include "appTask.h"
+
+#include "app/static_config.h"
+#include "app/espnow/slave.h"
+#include "app/history/series_clock.h"
+#include "app/history/timeseries_store.h"
+#include "app/power/report_policy.h"
+#include "app/storage/kv_store.h"
+#include "app/storage/persistence.h"
+#include "app/telemetry/profiler.h"
+#include "app/tasks/inputTask.h"
+#include "app/tasks/networkTask.h"
+
+#include <core/coro.h>
+#include <core/mem_tier.h>
+#include <esp_log.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace app::tasks {
+
+namespace {
+
+static constexpr const char* TAG = "APP_TASK";
+static constexpr uint32_t APP_TASK_STACK = app::static_config::kAppTaskStackBytes;
+static constexpr UBaseType_t APP_TASK_PRIORITY = app::static_config::kAppTaskPriority;
+// longest sleep while a coroutine waits on a condition (link up/down)
+static constexpr uint32_t kMaxIdleMs = 10;
+static constexpr uint32_t kStorageIntervalMs = 1000;
+static constexpr uint32_t kFlashReportIntervalMs = 60UL * 60UL * 1000UL;
+// network_task + weather_pipe + input_task stacks before they became coroutines
+static constexpr uint32_t kSeparateTaskStacks = 8192 + 6144 + 4096;
+
+TaskHandle_t appTaskHandle = nullptr;
+StaticTask_t appTaskControl;
+StackType_t appTaskStack[APP_TASK_STACK / sizeof(StackType_t)];
+alignas(std::max_align_t) uint8_t coroutineFrames[app::static_config::kCoroutineFrameBytes];
+
+uint32_t executorClock() {
+  return millis();
+}
+
+coro::Executor executor(executorClock, kMaxIdleMs);
+
+#if PROFILING_ENABLED
+uint32_t busyClock() {
+  return static_cast<uint32_t>(esp_timer_get_time());
+}
+
+void reportProfileFrame(const uint8_t* frame, size_t size, bool send) {
+  if (size == 0) {
+    return;
+  }
+  app::telemetry::profiler::logFrame(frame, size);
+  if (send) {
+    publishOutgoingBinary(frame, size);
+  }
+}
+
+// One report per window: section histograms, FreeRTOS task CPU, coroutine CPU. Always on serial;
+// to the master only once it confirms FeatureProfile.
+coro::Task profileLoop() {
+  uint8_t frame[app::telemetry::profiler::kFrameBytes];
+  uint32_t windowStartMs = millis();
+
+  while (true) {
+    co_await coro::delay(PROFILE_REPORT_INTERVAL_MS);
+
+    const uint32_t now = millis();
+    const uint32_t windowMs = now - windowStartMs;
+    windowStartMs = now;
+    const bool send = app::espnow::espnowSlave.isMasterLinked() &&
+                      (app::espnow::espnowSlave.masterFeatures() & app::espnow::state_binary::FeatureProfile) != 0;
+
+    reportProfileFrame(frame, app::telemetry::profiler::buildSections(frame, sizeof(frame), windowMs), send);
+    reportProfileFrame(frame, app::telemetry::profiler::buildTasks(frame, sizeof(frame), windowMs), send);
+    reportProfileFrame(frame, app::telemetry::profiler::buildCoroutines(frame, sizeof(frame), windowMs, executor),
+                       send);
+  }
+}
+#endif
+
+// Everything still in RAM that should survive a power loss (shutdown handler).
+void flushAll() {
+  app::storage::persistence.flush();
+  #if TIMESERIES_ENABLED
+  app::history::sensorSeries.sync();
+  app::history::weatherSeries.sync();
+  #endif
+}
+
+uint32_t flashBytesWritten() {
+  uint32_t bytes = app::storage::kvStore.stats().bytesWritten;
+  #if TIMESERIES_ENABLED
+  bytes += app::history::sensorSeries.stats().bytesWritten;
+  bytes += app::history::weatherSeries.stats().bytesWritten;
+  #endif
+  return bytes;
+}
+
+void logFlashUsage(uint32_t nowMs) {
+  const uint32_t bytes = flashBytesWritten();
+  const auto persist = app::storage::persistence.stats();
+  const uint64_t perDay = nowMs > 0 ? static_cast<uint64_t>(bytes) * 86400000ULL / nowMs : 0;
+  ESP_LOGI(TAG, "flash writes: %lu bytes in %lu min (~%lu bytes/day), %lu unchanged saves skipped, %lu coalesced",
+           static_cast<unsigned long>(bytes), static_cast<unsigned long>(nowMs / 60000UL),
+           static_cast<unsigned long>(perDay), static_cast<unsigned long>(persist.skippedUnchanged),
+           static_cast<unsigned long>(persist.coalesced));
+}
+
+// Flash housekeeping off the hot paths: coalesced writes, sealed series blocks, key-value log
+// compaction, and an early flush when the battery drops to LOW/CRITICAL (the next step may be a
+// brownout). Every LittleFS operation is followed by a yield, so the radio and input coroutines
+// never wait behind more than one of them.
+coro::Task storageLoop() {
+  auto lastLevel = app::power::reportPolicy.level();
+  uint32_t lastReportMs = millis();
+
+  while (true) {
+    const auto level = app::power::reportPolicy.level();
+    const bool lowBattery = level >= app::power::PowerLevel::Low;
+    if (lowBattery && level > lastLevel) {
+      ESP_LOGW(TAG, "Battery %s, flushing pending writes", app::power::ReportPolicy::levelName(level));
+      app::storage::persistence.flush();
+      co_await coro::yield();
+      #if TIMESERIES_ENABLED
+      app::history::sensorSeries.sync();
+      co_await coro::yield();
+      app::history::weatherSeries.sync();
+      co_await coro::yield();
+      #endif
+    }
+    lastLevel = level;
+
+    // on low battery nothing waits for the flush window
+    app::storage::persistence.loop(millis(), lowBattery);
+    co_await coro::yield();
+    app::storage::kvStore.loop();
+    co_await coro::yield();
+    #if TIMESERIES_ENABLED
+    app::history::sensorSeries.loop();
+    co_await coro::yield();
+    app::history::weatherSeries.loop();
+    co_await coro::yield();
+    #endif
+    app::history::seriesClock.loop();
+
+    const uint32_t now = millis();
+    if (now - lastReportMs >= kFlashReportIntervalMs) {
+      lastReportMs = now;
+      logFlashUsage(now);
+    }
+
+    co_await coro::delay(kStorageIntervalMs);
+  }
+}
+
+void logFrameSizes() {
+  for (size_t index = 0; index < executor.size(); ++index) {
+    const auto& info = executor.info(index);
+    ESP_LOGI(TAG, "coroutine %-13s frame=%u bytes", info.name, static_cast<unsigned>(info.frameBytes));
+  }
+
+  const uint32_t used = APP_TASK_STACK + executor.frameBytes();
+  ESP_LOGI(TAG, "%u coroutines: stack %lu + frames %u bytes, %ld bytes less than separate tasks",
+           static_cast<unsigned>(executor.size()), static_cast<unsigned long>(APP_TASK_STACK),
+           static_cast<unsigned>(executor.frameBytes()),
+           static_cast<long>(kSeparateTaskStacks) - static_cast<long>(used));
+
+  const auto& arena = coro::frameArena;
+  if (arena.overflows > 0) {
+    ESP_LOGW(TAG, "frame arena: %u/%u bytes, %lu frames fell back to the heap; raise kCoroutineFrameSlotBytes",
+             static_cast<unsigned>(arena.used), static_cast<unsigned>(arena.capacity),
+             static_cast<unsigned long>(arena.overflows));
+  } else {
+    ESP_LOGI(TAG, "frame arena: %u/%u bytes", static_cast<unsigned>(arena.used), static_cast<unsigned>(arena.capacity));
+  }
+}
+
+void appTaskRunner(void*) {
+  logFrameSizes();
+  mem::logUsage();
+
+  while (true) {
+    const uint32_t idleMs = executor.runOnce();
+    // always give up at least one tick so the idle task and its watchdog get to run
+    const TickType_t idleTicks = pdMS_TO_TICKS(idleMs);
+    vTaskDelay(idleTicks > 0 ? idleTicks : 1);
+  }
+}
+
+}  // namespace
+
+bool startAppTask() {
+  if (appTaskHandle != nullptr) {
+    return true;
+  }
+
+  // coroutine frames come from static storage, like the task stack below
+  coro::useFrameArena(coroutineFrames, sizeof(coroutineFrames));
+
+  // network first: it brings up ESP-NOW and the command buffer the pipeline drains
+  const bool networkStarted = startNetworkTask(executor);
+  if (!executor.spawn("weather_pipe", app::espnow::espnowSlave.runCommandPipeline())) {
+    ESP_LOGE(TAG, "Failed to start weather pipeline coroutine");
+  }
+  const bool inputStarted = startInputTask(executor);
+  if (!executor.spawn("storage", storageLoop())) {
+    ESP_LOGE(TAG, "Failed to start storage coroutine");
+  }
+  #if PROFILING_ENABLED
+  executor.setBusyClock(busyClock);
+  if (!executor.spawn("profile", profileLoop())) {
+    ESP_LOGE(TAG, "Failed to start profile coroutine");
+  }
+  #endif
+  if (!networkStarted || !inputStarted) {
+    ESP_LOGE(TAG, "Some coroutines failed to start (network=%d input=%d)", networkStarted, inputStarted);
+  }
+
+  // esp_restart() (OTA, watchdog-free resets) runs this before the chip goes down
+  esp_register_shutdown_handler(flushAll);
+
+  appTaskHandle = xTaskCreateStaticPinnedToCore(
+      appTaskRunner,
+      "app_task",
+      APP_TASK_STACK,
+      nullptr,
+      APP_TASK_PRIORITY,
+      appTaskStack,
+      &appTaskControl,
+      tskNO_AFFINITY);
+
+  if (appTaskHandle == nullptr) {
+    ESP_LOGE(TAG, "Failed to start app task");
+    return false;
+  }
+
+  ESP_LOGI(TAG, "App task started");
+  return true;
+}
+
+}  // namespace app::tasks
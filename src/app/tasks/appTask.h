@@ -0,0 +1,8 @@
+#pragma once
+
+namespace app::tasks {
+
+// Runs the network, weather-pipeline, input and storage coroutines on one FreeRTOS task.
+bool startAppTask();
+
+}  // namespace app::tasks
@@ -1,39 +1,147 @@
 #include "inputTask.h"
 
-#include "app/espnow/payload_codec.h"
+#include "app/espnow/slave.h"
+#include "app/history/series_clock.h"
+#include "app/history/timeseries_store.h"
 #include "app/input/battery/battery_manager.h"
+#include "app/power/report_policy.h"
+#include "app/sensor/dht_filter.h"
 #include "app/sensor/dht_sensor.h"
+#include "app/sensor/report_gate.h"
+#include "app/sensor/window_aggregator.h"
+#include "app/telemetry/telemetry_batch.h"
 #include "app/tasks/networkTask.h"
 #include "app/espnow/state_binary.h"
 
 #include <app_config.h>
+#include <cmath>
 #include <esp_log.h>
-#include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
 
 namespace app::tasks {
 
 namespace {
 
 static constexpr const char* TAG = "INPUT_TASK";
-static constexpr uint16_t INPUT_TASK_STACK = 4096;
-static constexpr UBaseType_t INPUT_TASK_PRIORITY = 1;
 static constexpr uint32_t INPUT_POLL_INTERVAL_MS = 20;
-static constexpr uint32_t BATTERY_PUBLISH_INTERVAL_MS = 1000;
 
-TaskHandle_t inputTaskHandle = nullptr;
 BatteryManager batteryManager;
 
-static uint32_t lastDhtReadMs = 0;
+app::sensor::DhtFilter::Config dhtFilterConfig() {
+  auto config = app::sensor::DhtFilter::defaultConfig(DHT_SENSOR_IS_DHT22 == 1, DHT_READ_INTERVAL_MS);
+  config.retryCount = DHT_RETRY_COUNT;
+  config.windowSize = DHT_FILTER_WINDOW;
+  config.minQuality = DHT_MIN_QUALITY;
+  return config;
+}
+
+app::sensor::DhtFilter dhtFilter(dhtFilterConfig());
+
+app::sensor::ReportGate::Config sensorGateConfig() {
+  app::sensor::ReportGate::Config config;
+  config.temperatureDeadband10 = SENSOR_DEADBAND_TEMP10;
+  config.humidityDeadband10 = SENSOR_DEADBAND_HUM10;
+  config.minIntervalMs = SENSOR_MIN_REPORT_INTERVAL_MS;
+  config.maxSilenceMs = SENSOR_MAX_SILENCE_MS;
+  return config;
+}
+
+app::sensor::ReportGate sensorGate(sensorGateConfig());
+
+bool shouldReportSensor(uint32_t now, int16_t temperature10, uint16_t humidity10) {
+#if SENSOR_REPORT_ON_CHANGE
+  const auto decision = sensorGate.evaluate(now, temperature10, humidity10);
+  if (!app::sensor::ReportGate::sends(decision)) {
+    ESP_LOGD("DHT", "sensor unchanged, report suppressed (total=%lu)",
+             static_cast<unsigned long>(sensorGate.stats().suppressed));
+    return false;
+  }
+  ESP_LOGI("DHT", "sensor %s report, %lu suppressed before it (total=%lu)",
+           decision == app::sensor::ReportGate::Decision::Heartbeat ? "heartbeat" : "changed",
+           static_cast<unsigned long>(sensorGate.stats().suppressedBeforeLastReport),
+           static_cast<unsigned long>(sensorGate.stats().suppressed));
+  return true;
+#else
+  (void)now;
+  (void)temperature10;
+  (void)humidity10;
+  return true;
+#endif
+}
+
+#if SENSOR_AGGREGATE_ENABLED
+// one aggregator per configured window length
+app::sensor::WindowAggregator sensorAggregators[] = {SENSOR_AGGREGATE_WINDOWS_S};
+
+void publishSensorAggregate(const app::sensor::WindowAggregator::Window& window, uint32_t nowS) {
+  const auto& temperature = window.channels[0];
+  const auto& humidity = window.channels[1];
+
+  app::espnow::state_binary::SensorAggregateState state = {};
+  app::espnow::state_binary::initHeader(state.header, app::espnow::state_binary::Type::SensorAggregate);
+  state.windowS = window.windowS;
+  state.count = window.count;
+  const uint32_t endS = window.startS + window.windowS;
+  state.windowEndAgeS = nowS > endS ? nowS - endS : 0;
+  state.temperatureMin10 = temperature.min;
+  state.temperatureMax10 = temperature.max;
+  state.temperatureMean100 = static_cast<int16_t>(temperature.mean100);
+  state.temperatureVariance10000 = temperature.variance10000;
+  state.humidityMin10 = static_cast<uint16_t>(humidity.min);
+  state.humidityMax10 = static_cast<uint16_t>(humidity.max);
+  state.humidityMean100 = static_cast<uint16_t>(humidity.mean100);
+  state.humidityVariance10000 = humidity.variance10000;
+
+  ESP_LOGI("DHT", "sensor %us window: n=%u temp %.1f..%.1fC mean=%.2f hum %.1f..%.1f%% mean=%.2f", window.windowS,
+           window.count, temperature.min / 10.0f, temperature.max / 10.0f, temperature.mean100 / 100.0f,
+           humidity.min / 10.0f, humidity.max / 10.0f, humidity.mean100 / 100.0f);
+  app::tasks::publishOutgoingBinary(&state, sizeof(state));
+}
+#endif
+
+// Aggregates replace raw SensorState only once the master has confirmed it understands them;
+// raw readings remain available through SensorRawReq.
+bool aggregateSensorReading(const app::sensor::DhtFilter::Output& filtered) {
+#if SENSOR_AGGREGATE_ENABLED
+  if ((app::espnow::espnowSlave.masterFeatures() & app::espnow::state_binary::FeatureSensorAggregate) == 0 ||
+      app::telemetry::telemetryBatch.isActive()) {
+    return false;
+  }
+
+  const uint32_t nowS = app::history::seriesClock.nowS();
+  const int16_t values[] = {filtered.temperature10, static_cast<int16_t>(filtered.humidity10)};
+  for (auto& aggregator : sensorAggregators) {
+    app::sensor::WindowAggregator::Window closed;
+    if (aggregator.add(nowS, values, closed)) {
+      publishSensorAggregate(closed, nowS);
+    }
+  }
+  return true;
+#else
+  (void)filtered;
+  return false;
+#endif
+}
 
 uint32_t lastBatteryPublishMs = 0;
 int lastPublishedBatteryLevel = -1;
+ChargingState lastPublishedCharging = CHARGING_UNKNOWN;
 
 void publishBatterySnapshotToDisplay() {
   batteryManager.update();
+  app::power::reportPolicy.update(batteryManager.getState(), batteryManager.getChargingState(),
+                                  static_cast<uint8_t>(constrain(batteryManager.getLevel(), 0, 100)));
+  // the IR-drop compensation and the runtime fallback follow the load of the current report rates
+  batteryManager.setLoadMa(app::power::reportPolicy.loadMa());
+
+  // on critical battery only alive beacons go out; the level itself reaches the master as PowerPolicyState
+  const uint32_t publishIntervalMs =
+      app::power::reportPolicy.interval(app::power::Activity::Battery, BATTERY_UPDATE_INTERVAL_MS);
+  if (publishIntervalMs == 0) {
+    return;
+  }
 
   const uint32_t now = millis();
-  if (lastBatteryPublishMs != 0 && (now - lastBatteryPublishMs) < BATTERY_PUBLISH_INTERVAL_MS) {
+  if (lastBatteryPublishMs != 0 && (now - lastBatteryPublishMs) < publishIntervalMs) {
     return;
   }
 
@@ -42,76 +150,117 @@ void publishBatterySnapshotToDisplay() {
     return;
   }
 
-  if (batteryLevel == lastPublishedBatteryLevel && lastBatteryPublishMs != 0) {
+  const ChargingState charging = batteryManager.getChargingState();
+  if (batteryLevel == lastPublishedBatteryLevel && charging == lastPublishedCharging && lastBatteryPublishMs != 0) {
     return;
   }
 
-  const String payload = app::espnow::codec::buildPayload({
-      {"batt", String(batteryLevel)},
-  });
+  if (app::telemetry::telemetryBatch.isActive()) {
+    app::telemetry::telemetryBatch.record(app::telemetry::ReadingKind::Battery,
+                                          static_cast<int16_t>(batteryLevel),
+                                          static_cast<int16_t>(batteryManager.getVoltageMv()));
+  } else {
+    app::espnow::state_binary::BatteryState state = {};
+    app::espnow::state_binary::initHeader(state.header, app::espnow::state_binary::Type::Battery);
+    state.voltageMv = batteryManager.getVoltageMv();
+    state.percent = static_cast<uint8_t>(batteryLevel);
+    state.charging = static_cast<uint8_t>(charging);
+    state.runtimeMinutes = batteryManager.getRuntimeMinutes();
+    app::tasks::publishOutgoingBinary(&state, sizeof(state));
+  }
 
   lastPublishedBatteryLevel = batteryLevel;
+  lastPublishedCharging = charging;
   lastBatteryPublishMs = now;
 }
 
-void inputTaskRunner(void*) {
-  batteryManager.init(INPUT_BATTERY_ADC_PIN);
-  batteryManager.setVoltage(3.3f, 4.2f, 2.0f);
-  batteryManager.setUpdateInterval(5000);
+void publishSensorReading(const app::sensor::DhtFilter::Output& filtered) {
+  app::espnow::state_binary::SensorState state = {};
+  app::espnow::state_binary::initHeader(state.header, app::espnow::state_binary::Type::Sensor);
+  state.temperature10 = filtered.temperature10;
+  state.humidity10 = filtered.humidity10;
+  ESP_LOGI("DHT", "sensor temp=%.1fC hum=%.1f%% quality=%u", state.temperature10 / 10.0f,
+           state.humidity10 / 10.0f, filtered.quality);
+  if (app::telemetry::telemetryBatch.isActive()) {
+    // batched into the next proxy upload instead of one frame per reading
+    app::telemetry::telemetryBatch.record(app::telemetry::ReadingKind::Sensor, state.temperature10,
+                                          static_cast<int16_t>(state.humidity10));
+  } else {
+    // enqueue to the radio coroutine for sending via ESP-NOW
+    app::tasks::publishOutgoingBinary(&state, sizeof(state));
+  }
+}
+
+// Battery sampling and the DHT schedule; the DHT start pulse and frame capture are awaited, so the
+// other coroutines run while the ISR timestamps the edges.
+coro::Task inputLoop() {
   #if DHT_SENSOR_ENABLED
-  app::sensor::dhtSensor.begin(DHT_SENSOR_PIN, DHT_SENSOR_IS_DHT22 == 1);
-  lastDhtReadMs = millis();
+  uint32_t appliedPolicy = app::power::reportPolicy.generation();
   #endif
-  
-  publishBatterySnapshotToDisplay();
 
   while (true) {
     publishBatterySnapshotToDisplay();
 
     #if DHT_SENSOR_ENABLED
+    if (appliedPolicy != app::power::reportPolicy.generation()) {
+      appliedPolicy = app::power::reportPolicy.generation();
+      dhtFilter.setIntervalMs(app::power::reportPolicy.interval(app::power::Activity::Sensor, DHT_READ_INTERVAL_MS));
+    }
+
     const uint32_t now = millis();
-    if (now - lastDhtReadMs >= DHT_READ_INTERVAL_MS) {
+    if (app::power::reportPolicy.allowed(app::power::Activity::Sensor) && dhtFilter.due(now)) {
       app::sensor::DhtReading reading;
-      if (app::sensor::dhtSensor.read(reading) && reading.valid) {
-        app::espnow::state_binary::SensorState state = {};
-        app::espnow::state_binary::initHeader(state.header, app::espnow::state_binary::Type::Sensor);
-        state.temperature10 = static_cast<int16_t>(reading.temperatureC * 10.0f);
-        state.humidity10 = static_cast<uint16_t>(reading.humidityPercent * 10.0f);
-			  ESP_LOGI("DHT", "sensor temp=%.1fC hum=%.1f%%", reading.temperatureC, reading.humidityPercent);
-        // enqueue to network task for sending via ESP-NOW
-        app::tasks::publishOutgoingBinary(&state, sizeof(state));
+      bool ok = false;
+      if (const uint32_t startLowMs = app::sensor::dhtSensor.requestFrame()) {
+        co_await coro::delay(startLowMs);
+        if (const uint32_t captureMs = app::sensor::dhtSensor.armCapture()) {
+          co_await coro::delay(captureMs);
+          ok = app::sensor::dhtSensor.finishFrame(reading) && reading.valid;
+        }
+      }
+      app::sensor::DhtFilter::Output filtered;
+      const auto result = dhtFilter.onRead(now, ok, static_cast<int16_t>(lroundf(reading.temperatureC * 10.0f)),
+                                           static_cast<uint16_t>(lroundf(reading.humidityPercent * 10.0f)), filtered);
+      if (result == app::sensor::DhtFilter::Result::LowQuality) {
+        ESP_LOGW("DHT", "filtered reading held back, quality=%u samples=%u", filtered.quality, filtered.samples);
+      } else if (result == app::sensor::DhtFilter::Result::Publish) {
+        // the cell sits next to the sensor; its temperature feeds the SoC compensation
+        batteryManager.setTemperature(filtered.temperature10);
+        #if TIMESERIES_ENABLED
+        // local history keeps every filtered reading, including the ones not reported
+        const int32_t values[] = {filtered.temperature10, filtered.humidity10};
+        app::history::sensorSeries.append(app::history::seriesClock.nowS(), values);
+        #endif
+        if (!aggregateSensorReading(filtered) && shouldReportSensor(now, filtered.temperature10, filtered.humidity10)) {
+          publishSensorReading(filtered);
+        }
       }
-      lastDhtReadMs = now;
     }
     #endif
 
-    vTaskDelay(pdMS_TO_TICKS(INPUT_POLL_INTERVAL_MS));
+    co_await coro::delay(INPUT_POLL_INTERVAL_MS);
   }
 }
 
 }  // namespace
 
-bool startInputTask() {
-  if (inputTaskHandle != nullptr) {
-    return true;
-  }
+bool startInputTask(coro::Executor& executor) {
+  batteryManager.setVoltageDivider(2.0f);
+  batteryManager.init(INPUT_BATTERY_ADC_PIN, INPUT_BATTERY_CHARGE_PIN);
+  batteryManager.setUpdateInterval(BATTERY_UPDATE_INTERVAL_MS);
+  #if DHT_SENSOR_ENABLED
+  app::sensor::dhtSensor.begin(DHT_SENSOR_PIN, DHT_SENSOR_IS_DHT22 == 1);
+  dhtFilter.begin(millis());
+  #endif
+
+  publishBatterySnapshotToDisplay();
 
-  BaseType_t created = xTaskCreatePinnedToCore(
-      inputTaskRunner,
-      "input_task",
-      INPUT_TASK_STACK,
-      nullptr,
-      INPUT_TASK_PRIORITY,
-      &inputTaskHandle,
-      tskNO_AFFINITY);
-
-  if (created != pdPASS) {
-    ESP_LOGE(TAG, "Failed to start input task");
-    inputTaskHandle = nullptr;
+  if (!executor.spawn("input", inputLoop())) {
+    ESP_LOGE(TAG, "Failed to start input coroutine");
     return false;
   }
 
-  ESP_LOGI(TAG, "Input task started");
+  ESP_LOGI(TAG, "Input coroutine started");
   return true;
 }
 
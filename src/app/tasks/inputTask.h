@@ -1,7 +1,10 @@
 #pragma once
 
+#include <core/coro.h>
+
 namespace app::tasks {
 
-bool startInputTask();
+// Initializes battery and DHT inputs and spawns the input coroutine.
+bool startInputTask(coro::Executor& executor);
 
 }  // namespace app::tasks
@@ -1,103 +1,83 @@
 #include "networkTask.h"
 
+#include "app/espnow/proxy_client.h"
 #include "app/espnow/slave.h"
 #include "app/espnow/state_binary.h"
+#include "app/power/report_policy.h"
+#include "app/telemetry/mem_stats.h"
+#include "app/telemetry/sensor_history.h"
+#include "app/telemetry/telemetry_batch.h"
 #include "app/weather/open_meteo_locations.h"
-#include "app/espnow/payload_codec.h"
+#include "app/weather/open_meteo_requests.h"
+#include "app/static_config.h"
 
 #include <app_config.h>
+#include <core/mem_tier.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
-#include <freertos/task.h>
 #include <esp_log.h>
 
 namespace app::tasks {
 
 namespace {
 
-static constexpr uint16_t NETWORK_TASK_STACK = 8192;
-static constexpr UBaseType_t NETWORK_TASK_PRIORITY = 2;
-static constexpr uint32_t kWeatherRefreshIntervalMs = 60UL * 60UL * 1000UL; // 1h
+static constexpr uint32_t kRadioIntervalMs = 10;
+static constexpr uint32_t kWeatherScheduleIntervalMs = 1000;
+// how long link-up waits for MasterFeatures (v1 masters never send it) before registering templates
+static constexpr uint32_t kMasterFeaturesWaitMs = 500;
 // use macro WEATHER_PROXY_REQUEST_INTERVAL_MS from app_config.h for proxy interval
-static constexpr size_t OUTGOING_QUEUE_DEPTH = 10;
+static constexpr size_t OUTGOING_QUEUE_DEPTH = app::static_config::kOutgoingQueueDepth;
+// requests are sent straight from the compile-time table, so the configured area must be in it
+static_assert(WEATHER_AREA_INDEX >= 0 && WEATHER_AREA_INDEX < app::weather::kAreaCount,
+              "WEATHER_AREA_INDEX is not in the request table");
 
 struct OutgoingJob {
   uint8_t payload[app::espnow::MAX_PAYLOAD_SIZE];
   uint16_t payloadSize;
   bool isText;
 };
+static_assert(sizeof(OutgoingJob) <= app::static_config::kOutgoingItemBytes, "OutgoingJob outgrew kOutgoingItemBytes");
 
-TaskHandle_t networkTaskHandle = nullptr;
 QueueHandle_t outgoingQueue = nullptr;
+StaticQueue_t outgoingQueueControl;
+uint8_t outgoingQueueStorage[OUTGOING_QUEUE_DEPTH * sizeof(OutgoingJob)];
 
-void sendIdentityStateNow() {
-  app::espnow::state_binary::IdentityState state = {};
-  app::espnow::state_binary::initHeader(state.header, app::espnow::state_binary::Type::Identity);
-  strncpy(state.id, DEVICE_NAME, sizeof(state.id) - 1);
-  app::espnow::espnowSlave.sendStateBinary(&state, sizeof(state));
+void publishProxyRequestNow() {
+  app::espnow::proxyClient.requestCurrentWeather(app::espnow::espnowSlave,
+                                                 static_cast<app::weather::Area>(WEATHER_AREA_INDEX));
 }
 
-void sendFeaturesStateNow() {
-  app::espnow::state_binary::FeaturesState state = {};
-  app::espnow::state_binary::initHeader(state.header, app::espnow::state_binary::Type::Features);
-  state.contractVersion = 1;
-  state.featureBits = static_cast<uint32_t>(app::espnow::state_binary::FeatureIdentity)
-                   | static_cast<uint32_t>(app::espnow::state_binary::FeatureSensor)
-                   | static_cast<uint32_t>(app::espnow::state_binary::FeatureWeather)
-                   | static_cast<uint32_t>(app::espnow::state_binary::FeatureProxyClient);
+void publishPowerPolicy() {
+  using app::power::Activity;
+  const auto& policy = app::power::reportPolicy;
+
+  app::espnow::state_binary::PowerPolicyState state = {};
+  app::espnow::state_binary::initHeader(state.header, app::espnow::state_binary::Type::PowerPolicy);
+  state.level = static_cast<uint8_t>(policy.level());
+  state.batteryPercent = policy.batteryPercent();
+  state.sensorIntervalS = static_cast<uint16_t>(policy.interval(Activity::Sensor, DHT_READ_INTERVAL_MS) / 1000UL);
+  state.batteryIntervalS =
+      static_cast<uint16_t>(policy.interval(Activity::Battery, BATTERY_UPDATE_INTERVAL_MS) / 1000UL);
+  state.weatherIntervalMin = static_cast<uint16_t>(
+      policy.interval(Activity::WeatherProxy, WEATHER_PROXY_REQUEST_INTERVAL_MS) / 60000UL);
+  state.helloIntervalS =
+      static_cast<uint16_t>(policy.interval(Activity::Hello, app::espnow::HELLO_INTERVAL_MS) / 1000UL);
   app::espnow::espnowSlave.sendStateBinary(&state, sizeof(state));
 }
 
-void publishProxyRequestNow(const String& url) {
-  app::espnow::state_binary::ProxyReqState request = {};
-  app::espnow::state_binary::initHeader(request.header, app::espnow::state_binary::Type::ProxyReq);
-  request.method = static_cast<uint8_t>(app::espnow::state_binary::HttpMethod::Get);
-  strncpy(request.url, url.c_str(), sizeof(request.url) - 1);
-  app::espnow::espnowSlave.sendStateBinary(&request, sizeof(request));
-}
-
-void networkTaskRunner(void*) {
-  // start espnow radio
-  app::espnow::espnowSlave.begin(app::espnow::DEFAULT_CHANNEL);
-
-  // prepare outgoing queue
-  outgoingQueue = xQueueCreate(OUTGOING_QUEUE_DEPTH, sizeof(OutgoingJob));
-  if (outgoingQueue == nullptr) {
-    ESP_LOGE("NET_TASK", "Failed creating outgoing queue");
-  }
-
-  // weather cache/load
-  String cachedProxyRequest;
-  String cachedWeatherUrl;
-  if (app::weather::loadLastReport(cachedProxyRequest)) {
-    if (!cachedProxyRequest.startsWith("state=proxy_req") ||
-        !app::espnow::codec::getField(cachedProxyRequest, "url", cachedWeatherUrl) || cachedWeatherUrl.isEmpty()) {
-      cachedProxyRequest = "";
-      cachedWeatherUrl = "";
-    }
-  }
+uint32_t lastWeatherRequestMs = 0;
+uint32_t publishedPolicy = 0;
 
-  uint32_t lastWeatherRefreshMs = 0;
-  uint32_t lastWeatherRequestMs = 0;
-  bool wasMasterLinked = false;
-
-  if (cachedWeatherUrl.isEmpty()) {
-    const auto area = static_cast<app::weather::Area>(WEATHER_AREA_INDEX);
-    cachedWeatherUrl = app::weather::buildCurrentWeatherUrl(area);
-    cachedProxyRequest = app::espnow::codec::buildPayload({
-        {"state", "proxy_req"},
-        {"method", "GET"},
-        {"url", cachedWeatherUrl},
-        {"payload", "{}"},
-    });
-    app::weather::saveLastReport(cachedProxyRequest);
-  }
+bool masterLinked(void*) {
+  return app::espnow::espnowSlave.isMasterLinked();
+}
 
-  // send initial proxy request (bootstrap)
-  publishProxyRequestNow(cachedWeatherUrl);
-  lastWeatherRefreshMs = millis();
-  lastWeatherRequestMs = millis();
+bool masterLost(void*) {
+  return !app::espnow::espnowSlave.isMasterLinked();
+}
 
+// Radio housekeeping: beacon/scan state, outgoing frames, batched and replayed history.
+coro::Task radioLoop() {
   while (true) {
     app::espnow::espnowSlave.loop();
 
@@ -106,71 +86,172 @@ void networkTaskRunner(void*) {
       OutgoingJob job;
       if (xQueueReceive(outgoingQueue, &job, 0) == pdTRUE) {
         if (job.payloadSize > 0) {
-          app::espnow::espnowSlave.sendStateBinary(job.payload, job.payloadSize);
+          const bool sent = app::espnow::espnowSlave.isMasterLinked() &&
+                            app::espnow::espnowSlave.sendStateBinary(job.payload, job.payloadSize);
+          if (!sent) {
+            // sensor readings are kept for replay instead of being dropped
+            app::telemetry::sensorHistory.recordFrame(job.payload, job.payloadSize);
+          }
         }
       }
     }
 
-    // handle master link events and periodic proxy requests
+    app::telemetry::telemetryBatch.loop(app::espnow::espnowSlave);
+    app::telemetry::sensorHistory.loop(app::espnow::espnowSlave,
+                                       outgoingQueue != nullptr && uxQueueMessagesWaiting(outgoingQueue) > 0);
+
+    if (app::espnow::espnowSlave.isMasterLinked() && publishedPolicy != app::power::reportPolicy.generation()) {
+      publishedPolicy = app::power::reportPolicy.generation();
+      publishPowerPolicy();
+    }
+
+    co_await coro::delay(kRadioIntervalMs);
+  }
+}
+
+// Link-up handshake as straight-line code: identity, features, templates, policy, first request.
+coro::Task linkLoop() {
+  while (true) {
+    co_await coro::until(masterLinked);
+
+    app::espnow::espnowSlave.sendIdentityState();
+    app::espnow::espnowSlave.sendFeaturesState();
+    // templates are split by the negotiated frame size, so let the master answer first
+    const uint32_t featuresAskedMs = millis();
+    while (app::espnow::espnowSlave.masterFeatures() == 0 && millis() - featuresAskedMs < kMasterFeaturesWaitMs) {
+      co_await coro::delay(kRadioIntervalMs);
+    }
+    app::espnow::proxyClient.registerTemplates(app::espnow::espnowSlave);
+    publishPowerPolicy();
+    publishedPolicy = app::power::reportPolicy.generation();
+    if (app::power::reportPolicy.allowed(app::power::Activity::WeatherProxy)) {
+      publishProxyRequestNow();
+      lastWeatherRequestMs = millis();
+    }
+
+    co_await coro::until(masterLost);
+    app::espnow::proxyClient.resetTemplates();
+  }
+}
+
+#if LINK_STATS_LOG_INTERVAL_MS > 0
+// How often the master's IdentityReq/WeatherSyncReq were answered, debounced, rate-limited or
+// served from the cached weather record, and what the state deltas saved.
+void logLinkStats() {
+  const auto requests = app::espnow::masterRequestStats();
+  ESP_LOGI("NET_TASK",
+           "Master requests: identity allowed=%lu forced=%lu debounced=%lu limited=%lu, "
+           "weather sync allowed=%lu forced=%lu debounced=%lu limited=%lu cached=%lu",
+           static_cast<unsigned long>(requests.identity.allowed),
+           static_cast<unsigned long>(requests.identity.forced),
+           static_cast<unsigned long>(requests.identity.debounced),
+           static_cast<unsigned long>(requests.identity.limited),
+           static_cast<unsigned long>(requests.weatherSync.allowed),
+           static_cast<unsigned long>(requests.weatherSync.forced),
+           static_cast<unsigned long>(requests.weatherSync.debounced),
+           static_cast<unsigned long>(requests.weatherSync.limited),
+           static_cast<unsigned long>(requests.cachedWeatherReplies));
+
+  const auto delta = app::espnow::espnowSlave.deltaStats();
+  if (delta.rawBytes > 0) {
+    ESP_LOGI("NET_TASK", "State deltas: %lu keyframes %lu deltas, %lu -> %lu bytes (%.0f%% saved)",
+             static_cast<unsigned long>(delta.keyframes),
+             static_cast<unsigned long>(delta.deltas),
+             static_cast<unsigned long>(delta.rawBytes),
+             static_cast<unsigned long>(delta.encodedBytes),
+             100.0f * (1.0f - static_cast<float>(delta.encodedBytes) / delta.rawBytes));
+  }
+}
+#endif
+
+// Periodic proxy requests on the power policy's (hour-scale) interval, plus the link counters log.
+coro::Task weatherScheduleLoop() {
+#if LINK_STATS_LOG_INTERVAL_MS > 0
+  uint32_t lastLinkStatsLogMs = millis();
+#endif
+  while (true) {
     const uint32_t now = millis();
-    const bool isMasterLinked = app::espnow::espnowSlave.isMasterLinked();
-    if (isMasterLinked && !wasMasterLinked) {
-      sendIdentityStateNow();
-      sendFeaturesStateNow();
-      if (cachedWeatherUrl.isEmpty()) {
-        const auto area = static_cast<app::weather::Area>(WEATHER_AREA_INDEX);
-        cachedWeatherUrl = app::weather::buildCurrentWeatherUrl(area);
-      }
-      publishProxyRequestNow(cachedWeatherUrl);
+    const uint32_t weatherRequestIntervalMs = app::power::reportPolicy.interval(
+        app::power::Activity::WeatherProxy, static_cast<uint32_t>(WEATHER_PROXY_REQUEST_INTERVAL_MS));
+    if (weatherRequestIntervalMs != 0 && now - lastWeatherRequestMs >= weatherRequestIntervalMs) {
+      publishProxyRequestNow();
       lastWeatherRequestMs = now;
     }
-    wasMasterLinked = isMasterLinked;
-
-    if (now - lastWeatherRefreshMs >= kWeatherRefreshIntervalMs) {
-      const auto area = static_cast<app::weather::Area>(WEATHER_AREA_INDEX);
-      cachedWeatherUrl = app::weather::buildCurrentWeatherUrl(area);
-      cachedProxyRequest = app::espnow::codec::buildPayload({
-          {"state", "proxy_req"},
-          {"method", "GET"},
-          {"url", cachedWeatherUrl},
-          {"payload", "{}"},
-      });
-      app::weather::saveLastReport(cachedProxyRequest);
-      lastWeatherRefreshMs = now;
+
+#if LINK_STATS_LOG_INTERVAL_MS > 0
+    if (now - lastLinkStatsLogMs >= static_cast<uint32_t>(LINK_STATS_LOG_INTERVAL_MS)) {
+      logLinkStats();
+      lastLinkStatsLogMs = now;
     }
+#endif
 
-    if (!cachedProxyRequest.isEmpty() && (now - lastWeatherRequestMs >= static_cast<uint32_t>(WEATHER_PROXY_REQUEST_INTERVAL_MS))) {
-      publishProxyRequestNow(cachedWeatherUrl);
-      lastWeatherRequestMs = now;
+    co_await coro::delay(kWeatherScheduleIntervalMs);
+  }
+}
+
+#if MEM_STATS_ENABLED
+// Memory health for the master once it confirms FeatureMemStats; the first report goes out right
+// after the link is up so a fresh boot is visible too.
+coro::Task memStatsLoop() {
+  uint8_t frame[app::telemetry::kMemStatsFrameBytes];
+  while (true) {
+    co_await coro::until(masterLinked);
+
+    const uint32_t intervalMs =
+        app::power::reportPolicy.interval(app::power::Activity::Telemetry, static_cast<uint32_t>(MEM_STATS_INTERVAL_MS));
+    const bool supported =
+        (app::espnow::espnowSlave.masterFeatures() & app::espnow::state_binary::FeatureMemStats) != 0;
+    if (intervalMs == 0 || !supported) {
+      co_await coro::delay(kWeatherScheduleIntervalMs);
+      continue;
     }
 
-    vTaskDelay(pdMS_TO_TICKS(10));
+    const size_t size = app::telemetry::buildMemStats(frame, sizeof(frame));
+    if (size > 0 && publishOutgoingBinary(frame, size)) {
+      app::telemetry::logMemStats(frame, size);
+    }
+    co_await coro::delay(intervalMs);
   }
 }
+#endif
+
 
 }  // namespace
 
-bool startNetworkTask() {
-  if (networkTaskHandle != nullptr) {
-    return true;
+bool startNetworkTask(coro::Executor& executor) {
+  // start espnow radio
+  app::espnow::espnowSlave.begin(app::espnow::DEFAULT_CHANNEL);
+
+  // prepare outgoing queue
+  if (outgoingQueue == nullptr) {
+    outgoingQueue = xQueueCreateStatic(OUTGOING_QUEUE_DEPTH, sizeof(OutgoingJob), outgoingQueueStorage,
+                                       &outgoingQueueControl);
+    mem::place(mem::MemClass::Queue, outgoingQueueStorage, sizeof(outgoingQueueStorage));
   }
 
-  BaseType_t created = xTaskCreatePinnedToCore(
-      networkTaskRunner,
-      "network_task",
-      NETWORK_TASK_STACK,
-      nullptr,
-      NETWORK_TASK_PRIORITY,
-      &networkTaskHandle,
-      tskNO_AFFINITY);
-
-  if (created != pdPASS) {
-    ESP_LOGE("NET_TASK", "Failed to start network task");
-    networkTaskHandle = nullptr;
+  app::telemetry::sensorHistory.begin();
+
+  const auto area = static_cast<app::weather::Area>(WEATHER_AREA_INDEX);
+  ESP_LOGI("NET_TASK", "Weather requests for %s: %s", app::weather::toString(area),
+           app::weather::currentWeatherRequest(area).url);
+  app::weather::dropLastReport();
+  publishedPolicy = app::power::reportPolicy.generation();
+
+  // send initial proxy request (bootstrap)
+  publishProxyRequestNow();
+  lastWeatherRequestMs = millis();
+
+  bool spawned = executor.spawn("radio", radioLoop()) && executor.spawn("link", linkLoop()) &&
+                 executor.spawn("weather_sched", weatherScheduleLoop());
+  #if MEM_STATS_ENABLED
+  spawned = spawned && executor.spawn("mem_stats", memStatsLoop());
+  #endif
+  if (!spawned) {
+    ESP_LOGE("NET_TASK", "Failed to start network coroutines");
     return false;
   }
 
-  ESP_LOGI("NET_TASK", "Network task started");
+  ESP_LOGI("NET_TASK", "Network coroutines started");
   return true;
 }
 
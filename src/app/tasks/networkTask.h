@@ -1,12 +1,14 @@
 #pragma once
 
 #include <Arduino.h>
+#include <core/coro.h>
 
 namespace app::tasks {
 
-bool startNetworkTask();
+// Starts the radio and spawns the network coroutines (radio, link handshake, weather schedule).
+bool startNetworkTask(coro::Executor& executor);
 
-// Publish an outgoing payload to be sent by the network task.
+// Publish an outgoing payload to be sent by the radio coroutine.
 bool publishOutgoingBinary(const void* payload, size_t payloadSize);
 bool publishOutgoingText(const String& text);
 
@@ -0,0 +1,87 @@
+#include "mem_stats.h"
+
+#include <SpiAllocator.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace app::telemetry {
+
+namespace {
+
+static constexpr const char* TAG = "mem_stats";
+// tasks that exist on every board; missing ones (no Wi-Fi yet, ...) are skipped
+static constexpr const char* kNamedTasks[] = {"app_task", "esp_timer", "wifi", "sys_evt"};
+
+using app::espnow::state_binary::MemStatsState;
+using app::espnow::state_binary::MemStatsTask;
+
+void addTask(MemStatsState& state, MemStatsTask* tasks, TaskHandle_t handle) {
+  if (handle == nullptr || state.taskCount >= app::espnow::state_binary::kMemStatsMaxTasks) {
+    return;
+  }
+  MemStatsTask& entry = tasks[state.taskCount++];
+  strncpy(entry.name, pcTaskGetName(handle), sizeof(entry.name) - 1);
+  entry.name[sizeof(entry.name) - 1] = '\0';
+  // ESP-IDF reports the high-water mark in bytes
+  const UBaseType_t freeBytes = uxTaskGetStackHighWaterMark(handle);
+  entry.stackFreeMin = static_cast<uint16_t>(freeBytes > UINT16_MAX ? UINT16_MAX : freeBytes);
+}
+
+}  // namespace
+
+size_t buildMemStats(uint8_t* out, size_t capacity) {
+  if (out == nullptr || capacity < kMemStatsFrameBytes) {
+    return 0;
+  }
+  memset(out, 0, kMemStatsFrameBytes);
+
+  auto& state = *reinterpret_cast<MemStatsState*>(out);
+  auto* tasks = reinterpret_cast<MemStatsTask*>(out + sizeof(MemStatsState));
+  app::espnow::state_binary::initHeader(state.header, app::espnow::state_binary::Type::MemStats);
+
+  state.uptimeS = millis() / 1000UL;
+  state.heapFree = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  state.heapLargestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+  state.heapMinFree = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+  state.psramFree = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+  state.psramTotal = heap_caps_get_total_size(MALLOC_CAP_SPIRAM);
+
+  const SpiAllocatorStats json = SpiAllocator::instance()->stats();
+  state.jsonAllocations = json.allocations;
+  state.jsonFrees = json.deallocations;
+  state.jsonLiveBytes = json.liveBytes;
+  state.jsonPeakBytes = json.peakBytes;
+  state.jsonFailures = static_cast<uint16_t>(json.failures > UINT16_MAX ? UINT16_MAX : json.failures);
+
+  for (const char* name : kNamedTasks) {
+    addTask(state, tasks, xTaskGetHandle(name));
+  }
+  for (BaseType_t core = 0; core < portNUM_PROCESSORS; ++core) {
+    addTask(state, tasks, xTaskGetIdleTaskHandleForCore(core));
+  }
+
+  return sizeof(MemStatsState) + state.taskCount * sizeof(MemStatsTask);
+}
+
+void logMemStats(const uint8_t* frame, size_t size) {
+  if (frame == nullptr || size < sizeof(MemStatsState)) {
+    return;
+  }
+
+  const auto& state = *reinterpret_cast<const MemStatsState*>(frame);
+  const auto* tasks = reinterpret_cast<const MemStatsTask*>(frame + sizeof(MemStatsState));
+  ESP_LOGI(TAG, "heap free=%lu largest=%lu min=%lu psram=%lu/%lu json allocs=%lu frees=%lu live=%lu peak=%lu fail=%u",
+           static_cast<unsigned long>(state.heapFree), static_cast<unsigned long>(state.heapLargestBlock),
+           static_cast<unsigned long>(state.heapMinFree), static_cast<unsigned long>(state.psramFree),
+           static_cast<unsigned long>(state.psramTotal), static_cast<unsigned long>(state.jsonAllocations),
+           static_cast<unsigned long>(state.jsonFrees), static_cast<unsigned long>(state.jsonLiveBytes),
+           static_cast<unsigned long>(state.jsonPeakBytes), state.jsonFailures);
+  for (size_t index = 0; index < state.taskCount && sizeof(MemStatsState) + (index + 1) * sizeof(MemStatsTask) <= size;
+       ++index) {
+    ESP_LOGI(TAG, "  %-11s stack free min=%u", tasks[index].name, tasks[index].stackFreeMin);
+  }
+}
+
+}  // namespace app::telemetry
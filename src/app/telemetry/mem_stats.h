@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "app/espnow/protocol.h"
+#include "app/espnow/state_binary.h"
+
+namespace app::telemetry {
+
+static constexpr size_t kMemStatsFrameBytes =
+    sizeof(app::espnow::state_binary::MemStatsState) +
+    app::espnow::state_binary::kMemStatsMaxTasks * sizeof(app::espnow::state_binary::MemStatsTask);
+static_assert(kMemStatsFrameBytes <= app::espnow::MAX_PAYLOAD_SIZE, "MemStatsState does not fit one v1 frame");
+
+// Fills a MemStatsState frame (heap, PSRAM, SpiAllocator counters, then one entry per known task:
+// app_task, the system tasks and the idle task of each core) into `out`; returns its size.
+size_t buildMemStats(uint8_t* out, size_t capacity);
+
+// Same figures on the serial log.
+void logMemStats(const uint8_t* frame, size_t size);
+
+}  // namespace app::telemetry
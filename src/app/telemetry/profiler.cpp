@@ -0,0 +1,229 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace app::telemetry::profiler {
+
+namespace {
+
+static constexpr const char* TAG = "profiler";
+static constexpr const char* kSectionNames[kSectionCount] = {"rx_cb", "slave_loop", "chunk", "json", "send"};
+// snapshot sizes for FreeRTOS tasks; more tasks than this are left out of the report
+static constexpr size_t kMaxTasks = 20;
+
+using app::espnow::state_binary::kProfileBuckets;
+using app::espnow::state_binary::ProfileCpu;
+using app::espnow::state_binary::ProfileKind;
+using app::espnow::state_binary::ProfileSection;
+using app::espnow::state_binary::ProfileState;
+
+struct Histogram {
+  uint32_t count;
+  uint32_t totalUs;
+  uint32_t maxUs;
+  uint16_t buckets[kProfileBuckets];
+};
+
+portMUX_TYPE histogramLock = portMUX_INITIALIZER_UNLOCKED;
+Histogram histograms[kSectionCount] = {};
+
+uint32_t lastCoroutineBusyUs[coro::Executor::kMaxTasks] = {};
+
+struct TaskSample {
+  TaskHandle_t handle;
+  configRUN_TIME_COUNTER_TYPE runTime;
+};
+TaskSample lastTasks[kMaxTasks] = {};
+size_t lastTaskCount = 0;
+configRUN_TIME_COUNTER_TYPE lastTotalRunTime = 0;
+
+ProfileState* beginFrame(uint8_t* out, ProfileKind kind, uint32_t windowMs) {
+  auto* state = reinterpret_cast<ProfileState*>(out);
+  memset(state, 0, sizeof(*state));
+  app::espnow::state_binary::initHeader(state->header, app::espnow::state_binary::Type::Profile);
+  state->kind = static_cast<uint8_t>(kind);
+  state->windowMs = windowMs;
+  return state;
+}
+
+void setName(ProfileCpu& entry, const char* name) {
+  memset(entry.name, 0, sizeof(entry.name));
+  strncpy(entry.name, name != nullptr ? name : "?", sizeof(entry.name) - 1);
+}
+
+uint16_t permille(uint64_t part, uint64_t whole) {
+  if (whole == 0) {
+    return 0;
+  }
+  const uint64_t value = part * 1000ULL / whole;
+  return static_cast<uint16_t>(value > 1000 ? 1000 : value);
+}
+
+}  // namespace
+
+void record(Section section, uint32_t elapsedUs) {
+  const size_t index = static_cast<size_t>(section);
+  if (index >= kSectionCount) {
+    return;
+  }
+
+  const size_t bucket = bucketOf(elapsedUs);
+  portENTER_CRITICAL(&histogramLock);
+  Histogram& histogram = histograms[index];
+  histogram.count++;
+  histogram.totalUs += elapsedUs;
+  histogram.maxUs = elapsedUs > histogram.maxUs ? elapsedUs : histogram.maxUs;
+  if (histogram.buckets[bucket] < UINT16_MAX) {
+    histogram.buckets[bucket]++;
+  }
+  portEXIT_CRITICAL(&histogramLock);
+}
+
+size_t buildSections(uint8_t* out, size_t capacity, uint32_t windowMs) {
+  const size_t size = sizeof(ProfileState) + kSectionCount * sizeof(ProfileSection);
+  if (out == nullptr || capacity < size) {
+    return 0;
+  }
+
+  Histogram snapshot[kSectionCount];
+  portENTER_CRITICAL(&histogramLock);
+  memcpy(snapshot, histograms, sizeof(snapshot));
+  memset(histograms, 0, sizeof(histograms));
+  portEXIT_CRITICAL(&histogramLock);
+
+  ProfileState* state = beginFrame(out, ProfileKind::Sections, windowMs);
+  auto* entries = reinterpret_cast<ProfileSection*>(out + sizeof(ProfileState));
+  for (size_t index = 0; index < kSectionCount; ++index) {
+    ProfileSection& entry = entries[index];
+    entry.section = static_cast<uint8_t>(index);
+    entry.reserved = 0;
+    entry.count = snapshot[index].count;
+    entry.totalUs = snapshot[index].totalUs;
+    entry.maxUs = snapshot[index].maxUs;
+    memcpy(entry.buckets, snapshot[index].buckets, sizeof(entry.buckets));
+  }
+  state->count = static_cast<uint8_t>(kSectionCount);
+  return size;
+}
+
+size_t buildTasks(uint8_t* out, size_t capacity, uint32_t windowMs) {
+  #if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+  if (out == nullptr || capacity < sizeof(ProfileState)) {
+    return 0;
+  }
+
+  TaskStatus_t tasks[kMaxTasks];
+  configRUN_TIME_COUNTER_TYPE totalRunTime = 0;
+  const size_t taskCount = uxTaskGetSystemState(tasks, kMaxTasks, &totalRunTime);
+  if (taskCount == 0) {
+    return 0;
+  }
+
+  // per-task run time since the previous report; new tasks count from zero
+  struct Delta {
+    const char* name;
+    configRUN_TIME_COUNTER_TYPE runTime;
+  };
+  Delta deltas[kMaxTasks];
+  for (size_t index = 0; index < taskCount; ++index) {
+    configRUN_TIME_COUNTER_TYPE previous = 0;
+    for (size_t last = 0; last < lastTaskCount; ++last) {
+      if (lastTasks[last].handle == tasks[index].xHandle) {
+        previous = lastTasks[last].runTime;
+        break;
+      }
+    }
+    deltas[index] = {tasks[index].pcTaskName, tasks[index].ulRunTimeCounter - previous};
+  }
+  const configRUN_TIME_COUNTER_TYPE window = totalRunTime - lastTotalRunTime;
+
+  for (size_t index = 0; index < taskCount; ++index) {
+    lastTasks[index] = {tasks[index].xHandle, tasks[index].ulRunTimeCounter};
+  }
+  lastTaskCount = taskCount;
+  lastTotalRunTime = totalRunTime;
+
+  std::sort(deltas, deltas + taskCount, [](const Delta& a, const Delta& b) { return a.runTime > b.runTime; });
+
+  ProfileState* state = beginFrame(out, ProfileKind::Tasks, windowMs);
+  auto* entries = reinterpret_cast<ProfileCpu*>(out + sizeof(ProfileState));
+  const size_t room = (capacity - sizeof(ProfileState)) / sizeof(ProfileCpu);
+  size_t count = std::min({taskCount, room, app::espnow::state_binary::kProfileMaxCpuEntries});
+  for (size_t index = 0; index < count; ++index) {
+    setName(entries[index], deltas[index].name);
+    entries[index].permille = permille(deltas[index].runTime, window);
+  }
+  state->count = static_cast<uint8_t>(count);
+  return sizeof(ProfileState) + count * sizeof(ProfileCpu);
+  #else
+  (void)out;
+  (void)capacity;
+  (void)windowMs;
+  return 0;
+  #endif
+}
+
+size_t buildCoroutines(uint8_t* out, size_t capacity, uint32_t windowMs, const coro::Executor& executor) {
+  if (out == nullptr || capacity < sizeof(ProfileState)) {
+    return 0;
+  }
+
+  ProfileState* state = beginFrame(out, ProfileKind::Coroutines, windowMs);
+  auto* entries = reinterpret_cast<ProfileCpu*>(out + sizeof(ProfileState));
+  const size_t room = (capacity - sizeof(ProfileState)) / sizeof(ProfileCpu);
+  const size_t count = std::min({executor.size(), room, app::espnow::state_binary::kProfileMaxCpuEntries});
+  const uint64_t windowUs = static_cast<uint64_t>(windowMs) * 1000ULL;
+  for (size_t index = 0; index < executor.size(); ++index) {
+    const auto& info = executor.info(index);
+    const uint32_t busyUs = info.busyUs - lastCoroutineBusyUs[index];
+    lastCoroutineBusyUs[index] = info.busyUs;
+    if (index < count) {
+      setName(entries[index], info.name);
+      entries[index].permille = permille(busyUs, windowUs);
+    }
+  }
+  state->count = static_cast<uint8_t>(count);
+  return sizeof(ProfileState) + count * sizeof(ProfileCpu);
+}
+
+void logFrame(const uint8_t* frame, size_t size) {
+  if (frame == nullptr || size < sizeof(ProfileState)) {
+    return;
+  }
+
+  const auto& state = *reinterpret_cast<const ProfileState*>(frame);
+  const auto kind = static_cast<ProfileKind>(state.kind);
+  if (kind == ProfileKind::Sections) {
+    const auto* entries = reinterpret_cast<const ProfileSection*>(frame + sizeof(ProfileState));
+    for (size_t index = 0; index < state.count && sizeof(ProfileState) + (index + 1) * sizeof(ProfileSection) <= size;
+         ++index) {
+      const ProfileSection& entry = entries[index];
+      if (entry.count == 0) {
+        continue;
+      }
+      const char* name = entry.section < kSectionCount ? kSectionNames[entry.section] : "?";
+      char buckets[kProfileBuckets * 7 + 1] = {0};
+      size_t used = 0;
+      for (size_t bucket = 0; bucket < kProfileBuckets && used < sizeof(buckets); ++bucket) {
+        used += snprintf(buckets + used, sizeof(buckets) - used, " %u", entry.buckets[bucket]);
+      }
+      ESP_LOGI(TAG, "%-10s n=%lu mean=%luus max=%luus |%s", name, static_cast<unsigned long>(entry.count),
+               static_cast<unsigned long>(entry.totalUs / entry.count), static_cast<unsigned long>(entry.maxUs),
+               buckets);
+    }
+    return;
+  }
+
+  const auto* entries = reinterpret_cast<const ProfileCpu*>(frame + sizeof(ProfileState));
+  const char* label = kind == ProfileKind::Tasks ? "task" : "coroutine";
+  for (size_t index = 0; index < state.count && sizeof(ProfileState) + (index + 1) * sizeof(ProfileCpu) <= size;
+       ++index) {
+    ESP_LOGI(TAG, "%-9s %-11s %u.%u%%", label, entries[index].name, entries[index].permille / 10,
+             entries[index].permille % 10);
+  }
+}
+
+}  // namespace app::telemetry::profiler
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+#include "app/espnow/protocol.h"
+#include "app/espnow/state_binary.h"
+
+#include <app_config.h>
+#include <core/coro.h>
+
+// Latency histograms for instrumented sections (buckets from kProfileFirstBucketUs doubling,
+// plus count/mean/max) and the CPU share of each coroutine and FreeRTOS task, reported per
+// window as ProfileState frames once FeatureProfile is negotiated. With PROFILING_ENABLED off
+// the scopes compile to nothing.
+namespace app::telemetry::profiler {
+
+using Section = app::espnow::state_binary::ProfileSectionId;
+
+static constexpr size_t kSectionCount = static_cast<size_t>(Section::Count);
+static constexpr size_t kFrameBytes = app::espnow::MAX_PAYLOAD_SIZE;
+static_assert(sizeof(app::espnow::state_binary::ProfileState) +
+                      kSectionCount * sizeof(app::espnow::state_binary::ProfileSection) <=
+                  kFrameBytes,
+              "ProfileState sections do not fit one v1 frame");
+static_assert(sizeof(app::espnow::state_binary::ProfileState) +
+                      app::espnow::state_binary::kProfileMaxCpuEntries * sizeof(app::espnow::state_binary::ProfileCpu) <=
+                  kFrameBytes,
+              "ProfileState CPU entries do not fit one v1 frame");
+
+inline size_t bucketOf(uint32_t elapsedUs) {
+  size_t bucket = 0;
+  uint32_t bound = app::espnow::state_binary::kProfileFirstBucketUs;
+  while (bucket + 1 < app::espnow::state_binary::kProfileBuckets && elapsedUs >= bound) {
+    bound <<= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+// Adds one call to the section's histogram; safe from any task and from the receive callback.
+void record(Section section, uint32_t elapsedUs);
+
+// Times the enclosing block. Compiles to nothing unless PROFILING_ENABLED.
+class Scope {
+ public:
+  explicit Scope(Section section) {
+    #if PROFILING_ENABLED
+    this->section = section;
+    startUs = esp_timer_get_time();
+    #else
+    (void)section;
+    #endif
+  }
+
+  ~Scope() {
+    #if PROFILING_ENABLED
+    record(section, static_cast<uint32_t>(esp_timer_get_time() - startUs));
+    #endif
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  #if PROFILING_ENABLED
+  Section section;
+  int64_t startUs;
+  #endif
+};
+
+// Report frames for the window that just ended (windowMs long). Each builder restarts its own
+// counters and returns the frame size, or 0 when it has nothing to report.
+size_t buildSections(uint8_t* out, size_t capacity, uint32_t windowMs);
+// FreeRTOS per-task CPU; 0 when the framework is built without run-time stats.
+size_t buildTasks(uint8_t* out, size_t capacity, uint32_t windowMs);
+size_t buildCoroutines(uint8_t* out, size_t capacity, uint32_t windowMs, const coro::Executor& executor);
+
+// Serial dump of a frame from one of the builders.
+void logFrame(const uint8_t* frame, size_t size);
+
+}  // namespace app::telemetry::profiler
@@ -0,0 +1,377 @@
+#include "sensor_history.h"
+
+#include "app/espnow/slave.h"
+#include "app/history/series_clock.h"
+#include "app/history/timeseries_store.h"
+
+#include <core/mem_tier.h>
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_rtc_time.h>
+
+namespace app::telemetry {
+
+namespace {
+
+static constexpr const char* TAG = "sensor_history";
+static constexpr uint32_t kRingMagic = 0x53484931;       // "SHI1"
+static constexpr uint32_t kAggregateMagic = 0x53484131;  // "SHA1"
+
+struct RtcEntry {
+  uint32_t rtcS;
+  int16_t temperature10;
+  uint16_t humidity10;
+};
+
+struct RtcRing {
+  uint32_t magic;
+  uint32_t magicInverse;
+  uint16_t head;
+  uint16_t count;
+  RtcEntry entries[SensorHistory::kCapacity];
+};
+
+struct RtcAggregate {
+  uint32_t windowEndRtcS;
+  app::espnow::state_binary::SensorAggregateState state;
+};
+
+struct RtcAggregateQueue {
+  uint32_t magic;
+  uint32_t magicInverse;
+  uint16_t head;
+  uint16_t count;
+  RtcAggregate entries[SensorHistory::kAggregateCapacity];
+};
+
+// not cleared on reset; validated in begin()
+RTC_NOINIT_ATTR RtcRing ring;
+RTC_NOINIT_ATTR RtcAggregateQueue aggregates;
+
+uint32_t rtcSeconds() {
+  return static_cast<uint32_t>(esp_rtc_get_time_us() / 1000000ULL);
+}
+
+}  // namespace
+
+SensorHistory sensorHistory;
+
+void SensorHistory::begin() {
+  if (rawEntries == nullptr) {
+    rawEntries = static_cast<RawEntry*>(mem::allocateZeroed(mem::MemClass::History, kMaxRawSamples * sizeof(RawEntry)));
+  }
+
+  const bool aggregatesValid = aggregates.magic == kAggregateMagic && aggregates.magicInverse == ~kAggregateMagic &&
+                              aggregates.head < kAggregateCapacity && aggregates.count <= kAggregateCapacity;
+  if (!aggregatesValid) {
+    aggregates.magic = kAggregateMagic;
+    aggregates.magicInverse = ~kAggregateMagic;
+    aggregates.head = 0;
+    aggregates.count = 0;
+  }
+
+  const bool valid = ring.magic == kRingMagic && ring.magicInverse == ~kRingMagic && ring.head < kCapacity &&
+                     ring.count <= kCapacity;
+  if (!valid) {
+    ring.magic = kRingMagic;
+    ring.magicInverse = ~kRingMagic;
+    ring.head = 0;
+    ring.count = 0;
+    return;
+  }
+
+  // the RTC clock restarts on power-on; entries from "the future" are from a previous power cycle
+  const uint32_t now = rtcSeconds();
+  while (ring.count > 0 && ring.entries[ring.head].rtcS > now) {
+    ring.head = static_cast<uint16_t>((ring.head + 1) % kCapacity);
+    ring.count--;
+  }
+  while (aggregates.count > 0 && aggregates.entries[aggregates.head].windowEndRtcS > now) {
+    aggregates.head = static_cast<uint16_t>((aggregates.head + 1) % kAggregateCapacity);
+    aggregates.count--;
+  }
+
+  counters.restored = ring.count > 0 || aggregates.count > 0;
+  if (counters.restored) {
+    ESP_LOGI(TAG, "Restored %u sensor readings and %u aggregates from RTC memory", ring.count, aggregates.count);
+  }
+}
+
+bool SensorHistory::recordFrame(const uint8_t* payload, size_t payloadSize) {
+  if (app::espnow::state_binary::hasTypeAndSize(payload,
+                                                payloadSize,
+                                                app::espnow::state_binary::Type::SensorAggregate,
+                                                sizeof(app::espnow::state_binary::SensorAggregateState))) {
+    return recordAggregate(*reinterpret_cast<const app::espnow::state_binary::SensorAggregateState*>(payload));
+  }
+
+  if (!app::espnow::state_binary::hasTypeAndSize(payload,
+                                                 payloadSize,
+                                                 app::espnow::state_binary::Type::Sensor,
+                                                 sizeof(app::espnow::state_binary::SensorState))) {
+    return false;
+  }
+
+  const auto* state = reinterpret_cast<const app::espnow::state_binary::SensorState*>(payload);
+  return record(state->temperature10, state->humidity10);
+}
+
+bool SensorHistory::record(int16_t temperature10, uint16_t humidity10) {
+  if (ring.count == kCapacity) {
+    ring.head = static_cast<uint16_t>((ring.head + 1) % kCapacity);
+    ring.count--;
+    counters.overwritten++;
+  }
+
+  RtcEntry& entry = ring.entries[(ring.head + ring.count) % kCapacity];
+  entry.rtcS = rtcSeconds();
+  entry.temperature10 = temperature10;
+  entry.humidity10 = humidity10;
+  ring.count++;
+  counters.recorded++;
+  return true;
+}
+
+bool SensorHistory::recordAggregate(const app::espnow::state_binary::SensorAggregateState& state) {
+  if (aggregates.count == kAggregateCapacity) {
+    aggregates.head = static_cast<uint16_t>((aggregates.head + 1) % kAggregateCapacity);
+    aggregates.count--;
+    counters.overwritten++;
+  }
+
+  // the window end is kept absolute; its age is recomputed when the frame finally goes out
+  RtcAggregate& entry = aggregates.entries[(aggregates.head + aggregates.count) % kAggregateCapacity];
+  const uint32_t now = rtcSeconds();
+  entry.windowEndRtcS = state.windowEndAgeS < now ? now - state.windowEndAgeS : 0;
+  entry.state = state;
+  aggregates.count++;
+  counters.aggregatesQueued++;
+  return true;
+}
+
+void SensorHistory::requestRaw(uint32_t fromAgeS, uint32_t toAgeS) {
+  portENTER_CRITICAL(&requestLock);
+  rawRequested = true;
+  requestedFromAgeS = max(fromAgeS, toAgeS);
+  requestedToAgeS = min(fromAgeS, toAgeS);
+  portEXIT_CRITICAL(&requestLock);
+}
+
+void SensorHistory::collectRawRequest() {
+  portENTER_CRITICAL(&requestLock);
+  const bool requested = rawRequested;
+  const uint32_t fromAgeS = requestedFromAgeS;
+  const uint32_t toAgeS = requestedToAgeS;
+  rawRequested = false;
+  portEXIT_CRITICAL(&requestLock);
+
+  if (!requested) {
+    return;
+  }
+
+  // a newer request replaces one still being answered
+  const uint32_t nowS = app::history::seriesClock.nowS();
+  rawFromS = fromAgeS >= nowS ? 0 : nowS - fromAgeS;
+  rawToS = toAgeS >= nowS ? 0 : nowS - toAgeS;
+  rawActive = true;
+  counters.rawRequests++;
+  loadRawPage(0);
+
+  ESP_LOGI(TAG, "Raw request %lus..%lus ago: %u readings", static_cast<unsigned long>(fromAgeS),
+           static_cast<unsigned long>(toAgeS), static_cast<unsigned>(rawTotal));
+}
+
+// Rescans the fixed range and keeps samples [start, start + kMaxRawSamples); the scan also
+// recounts the whole range, so `remaining` covers every page.
+void SensorHistory::loadRawPage(size_t start) {
+  rawPageStart = start;
+  rawSkip = start;
+  rawCount = 0;
+  rawSent = 0;
+  rawTotal = 0;
+
+#if TIMESERIES_ENABLED
+  rawTotal = app::history::sensorSeries.forEach(
+      rawFromS,
+      rawToS,
+      [](void* context, uint32_t timeS, const int32_t* values) {
+        auto* self = static_cast<SensorHistory*>(context);
+        if (self->rawSkip > 0) {
+          self->rawSkip--;
+          return;
+        }
+        if (self->rawEntries == nullptr || self->rawCount >= kMaxRawSamples) {
+          return;
+        }
+        RawEntry& entry = self->rawEntries[self->rawCount++];
+        entry.timeS = timeS;
+        entry.temperature10 = static_cast<int16_t>(values[0]);
+        entry.humidity10 = static_cast<uint16_t>(values[1]);
+      },
+      this);
+#endif
+}
+
+void SensorHistory::loop(app::espnow::SlaveNode& node, bool liveTrafficPending) {
+  collectRawRequest();
+
+  // live frames go first; history only fills the gaps between them
+  if ((ring.count == 0 && aggregates.count == 0 && !rawActive) || liveTrafficPending || !node.isMasterLinked()) {
+    return;
+  }
+
+  const uint32_t now = millis();
+  if (now - lastReplayMs < kReplayIntervalMs) {
+    return;
+  }
+
+  // the master is waiting on a raw answer; store-and-forward can wait a little longer
+  if (rawActive) {
+    lastReplayMs = now;
+    sendRawBatch(node);
+    return;
+  }
+
+  if (aggregates.count > 0 && (node.masterFeatures() & app::espnow::state_binary::FeatureSensorAggregate) != 0) {
+    lastReplayMs = now;
+    replayAggregate(node);
+    return;
+  }
+
+  if (ring.count == 0 || (node.masterFeatures() & app::espnow::state_binary::FeatureSensorHistory) == 0) {
+    return;
+  }
+  lastReplayMs = now;
+
+  if (replayBatch(node) && ring.count == 0) {
+    ESP_LOGI(TAG, "History replay complete: %lu readings in %lu frames",
+             static_cast<unsigned long>(counters.replayed), static_cast<unsigned long>(counters.frames));
+  }
+}
+
+size_t SensorHistory::entriesPerFrame(const app::espnow::SlaveNode& node) {
+  using app::espnow::state_binary::SensorHistoryEntry;
+  using app::espnow::state_binary::SensorHistoryState;
+
+  const size_t frameBytes = min(node.maxPayloadSize(), kMaxFrameBytes);
+  return min<size_t>((frameBytes - sizeof(SensorHistoryState)) / sizeof(SensorHistoryEntry), 255);
+}
+
+app::espnow::state_binary::SensorHistoryEntry* SensorHistory::beginFrame(
+    app::espnow::state_binary::HistorySource source, size_t count, size_t remaining) {
+  using app::espnow::state_binary::SensorHistoryEntry;
+  using app::espnow::state_binary::SensorHistoryState;
+
+  auto* header = reinterpret_cast<SensorHistoryState*>(frame);
+  *header = {};
+  app::espnow::state_binary::initHeader(header->header, app::espnow::state_binary::Type::SensorHistory);
+  header->count = static_cast<uint8_t>(count);
+  header->source = static_cast<uint8_t>(source);
+  header->remaining = static_cast<uint16_t>(min<size_t>(remaining, UINT16_MAX));
+  return reinterpret_cast<SensorHistoryEntry*>(frame + sizeof(SensorHistoryState));
+}
+
+bool SensorHistory::sendFrame(app::espnow::SlaveNode& node, size_t count) {
+  const size_t bytes = sizeof(app::espnow::state_binary::SensorHistoryState) +
+                       count * sizeof(app::espnow::state_binary::SensorHistoryEntry);
+  if (!node.sendStateBinary(frame, bytes)) {
+    return false;
+  }
+  counters.frames++;
+  return true;
+}
+
+bool SensorHistory::replayBatch(app::espnow::SlaveNode& node) {
+  using app::espnow::state_binary::SensorHistoryEntry;
+
+  const size_t batch = min<size_t>(ring.count, entriesPerFrame(node));
+  SensorHistoryEntry* entries =
+      beginFrame(app::espnow::state_binary::HistorySource::StoreAndForward, batch, ring.count - batch);
+
+  const uint32_t now = rtcSeconds();
+  for (size_t index = 0; index < batch; ++index) {
+    const RtcEntry& source = ring.entries[(ring.head + index) % kCapacity];
+    SensorHistoryEntry entry = {};
+    entry.ageS = now - source.rtcS;
+    entry.temperature10 = source.temperature10;
+    entry.humidity10 = source.humidity10;
+    memcpy(&entries[index], &entry, sizeof(entry));
+  }
+
+  if (!sendFrame(node, batch)) {
+    return false;
+  }
+
+  // entries leave the ring only once the frame is on the air
+  ring.head = static_cast<uint16_t>((ring.head + batch) % kCapacity);
+  ring.count = static_cast<uint16_t>(ring.count - batch);
+  counters.replayed += batch;
+  return true;
+}
+
+bool SensorHistory::replayAggregate(app::espnow::SlaveNode& node) {
+  const RtcAggregate& queued = aggregates.entries[aggregates.head];
+  app::espnow::state_binary::SensorAggregateState state = queued.state;
+  const uint32_t now = rtcSeconds();
+  state.windowEndAgeS = now > queued.windowEndRtcS ? now - queued.windowEndRtcS : 0;
+  if (!node.sendStateBinary(&state, sizeof(state))) {
+    return false;
+  }
+
+  aggregates.head = static_cast<uint16_t>((aggregates.head + 1) % kAggregateCapacity);
+  aggregates.count--;
+  counters.aggregatesReplayed++;
+  return true;
+}
+
+bool SensorHistory::sendRawBatch(app::espnow::SlaveNode& node) {
+  using app::espnow::state_binary::SensorHistoryEntry;
+
+  // an empty range still gets one frame with count 0 so the master is not left waiting
+  const size_t left = rawCount - rawSent;
+  const size_t batch = min<size_t>(left, entriesPerFrame(node));
+  const size_t done = rawPageStart + rawSent + batch;
+  SensorHistoryEntry* entries = beginFrame(app::espnow::state_binary::HistorySource::RawRequest, batch,
+                                           rawTotal > done ? rawTotal - done : 0);
+
+  const uint32_t nowS = app::history::seriesClock.nowS();
+  for (size_t index = 0; index < batch; ++index) {
+    const RawEntry& source = rawEntries[rawSent + index];
+    SensorHistoryEntry entry = {};
+    entry.ageS = nowS - source.timeS;
+    entry.temperature10 = source.temperature10;
+    entry.humidity10 = source.humidity10;
+    memcpy(&entries[index], &entry, sizeof(entry));
+  }
+
+  if (!sendFrame(node, batch)) {
+    return false;
+  }
+
+  rawSent += batch;
+  counters.rawSent += batch;
+  if (rawSent < rawCount) {
+    return true;
+  }
+
+  // next page; an empty one (the range shrank after a file rotation) still ends with a count-0 frame
+  if (rawCount > 0 && rawPageStart + rawCount < rawTotal) {
+    loadRawPage(rawPageStart + rawCount);
+  } else {
+    rawActive = false;
+  }
+  return true;
+}
+
+size_t SensorHistory::pending() const {
+  return ring.count;
+}
+
+HistoryStats SensorHistory::stats() const {
+  HistoryStats out = counters;
+  out.pending = ring.count;
+  out.pendingAggregates = aggregates.count;
+  return out;
+}
+
+}  // namespace app::telemetry
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "app/espnow/protocol.h"
+#include "app/espnow/state_binary.h"
+
+#include <app_config.h>
+
+namespace app::espnow {
+class SlaveNode;
+}
+
+namespace app::telemetry {
+
+struct HistoryStats {
+  uint32_t recorded = 0;
+  uint32_t overwritten = 0;
+  uint32_t replayed = 0;
+  uint32_t frames = 0;
+  uint32_t rawRequests = 0;
+  uint32_t rawSent = 0;
+  uint32_t aggregatesQueued = 0;
+  uint32_t aggregatesReplayed = 0;
+  uint16_t pending = 0;
+  uint16_t pendingAggregates = 0;
+  bool restored = false;  // ring survived a reset
+};
+
+// Store-and-forward ring for sensor readings and aggregates that could not be sent. Lives in RTC
+// memory, so it survives software resets and deep sleep; timestamps come from the RTC clock. Also
+// answers SensorRawReq from the local time-series history, in pages of kMaxRawSamples. Only
+// touched from the network task, except requestRaw() which may be called from the receive callback.
+class SensorHistory {
+ public:
+  static constexpr size_t kCapacity = SENSOR_HISTORY_CAPACITY;
+  static constexpr size_t kAggregateCapacity = SENSOR_AGGREGATE_QUEUE_CAPACITY;
+
+  // After seriesClock.begin().
+  void begin();
+
+  // Keeps an outgoing frame if it is a SensorState or SensorAggregateState; other frames are ignored.
+  bool recordFrame(const uint8_t* payload, size_t payloadSize);
+  bool record(int16_t temperature10, uint16_t humidity10);
+  // Queues a raw-readings answer; the flash read happens later in loop().
+  void requestRaw(uint32_t fromAgeS, uint32_t toAgeS);
+
+  // Sends one frame if the pacing allows: a pending raw answer first, then queued aggregates if
+  // the master takes them, then the ring (oldest first) if the master takes history frames.
+  void loop(app::espnow::SlaveNode& node, bool liveTrafficPending);
+
+  size_t pending() const;
+  HistoryStats stats() const;
+
+ private:
+  static constexpr uint32_t kReplayIntervalMs = SENSOR_HISTORY_REPLAY_INTERVAL_MS;
+  static constexpr size_t kMaxRawSamples = 240;
+  static constexpr size_t kMaxFrameBytes = app::espnow::MAX_LARGE_PAYLOAD_SIZE;
+
+  struct RawEntry {
+    uint32_t timeS;
+    int16_t temperature10;
+    uint16_t humidity10;
+  };
+
+  static size_t entriesPerFrame(const app::espnow::SlaveNode& node);
+  app::espnow::state_binary::SensorHistoryEntry* beginFrame(app::espnow::state_binary::HistorySource source,
+                                                            size_t count,
+                                                            size_t remaining);
+  bool sendFrame(app::espnow::SlaveNode& node, size_t count);
+  bool replayBatch(app::espnow::SlaveNode& node);
+  bool recordAggregate(const app::espnow::state_binary::SensorAggregateState& state);
+  bool replayAggregate(app::espnow::SlaveNode& node);
+  void collectRawRequest();
+  void loadRawPage(size_t start);
+  bool sendRawBatch(app::espnow::SlaveNode& node);
+
+  uint32_t lastReplayMs = 0;
+  HistoryStats counters;
+  uint8_t frame[kMaxFrameBytes] = {0};
+
+  portMUX_TYPE requestLock = portMUX_INITIALIZER_UNLOCKED;
+  bool rawRequested = false;
+  uint32_t requestedFromAgeS = 0;
+  uint32_t requestedToAgeS = 0;
+
+  // the range is fixed in series-clock seconds when the request arrives, so every page sees
+  // the same samples; rawEntries holds samples [rawPageStart, rawPageStart + rawCount)
+  bool rawActive = false;
+  uint32_t rawFromS = 0;
+  uint32_t rawToS = 0;
+  size_t rawTotal = 0;
+  size_t rawPageStart = 0;
+  size_t rawSkip = 0;
+  size_t rawCount = 0;
+  size_t rawSent = 0;
+  RawEntry* rawEntries = nullptr;  // history tier, allocated in begin()
+};
+
+extern SensorHistory sensorHistory;
+
+}  // namespace app::telemetry
@@ -0,0 +1,215 @@
+#include "telemetry_batch.h"
+
+#include "app/espnow/proxy_client.h"
+#include "app/espnow/slave.h"
+#include "app/power/report_policy.h"
+
+#include <esp_log.h>
+
+namespace app::telemetry {
+
+namespace {
+
+static constexpr const char* TAG = "telemetry";
+
+}  // namespace
+
+TelemetryBatch telemetryBatch;
+
+bool TelemetryBatch::isActive() const {
+  #if TELEMETRY_UPLOAD_ENABLED
+  return app::espnow::proxyClient.isTemplateAcked(kTelemetryUploadTemplateId);
+  #else
+  return false;
+  #endif
+}
+
+bool TelemetryBatch::record(ReadingKind kind, int16_t a, int16_t b) {
+  const Reading reading = {
+      .timestampMs = millis(),
+      .kind = static_cast<uint8_t>(kind),
+      .a = a,
+      .b = b,
+  };
+
+  bool dropped = false;
+  portENTER_CRITICAL(&lock);
+  if (count == kCapacity) {
+    // oldest reading makes room; an in-flight upload keeps its own copy of the body
+    head = (head + 1) % kCapacity;
+    count--;
+    if (inflightCount > 0) {
+      inflightCount--;
+    }
+    uploadStats.readingsDropped++;
+    dropped = true;
+  }
+  ring[(head + count) % kCapacity] = reading;
+  count++;
+  portEXIT_CRITICAL(&lock);
+
+  if (dropped) {
+    ESP_LOGW(TAG, "Batch full, dropped oldest reading");
+  }
+  return true;
+}
+
+void TelemetryBatch::loop(app::espnow::SlaveNode& node) {
+  // suspended on critical battery; readings stay queued until the level recovers
+  if (!isActive() || !app::power::reportPolicy.allowed(app::power::Activity::Telemetry)) {
+    return;
+  }
+
+  const uint32_t now = millis();
+  const uint32_t linkSampleIntervalMs =
+      app::power::reportPolicy.interval(app::power::Activity::Telemetry, kLinkSampleIntervalMs);
+  if (node.isMasterLinked() && now - lastLinkSampleMs >= linkSampleIntervalMs) {
+    record(ReadingKind::Link, node.lastMasterRssi(), static_cast<int16_t>(node.channel()));
+    lastLinkSampleMs = now;
+  }
+
+  if (inflight) {
+    if (now - inflightStartedMs < kUploadTimeoutMs) {
+      return;
+    }
+    ESP_LOGW(TAG, "Upload %u timed out, readings kept for retry", inflightId);
+    inflight = false;
+    uploadStats.failedUploads++;
+  }
+
+  portENTER_CRITICAL(&lock);
+  const size_t pending = count;
+  portEXIT_CRITICAL(&lock);
+
+  if (pending == 0 || !node.isMasterLinked()) {
+    return;
+  }
+
+  if (pending < kBatchSize &&
+      now - lastFlushMs < app::power::reportPolicy.interval(app::power::Activity::Telemetry, kFlushIntervalMs)) {
+    return;
+  }
+
+  flush(node, now);
+}
+
+void TelemetryBatch::flush(app::espnow::SlaveNode& node, uint32_t now) {
+  Reading batch[kBatchSize];
+  size_t batchCount = 0;
+
+  portENTER_CRITICAL(&lock);
+  batchCount = min(count, kBatchSize);
+  for (size_t index = 0; index < batchCount; ++index) {
+    batch[index] = ring[(head + index) % kCapacity];
+  }
+  portEXIT_CRITICAL(&lock);
+
+  const size_t bodyLen = serialize(batch, batchCount, now);
+  if (bodyLen == 0) {
+    ESP_LOGW(TAG, "Batch body overflow, skipping flush");
+    return;
+  }
+
+  const uint16_t uploadId = nextUploadId++;
+  size_t frames = 0;
+  size_t airBytes = 0;
+  lastFlushMs = now;
+  if (!app::espnow::proxyClient.upload(node,
+                                       uploadId,
+                                       kTelemetryUploadTemplateId,
+                                       app::espnow::state_binary::ContentType::Json,
+                                       reinterpret_cast<const uint8_t*>(body),
+                                       bodyLen,
+                                       &frames,
+                                       &airBytes)) {
+    ESP_LOGW(TAG, "Upload %u failed to send", uploadId);
+    uploadStats.failedUploads++;
+    return;
+  }
+
+  portENTER_CRITICAL(&lock);
+  inflight = true;
+  inflightId = uploadId;
+  inflightCount = batchCount;
+  inflightStartedMs = now;
+  uploadStats.bodyBytes += bodyLen;
+  uploadStats.airBytes += airBytes;
+  portEXIT_CRITICAL(&lock);
+
+  ESP_LOGI(TAG,
+           "Upload %u: %u readings, %u body bytes, %u frames, %.1f air bytes/reading",
+           uploadId,
+           static_cast<unsigned>(batchCount),
+           static_cast<unsigned>(bodyLen),
+           static_cast<unsigned>(frames),
+           static_cast<float>(airBytes) / static_cast<float>(batchCount));
+}
+
+size_t TelemetryBatch::serialize(const Reading* readings, size_t readingCount, uint32_t now) {
+  // {"d":"<device>","r":[[kind,ageS,a,b],...]}
+  int written = snprintf(body, sizeof(body), "{\"d\":\"%s\",\"r\":[", DEVICE_NAME);
+  if (written < 0 || static_cast<size_t>(written) >= sizeof(body)) {
+    return 0;
+  }
+  size_t pos = static_cast<size_t>(written);
+
+  for (size_t index = 0; index < readingCount; ++index) {
+    const Reading& reading = readings[index];
+    written = snprintf(body + pos,
+                       sizeof(body) - pos,
+                       "%s[%u,%lu,%d,%d]",
+                       index == 0 ? "" : ",",
+                       reading.kind,
+                       static_cast<unsigned long>((now - reading.timestampMs) / 1000UL),
+                       reading.a,
+                       reading.b);
+    if (written < 0 || pos + static_cast<size_t>(written) >= sizeof(body)) {
+      return 0;
+    }
+    pos += static_cast<size_t>(written);
+  }
+
+  written = snprintf(body + pos, sizeof(body) - pos, "]}");
+  if (written < 0 || pos + static_cast<size_t>(written) >= sizeof(body)) {
+    return 0;
+  }
+  return pos + static_cast<size_t>(written);
+}
+
+void TelemetryBatch::handleUploadResult(const app::espnow::state_binary::ProxyUploadResultCommand& result) {
+  portENTER_CRITICAL(&lock);
+  if (!inflight || result.uploadId != inflightId) {
+    portEXIT_CRITICAL(&lock);
+    ESP_LOGW(TAG, "Stale upload result id=%u", result.uploadId);
+    return;
+  }
+
+  const bool accepted = result.ok == 1 && result.code >= 200 && result.code < 300;
+  if (accepted) {
+    const size_t released = min(inflightCount, count);
+    head = (head + released) % kCapacity;
+    count -= released;
+    uploadStats.uploads++;
+    uploadStats.readingsUploaded += released;
+  } else {
+    uploadStats.failedUploads++;
+  }
+  inflight = false;
+  inflightCount = 0;
+  portEXIT_CRITICAL(&lock);
+
+  if (accepted) {
+    ESP_LOGI(TAG, "Upload %u accepted (HTTP %d)", result.uploadId, result.code);
+  } else {
+    ESP_LOGW(TAG, "Upload %u rejected ok=%u code=%d, readings kept for retry", result.uploadId, result.ok, result.code);
+  }
+}
+
+UploadStats TelemetryBatch::stats() const {
+  portENTER_CRITICAL(&lock);
+  const UploadStats snapshot = uploadStats;
+  portEXIT_CRITICAL(&lock);
+  return snapshot;
+}
+
+}  // namespace app::telemetry
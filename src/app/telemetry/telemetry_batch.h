@@ -0,0 +1,86 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+#include "app/espnow/state_binary.h"
+
+#include <app_config.h>
+
+namespace app::espnow {
+class SlaveNode;
+}
+
+namespace app::telemetry {
+
+static constexpr uint8_t kTelemetryUploadTemplateId = 2;
+
+enum class ReadingKind : uint8_t {
+  Sensor = 1,   // a = temperature * 10, b = humidity * 10
+  Battery = 2,  // a = level %, b = voltage mV
+  Link = 3,     // a = master RSSI dBm, b = channel
+};
+
+struct Reading {
+  uint32_t timestampMs;
+  uint8_t kind;
+  int16_t a;
+  int16_t b;
+};
+
+struct UploadStats {
+  uint32_t uploads = 0;
+  uint32_t failedUploads = 0;
+  uint32_t readingsUploaded = 0;
+  uint32_t readingsDropped = 0;
+  uint32_t bodyBytes = 0;
+  uint32_t airBytes = 0;
+};
+
+// Accumulates readings and ships them as one JSON body through the master proxy POST
+// (ProxyUploadState + ProxyBodyChunkState) instead of one frame per reading. Readings are only
+// released after a 2xx ProxyUploadResultCommand. record() may be called from any task; loop()
+// and handleUploadResult() from the network side.
+class TelemetryBatch {
+ public:
+  TelemetryBatch() = default;
+
+  // True when uploads are configured and the master acknowledged the upload template.
+  bool isActive() const;
+  bool record(ReadingKind kind, int16_t a, int16_t b);
+  void loop(app::espnow::SlaveNode& node);
+  void handleUploadResult(const app::espnow::state_binary::ProxyUploadResultCommand& result);
+
+  UploadStats stats() const;
+
+ private:
+  static constexpr size_t kBatchSize = TELEMETRY_BATCH_SIZE;
+  static constexpr size_t kCapacity = kBatchSize * 2;
+  static constexpr size_t kBodyBytes = 32 + kBatchSize * 32;
+  static constexpr uint32_t kFlushIntervalMs = TELEMETRY_FLUSH_INTERVAL_MS;
+  static constexpr uint32_t kUploadTimeoutMs = 20000;
+  static constexpr uint32_t kLinkSampleIntervalMs = DHT_READ_INTERVAL_MS;
+
+  void flush(app::espnow::SlaveNode& node, uint32_t now);
+  size_t serialize(const Reading* readings, size_t count, uint32_t now);
+
+  mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+  Reading ring[kCapacity] = {};
+  size_t head = 0;
+  size_t count = 0;
+
+  bool inflight = false;
+  uint16_t inflightId = 0;
+  size_t inflightCount = 0;
+  uint32_t inflightStartedMs = 0;
+  uint16_t nextUploadId = 1;
+  uint32_t lastFlushMs = 0;
+  uint32_t lastLinkSampleMs = 0;
+
+  char body[kBodyBytes] = {0};
+  UploadStats uploadStats;
+};
+
+extern TelemetryBatch telemetryBatch;
+
+}  // namespace app::telemetry
@@ -25,8 +25,7 @@ struct Coordinates {
 
 bool getCoordinates(Area area, Coordinates& out);
 const char* toString(Area area);
-String buildCurrentWeatherUrl(Area area);
-bool saveLastReport(const String& report);
-bool loadLastReport(String& report);
+// Removes the proxy request text older firmware kept on flash (key-value log and the file before it).
+void dropLastReport();
 
 }  // namespace app::weather
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include <utility>
+
+#include "app/espnow/state_binary.h"
+#include "open_meteo_locations.h"
+
+namespace app::weather {
+
+// Area coordinates in 1e-7 degree fixed point, indexed by Area.
+struct CoordinatesE7 {
+  int32_t latitude;
+  int32_t longitude;
+};
+
+inline constexpr CoordinatesE7 kAreaCoordinatesE7[] = {
+    {-61805000, 1068283000},  // JakartaPusat
+    {-61905425, 1067602213},  // JakartaBarat
+    {-62250000, 1069004000},  // JakartaTimur
+    {-61380000, 1068636000},  // JakartaUtara
+    {-62615000, 1068106000},  // JakartaSelatan
+    {-65950380, 1068166350},  // Bogor
+    {-64024840, 1067942410},  // Depok
+    {-61783060, 1066318890},  // Tangerang
+    {-62415860, 1069924160},  // Bekasi
+    {5070680, 1014477770},    // Pekanbaru
+    {21618470, 1008117370},   // BaganJaya
+};
+
+inline constexpr size_t kAreaCount = sizeof(kAreaCoordinatesE7) / sizeof(kAreaCoordinatesE7[0]);
+static_assert(static_cast<size_t>(Area::BaganJaya) + 1 == kAreaCount, "Area enum and coordinate table out of sync");
+
+inline constexpr char kOpenMeteoForecastBase[] = "https://api.open-meteo.com/v1/forecast";
+
+// Template registered with the master once per link; requests then carry only lat/lon.
+inline constexpr uint8_t kCurrentWeatherTemplateId = 1;
+inline constexpr char kCurrentWeatherTemplate[] =
+    "https://api.open-meteo.com/v1/forecast?latitude={0}&longitude={1}&current_weather=true";
+
+namespace detail {
+
+constexpr size_t appendText(char* out, size_t capacity, size_t pos, const char* text) {
+  while (*text != '\0') {
+    if (pos + 1 < capacity) {
+      out[pos] = *text;
+    }
+    pos++;
+    text++;
+  }
+  return pos;
+}
+
+// Formats a 1e-7 fixed-point value the same way String(double, 7) does.
+constexpr size_t appendFixedE7(char* out, size_t capacity, size_t pos, int32_t value) {
+  int64_t magnitude = value;
+  if (magnitude < 0) {
+    pos = appendText(out, capacity, pos, "-");
+    magnitude = -magnitude;
+  }
+
+  int64_t whole = magnitude / 10000000;
+  int64_t fraction = magnitude % 10000000;
+
+  char wholeText[24] = {};
+  size_t count = 0;
+  do {
+    wholeText[count++] = static_cast<char>('0' + whole % 10);
+    whole /= 10;
+  } while (whole > 0);
+  for (size_t index = 0; index < count / 2; ++index) {
+    const char swapped = wholeText[index];
+    wholeText[index] = wholeText[count - 1 - index];
+    wholeText[count - 1 - index] = swapped;
+  }
+  pos = appendText(out, capacity, pos, wholeText);
+
+  char fractionText[9] = {'.', '0', '0', '0', '0', '0', '0', '0', '\0'};
+  for (size_t index = 7; index > 0; --index) {
+    fractionText[index] = static_cast<char>('0' + fraction % 10);
+    fraction /= 10;
+  }
+  return appendText(out, capacity, pos, fractionText);
+}
+
+// Writes the current-weather URL into `out` (truncated to capacity) and returns its full length.
+constexpr size_t formatCurrentWeatherUrl(char* out, size_t capacity, const CoordinatesE7& coordinates) {
+  size_t pos = appendText(out, capacity, 0, kOpenMeteoForecastBase);
+  pos = appendText(out, capacity, pos, "?latitude=");
+  pos = appendFixedE7(out, capacity, pos, coordinates.latitude);
+  pos = appendText(out, capacity, pos, "&longitude=");
+  pos = appendFixedE7(out, capacity, pos, coordinates.longitude);
+  pos = appendText(out, capacity, pos, "&current_weather=true");
+  if (capacity > 0) {
+    out[pos < capacity ? pos : capacity - 1] = '\0';
+  }
+  return pos;
+}
+
+constexpr app::espnow::state_binary::ProxyReqState makeCurrentWeatherRequest(const CoordinatesE7& coordinates) {
+  app::espnow::state_binary::ProxyReqState request = {};
+  app::espnow::state_binary::initHeader(request.header, app::espnow::state_binary::Type::ProxyReq);
+  request.method = static_cast<uint8_t>(app::espnow::state_binary::HttpMethod::Get);
+  formatCurrentWeatherUrl(request.url, sizeof(request.url), coordinates);
+  return request;
+}
+
+constexpr app::espnow::state_binary::ProxyTemplateReqState makeCurrentWeatherTemplateRequest(
+    const CoordinatesE7& coordinates) {
+  app::espnow::state_binary::ProxyTemplateReqState request = {};
+  app::espnow::state_binary::initHeader(request.header, app::espnow::state_binary::Type::ProxyTemplateReq);
+  request.templateId = kCurrentWeatherTemplateId;
+  request.paramCount = 2;
+  request.params[0] = coordinates.latitude;
+  request.params[1] = coordinates.longitude;
+  return request;
+}
+
+template <size_t... Index>
+constexpr std::array<app::espnow::state_binary::ProxyReqState, sizeof...(Index)> makeCurrentWeatherRequests(
+    std::index_sequence<Index...>) {
+  return {{makeCurrentWeatherRequest(kAreaCoordinatesE7[Index])...}};
+}
+
+template <size_t... Index>
+constexpr std::array<app::espnow::state_binary::ProxyTemplateReqState, sizeof...(Index)>
+makeCurrentWeatherTemplateRequests(std::index_sequence<Index...>) {
+  return {{makeCurrentWeatherTemplateRequest(kAreaCoordinatesE7[Index])...}};
+}
+
+constexpr bool allCurrentWeatherUrlsFit() {
+  for (const auto& coordinates : kAreaCoordinatesE7) {
+    if (formatCurrentWeatherUrl(nullptr, 0, coordinates) >= sizeof(app::espnow::state_binary::ProxyReqState::url)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace detail
+
+static_assert(detail::allCurrentWeatherUrlsFit(), "Current weather URL does not fit ProxyReqState::url");
+
+// Ready-to-send proxy requests, built at compile time and kept in flash.
+inline constexpr auto kCurrentWeatherRequests =
+    detail::makeCurrentWeatherRequests(std::make_index_sequence<kAreaCount>{});
+
+inline constexpr auto kCurrentWeatherTemplateRequests =
+    detail::makeCurrentWeatherTemplateRequests(std::make_index_sequence<kAreaCount>{});
+
+inline size_t areaIndexOrDefault(Area area) {
+  const size_t index = static_cast<size_t>(area);
+  return index < kAreaCount ? index : static_cast<size_t>(Area::JakartaPusat);
+}
+
+// Returns the flash-resident request for `area`, falling back to Jakarta Pusat for unknown areas.
+inline const app::espnow::state_binary::ProxyReqState& currentWeatherRequest(Area area) {
+  return kCurrentWeatherRequests[areaIndexOrDefault(area)];
+}
+
+inline const app::espnow::state_binary::ProxyTemplateReqState& currentWeatherTemplateRequest(Area area) {
+  return kCurrentWeatherTemplateRequests[areaIndexOrDefault(area)];
+}
+
+}  // namespace app::weather
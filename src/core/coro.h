@@ -0,0 +1,261 @@
+#pragma once
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Cooperative coroutine executor: several long-running loops share one FreeRTOS task (and one
+// stack). A coroutine suspends with co_await delay(ms), yield() or until(condition, context); only
+// its locals live across suspension, in a frame whose size is recorded per coroutine. Frames come
+// from a fixed arena when one is set (useFrameArena) and from the heap otherwise.
+// Depends only on the standard library, so it also runs on the host.
+namespace coro {
+
+using Clock = uint32_t (*)();
+using Condition = bool (*)(void* context);
+
+struct FrameArena {
+  uint8_t* base = nullptr;
+  size_t capacity = 0;
+  size_t used = 0;
+  size_t last = 0;       // offset of the newest frame, so a failed spawn hands its bytes back
+  uint32_t overflows = 0;  // frames that did not fit and went to the heap
+
+  bool owns(const void* frame) const {
+    const auto* bytes = static_cast<const uint8_t*>(frame);
+    return base != nullptr && bytes >= base && bytes < base + capacity;
+  }
+};
+
+// frames are created from the spawning task only, so a plain static is enough
+inline FrameArena frameArena;
+
+// Frames created after this call are carved from `buffer`. Executor coroutines run for the whole
+// program, so space is only reclaimed for the newest frame.
+inline void useFrameArena(void* buffer, size_t bytes) {
+  frameArena = {};
+  frameArena.base = static_cast<uint8_t*>(buffer);
+  frameArena.capacity = bytes;
+}
+
+class Task {
+ public:
+  struct promise_type {
+    enum class Wait : uint8_t { Ready, Delay, Until };
+
+    Wait wait = Wait::Ready;
+    uint32_t delayMs = 0;
+    Condition condition = nullptr;
+    void* context = nullptr;
+    size_t frameBytes = lastFrameBytes;
+
+    inline static size_t lastFrameBytes = 0;
+
+    static void* operator new(size_t size) noexcept {
+      lastFrameBytes = size;
+      FrameArena& arena = frameArena;
+      if (arena.base != nullptr) {
+        const size_t aligned = (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        if (arena.capacity - arena.used >= aligned) {
+          arena.last = arena.used;
+          arena.used += aligned;
+          return arena.base + arena.last;
+        }
+        arena.overflows++;
+      }
+      return ::operator new(size, std::nothrow);
+    }
+    static void operator delete(void* frame) noexcept {
+      FrameArena& arena = frameArena;
+      if (!arena.owns(frame)) {
+        ::operator delete(frame);
+      } else if (static_cast<uint8_t*>(frame) == arena.base + arena.last) {
+        arena.used = arena.last;
+      }
+    }
+    static Task get_return_object_on_allocation_failure() noexcept { return Task(nullptr); }
+
+    Task get_return_object() noexcept { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { abort(); }
+  };
+
+  using Handle = std::coroutine_handle<promise_type>;
+
+  Task() = default;
+  explicit Task(Handle handle) : handle(handle) {}
+  Task(Task&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      reset();
+      handle = other.handle;
+      other.handle = nullptr;
+    }
+    return *this;
+  }
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+  ~Task() { reset(); }
+
+  bool valid() const { return static_cast<bool>(handle); }
+  Handle release() {
+    Handle out = handle;
+    handle = nullptr;
+    return out;
+  }
+
+ private:
+  void reset() {
+    if (handle) {
+      handle.destroy();
+      handle = nullptr;
+    }
+  }
+
+  Handle handle = nullptr;
+};
+
+struct Delay {
+  uint32_t ms;
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(Task::Handle handle) const noexcept {
+    handle.promise().wait = Task::promise_type::Wait::Delay;
+    handle.promise().delayMs = ms;
+  }
+  void await_resume() const noexcept {}
+};
+
+struct Until {
+  Condition condition;
+  void* context;
+
+  bool await_ready() const noexcept { return condition(context); }
+  void await_suspend(Task::Handle handle) const noexcept {
+    handle.promise().wait = Task::promise_type::Wait::Until;
+    handle.promise().condition = condition;
+    handle.promise().context = context;
+  }
+  void await_resume() const noexcept {}
+};
+
+// Resumes after at least `ms` milliseconds.
+inline Delay delay(uint32_t ms) { return Delay{ms}; }
+// Lets every other ready coroutine run once.
+inline Delay yield() { return Delay{0}; }
+// Resumes once condition(context) is true; checked on every executor pass.
+inline Until until(Condition condition, void* context = nullptr) { return Until{condition, context}; }
+
+class Executor {
+ public:
+  // app_task spawns up to eight (static_config::kCoroutineCount); the spare slots cost a few
+  // dozen bytes each
+  static constexpr size_t kMaxTasks = 10;
+
+  struct TaskInfo {
+    const char* name = nullptr;
+    size_t frameBytes = 0;
+    uint32_t resumes = 0;
+    uint32_t busyUs = 0;  // time spent inside resume(), only counted with a busy clock
+    bool done = false;
+  };
+
+  // maxIdleMs bounds the returned sleep while a coroutine waits on a condition.
+  Executor(Clock clock, uint32_t maxIdleMs) : clock(clock), maxIdleMs(maxIdleMs) {}
+  Executor(const Executor&) = delete;
+  Executor& operator=(const Executor&) = delete;
+
+  // Microsecond clock for per-coroutine busy time (profiling); nullptr turns it off.
+  void setBusyClock(Clock microsClock) { busyClock = microsClock; }
+
+  ~Executor() {
+    for (size_t index = 0; index < count; ++index) {
+      slots[index].handle.destroy();
+    }
+  }
+
+  bool spawn(const char* name, Task&& task) {
+    if (count == kMaxTasks || !task.valid()) {
+      return false;
+    }
+
+    Slot& slot = slots[count++];
+    slot.handle = task.release();
+    slot.info = {};
+    slot.info.name = name;
+    slot.info.frameBytes = slot.handle.promise().frameBytes;
+    slot.wakeAtMs = clock();
+    return true;
+  }
+
+  // Resumes every coroutine that is due and returns how long the caller may sleep.
+  uint32_t runOnce() {
+    uint32_t idleMs = maxIdleMs;
+    for (size_t index = 0; index < count; ++index) {
+      Slot& slot = slots[index];
+      if (slot.info.done) {
+        continue;
+      }
+
+      auto& promise = slot.handle.promise();
+      const uint32_t now = clock();
+      const bool ready = promise.wait == Task::promise_type::Wait::Until
+                             ? promise.condition(promise.context)
+                             : static_cast<int32_t>(now - slot.wakeAtMs) >= 0;
+      if (ready) {
+        promise.wait = Task::promise_type::Wait::Ready;
+        promise.delayMs = 0;
+        const uint32_t startUs = busyClock != nullptr ? busyClock() : 0;
+        slot.handle.resume();
+        if (busyClock != nullptr) {
+          slot.info.busyUs += busyClock() - startUs;
+        }
+        slot.info.resumes++;
+        if (slot.handle.done()) {
+          slot.info.done = true;
+          continue;
+        }
+        slot.wakeAtMs = clock() + promise.delayMs;
+      }
+
+      if (promise.wait != Task::promise_type::Wait::Until) {
+        const int32_t remaining = static_cast<int32_t>(slot.wakeAtMs - clock());
+        if (remaining <= 0) {
+          idleMs = 0;
+        } else if (static_cast<uint32_t>(remaining) < idleMs) {
+          idleMs = static_cast<uint32_t>(remaining);
+        }
+      }
+    }
+    return idleMs;
+  }
+
+  size_t size() const { return count; }
+  const TaskInfo& info(size_t index) const { return slots[index].info; }
+
+  size_t frameBytes() const {
+    size_t total = 0;
+    for (size_t index = 0; index < count; ++index) {
+      total += slots[index].info.frameBytes;
+    }
+    return total;
+  }
+
+ private:
+  struct Slot {
+    Task::Handle handle = nullptr;
+    uint32_t wakeAtMs = 0;
+    TaskInfo info;
+  };
+
+  Clock clock;
+  Clock busyClock = nullptr;
+  uint32_t maxIdleMs;
+  Slot slots[kMaxTasks];
+  size_t count = 0;
+};
+
+}  // namespace coro
@@ -3,60 +3,126 @@
 #include <LittleFS.h>
 #include <WString.h>
 #include <SpiJsonDocument.h>
+#if !BOARD_HAS_PSRAM
+#include <ArenaJsonDocument.h>
+#endif
 
+// internal RAM reserved for the document on boards without PSRAM; bigger documents spill to the heap
+#ifndef DATASTORE_ARENA_BYTES
+#define DATASTORE_ARENA_BYTES 4096
+#endif
+
+// JSON document persisted under /data/<name>.json. Parsed straight from the file stream and
+// written to <name>.json.tmp then renamed over the original, so a reset mid-save leaves the old
+// copy intact. save() only touches flash when the document changed.
+// Without PSRAM the document lives in one DATASTORE_ARENA_BYTES block (ArenaJsonDocument) that
+// every load() and save(document) rewinds, so reloading does not scatter small blocks through the
+// internal heap; in-place edits bump the arena until the next rewind.
 class DataStore {
 public:
   DataStore(){};
   ~DataStore(){};
-  
-  inline void load(const String& filename = "") {
-    if (!LittleFS.exists("/data/")) {
+
+  // Returns false when the file is missing or unreadable; data() is then empty.
+  inline bool load(const String& filename = "") {
+    if (!LittleFS.exists("/data")) {
       LittleFS.mkdir("/data");
     }
 
-    if (filename.isEmpty()) {
-      _file = LittleFS.open("/data/_default.json", "r+");
-    }
-    else {
-      _file = LittleFS.open("/data/" + filename + ".json", "r+");
+    _path = "/data/" + (filename.isEmpty() ? String("_default") : filename) + ".json";
+    resetDocument();
+    _dirty = false;
+
+    // a leftover temp file is an interrupted save; the original is still the valid copy
+    const String tempPath = _path + ".tmp";
+    if (LittleFS.exists(tempPath)) {
+      LittleFS.remove(tempPath);
     }
 
-    if (!_file) {
-      _data = SpiJsonDocument();
-      _file.close();
-      return;
+    File file = LittleFS.open(_path, "r");
+    if (!file) {
+      return false;
     }
 
-    auto buffer = (uint8_t*) heap_caps_malloc(1024, MALLOC_CAP_SPIRAM | MALLOC_CAP_DEFAULT);
-    String data = "";
-    while (_file.available()){
-      memset(buffer, 0, 1024);
-      size_t readBytes = _file.read(buffer, 1024);
-      data += String((const char*) buffer, readBytes);
+    const DeserializationError error = deserializeJson(_data, file);
+    file.close();
+    if (error) {
+      ESP_LOGW("datastore", "%s: %s", _path.c_str(), error.c_str());
+      resetDocument();
+      return false;
     }
-    delete[] buffer;
+    return true;
+  }
 
-    _file.close();
-    deserializeJson(_data, data);
+  inline const JsonDocument& data() const { return _data; }
+
+  // Mutable access; the document is written on the next save().
+  inline JsonDocument& edit() {
+    _dirty = true;
+    return _data;
   }
 
-  inline SpiJsonDocument data() const { return _data; }
+  inline bool isDirty() const { return _dirty; }
 
-  inline bool save(SpiJsonDocument data) {
-    if (LittleFS.exists(_file.name())) {
-      LittleFS.remove(_file.name());
+  // Replaces the document and writes it if it differs from what is stored.
+  inline bool save(const JsonDocument& data) {
+    if (_data.as<JsonVariantConst>() == data.as<JsonVariantConst>()) {
+      return save();
+    }
+    resetDocument();
+    if (!_data.set(data)) {
+      return false;
     }
+    _dirty = true;
+    return save();
+  }
 
-    data.shrinkToFit();
-    String jsonRaw = data.as<String>();
-    _file.write((uint8_t*)jsonRaw.c_str(), jsonRaw.length());
+  inline bool save() {
+    if (!_dirty) {
+      return true;
+    }
+    if (_path.isEmpty()) {
+      return false;
+    }
+
+    const String tempPath = _path + ".tmp";
+    File file = LittleFS.open(tempPath, "w");
+    if (!file) {
+      return false;
+    }
+
+    const size_t expected = measureJson(_data);
+    const size_t written = serializeJson(_data, file);
+    file.close();
+    if (written != expected || !LittleFS.rename(tempPath, _path)) {
+      LittleFS.remove(tempPath);
+      return false;
+    }
 
-    return _data.set(data);
+    _dirty = false;
+    return true;
   }
 
+#if !BOARD_HAS_PSRAM
+  inline const ArenaStats& arenaStats() const { return _data.arenaStats(); }
+#endif
+
 private:
-  File _file;
+  inline void resetDocument() {
+#if BOARD_HAS_PSRAM
+    _data.clear();
+#else
+    _data.release();
+#endif
+  }
+
+  String _path;
+#if BOARD_HAS_PSRAM
   SpiJsonDocument _data;
+#else
+  ArenaJsonDocument _data{DATASTORE_ARENA_BYTES, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT};
+#endif
+  bool _dirty = false;
 
 protected:
-};
\ No newline at end of file
+};
@@ -0,0 +1,182 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_memory_utils.h>
+#include <freertos/FreeRTOS.h>
+
+// Memory tiers: every long-lived buffer names what it is used for, and the board decides where
+// that class lives. Hot paths (radio frames, queues touched from callbacks) stay in internal
+// RAM; bulk and history buffers go to PSRAM when the board has it and fall back to internal RAM
+// otherwise. Static buffers are accounted to their class with place(). Override a class per
+// board with -DMEM_TIER_<CLASS>_CAPS=... in platformio.ini.
+
+#define MEM_CAPS_INTERNAL (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#define MEM_CAPS_DMA (MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA | MALLOC_CAP_8BIT)
+#define MEM_CAPS_PSRAM (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+
+#ifndef MEM_TIER_FRAME_CAPS
+#define MEM_TIER_FRAME_CAPS MEM_CAPS_INTERNAL
+#endif
+#ifndef MEM_TIER_QUEUE_CAPS
+#define MEM_TIER_QUEUE_CAPS MEM_CAPS_INTERNAL
+#endif
+#ifndef MEM_TIER_DMA_CAPS
+#define MEM_TIER_DMA_CAPS MEM_CAPS_DMA
+#endif
+
+#if BOARD_HAS_PSRAM
+#ifndef MEM_TIER_BULK_CAPS
+#define MEM_TIER_BULK_CAPS MEM_CAPS_PSRAM
+#endif
+#ifndef MEM_TIER_HISTORY_CAPS
+#define MEM_TIER_HISTORY_CAPS MEM_CAPS_PSRAM
+#endif
+#else
+#ifndef MEM_TIER_BULK_CAPS
+#define MEM_TIER_BULK_CAPS MEM_CAPS_INTERNAL
+#endif
+#ifndef MEM_TIER_HISTORY_CAPS
+#define MEM_TIER_HISTORY_CAPS MEM_CAPS_INTERNAL
+#endif
+#endif
+// plain malloc/new at or above this size may land in PSRAM; smaller ones stay internal
+#ifndef MEM_TIER_EXTMEM_THRESHOLD
+#define MEM_TIER_EXTMEM_THRESHOLD 4096
+#endif
+
+namespace mem {
+
+enum class MemClass : uint8_t {
+  Frame = 0,  // radio RX/TX frames, latency sensitive
+  Queue,      // FreeRTOS queues / ring buffers shared with callbacks
+  Dma,        // buffers handed to peripherals
+  Bulk,       // proxy response reassembly, forecasts
+  History,    // replay and raw-history buffers
+  Count,
+};
+
+struct ClassStats {
+  size_t liveBytes = 0;
+  size_t peakBytes = 0;
+  uint32_t allocations = 0;
+  uint32_t failures = 0;
+  uint32_t fallbacks = 0;  // not in the class's memory: PSRAM missing or full, or static storage elsewhere
+};
+
+inline constexpr size_t kClassCount = static_cast<size_t>(MemClass::Count);
+inline constexpr uint32_t kClassCaps[kClassCount] = {
+    MEM_TIER_FRAME_CAPS, MEM_TIER_QUEUE_CAPS, MEM_TIER_DMA_CAPS, MEM_TIER_BULK_CAPS, MEM_TIER_HISTORY_CAPS,
+};
+inline constexpr const char* kClassNames[kClassCount] = {"frame", "queue", "dma", "bulk", "history"};
+
+inline portMUX_TYPE statsLock = portMUX_INITIALIZER_UNLOCKED;
+inline ClassStats classStats[kClassCount];
+
+inline uint32_t caps(MemClass memClass) {
+  return kClassCaps[static_cast<size_t>(memClass)];
+}
+
+inline const char* name(MemClass memClass) {
+  return kClassNames[static_cast<size_t>(memClass)];
+}
+
+// Accounts memory the class owns but did not get from allocate().
+inline void record(MemClass memClass, size_t bytes, bool fallback = false) {
+  portENTER_CRITICAL(&statsLock);
+  ClassStats& stats = classStats[static_cast<size_t>(memClass)];
+  stats.allocations++;
+  stats.fallbacks += fallback ? 1 : 0;
+  stats.liveBytes += bytes;
+  stats.peakBytes = stats.liveBytes > stats.peakBytes ? stats.liveBytes : stats.peakBytes;
+  portEXIT_CRITICAL(&statsLock);
+}
+
+inline void* allocate(MemClass memClass, size_t size) {
+  void* pointer = heap_caps_malloc(size, caps(memClass));
+  bool fallback = false;
+  if (pointer == nullptr && (caps(memClass) & MALLOC_CAP_SPIRAM) != 0) {
+    pointer = heap_caps_malloc(size, MEM_CAPS_INTERNAL);
+    fallback = pointer != nullptr;
+  }
+
+  if (pointer == nullptr) {
+    portENTER_CRITICAL(&statsLock);
+    classStats[static_cast<size_t>(memClass)].failures++;
+    portEXIT_CRITICAL(&statsLock);
+    ESP_LOGE("mem_tier", "%s: %u bytes failed", name(memClass), static_cast<unsigned>(size));
+    return nullptr;
+  }
+
+  record(memClass, heap_caps_get_allocated_size(pointer), fallback);
+  return pointer;
+}
+
+inline void* allocateZeroed(MemClass memClass, size_t size) {
+  void* pointer = allocate(memClass, size);
+  if (pointer != nullptr) {
+    memset(pointer, 0, size);
+  }
+  return pointer;
+}
+
+inline void release(MemClass memClass, void* pointer) {
+  if (pointer == nullptr) {
+    return;
+  }
+  const size_t bytes = heap_caps_get_allocated_size(pointer);
+  heap_caps_free(pointer);
+
+  portENTER_CRITICAL(&statsLock);
+  ClassStats& stats = classStats[static_cast<size_t>(memClass)];
+  stats.liveBytes = stats.liveBytes > bytes ? stats.liveBytes - bytes : 0;
+  portEXIT_CRITICAL(&statsLock);
+}
+
+// True when `pointer` sits in memory the class's caps allow.
+inline bool inClassMemory(MemClass memClass, const void* pointer) {
+  const uint32_t wanted = caps(memClass);
+  if ((wanted & MALLOC_CAP_DMA) != 0) {
+    return esp_ptr_dma_capable(pointer);
+  }
+  if ((wanted & MALLOC_CAP_SPIRAM) != 0) {
+    return esp_ptr_external_ram(pointer);
+  }
+  return esp_ptr_internal(pointer);
+}
+
+// Static storage owned by a class (queue and ring buffer storage created before the heap is
+// used). Counted like an allocation; storage outside the class's memory counts as a fallback.
+inline void place(MemClass memClass, const void* storage, size_t bytes) {
+  record(memClass, bytes, !inClassMemory(memClass, storage));
+}
+
+inline ClassStats stats(MemClass memClass) {
+  portENTER_CRITICAL(&statsLock);
+  const ClassStats out = classStats[static_cast<size_t>(memClass)];
+  portEXIT_CRITICAL(&statsLock);
+  return out;
+}
+
+// Call once at boot, before buffers are allocated.
+inline void begin() {
+  #if BOARD_HAS_PSRAM
+  heap_caps_malloc_extmem_enable(MEM_TIER_EXTMEM_THRESHOLD);
+  #endif
+}
+
+inline void logUsage() {
+  for (size_t index = 0; index < kClassCount; ++index) {
+    const ClassStats current = stats(static_cast<MemClass>(index));
+    ESP_LOGI("mem_tier", "%-7s caps=0x%04lx live=%u peak=%u allocs=%lu fallbacks=%lu failures=%lu", kClassNames[index],
+             static_cast<unsigned long>(kClassCaps[index]), static_cast<unsigned>(current.liveBytes),
+             static_cast<unsigned>(current.peakBytes), static_cast<unsigned long>(current.allocations),
+             static_cast<unsigned long>(current.fallbacks), static_cast<unsigned long>(current.failures));
+  }
+  ESP_LOGI("mem_tier", "free internal=%u psram=%u largest internal block=%u",
+           static_cast<unsigned>(heap_caps_get_free_size(MALLOC_CAP_INTERNAL)),
+           static_cast<unsigned>(heap_caps_get_free_size(MALLOC_CAP_SPIRAM)),
+           static_cast<unsigned>(heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL)));
+}
+
+}  // namespace mem
@@ -1,15 +1,19 @@
 #include <Arduino.h>
 #include <core/wdt.h>
+#include <core/mem_tier.h>
 #include "core/nvs.h"
 #include <LittleFS.h>
 #include <nvs_flash.h>
 #include "app/espnow/slave.h"
 #include "app/espnow/payload_codec.h"
 #include "app/espnow/state_binary.h"
+#include "app/history/series_clock.h"
+#include "app/history/timeseries_store.h"
+#include "app/storage/kv_store.h"
+#include "app/storage/persistence.h"
 #include "app/sensor/dht_sensor.h"
 #include "app/weather/open_meteo_locations.h"
-#include "app/tasks/inputTask.h"
-#include "app/tasks/networkTask.h"
+#include "app/tasks/appTask.h"
 #include <app_config.h>
 
 using app::espnow::espnowSlave;
@@ -22,23 +26,28 @@ void init(){
 }
 
 void setup() {
-	LittleFS.begin(true);
+	// memory tiers first: later buffers are placed by class (see core/mem_tier.h)
+	mem::begin();
 
-	#if BOARD_HAS_PSRAM
-	heap_caps_malloc_extmem_enable(0);
+	LittleFS.begin(true);
+	app::storage::kvStore.begin();
+	app::storage::persistence.begin();
+	// history timestamps resume from the floor in the key-value store after a power-on
+	app::history::seriesClock.begin();
+
+	#if TIMESERIES_ENABLED
+	app::history::sensorSeries.begin();
+	app::history::weatherSeries.begin();
 	#endif
 
-	// network task will initialize ESP-NOW and manage proxy requests
-	app::tasks::startNetworkTask();
-
-	// start input task (battery + DHT reads)
-	if (!app::tasks::startInputTask()){
-		ESP_LOGE("MAIN", "Input task failed to start");
+	// one task runs the network, weather pipeline and input coroutines
+	if (!app::tasks::startAppTask()){
+		ESP_LOGE("MAIN", "App task failed to start");
 	}
 
 }
 
 void loop() {
-	  // network + input tasks run the work; keep loop idle
+	  // the app task runs the work; keep loop idle
 	  vTaskDelete(NULL);
 }
\ No newline at end of file
@@ -0,0 +1,144 @@
+#pragma once
+
+// Host stand-in for the Arduino core: the integer types, min/max, heap_caps, a String backed by
+// std::string, a millis()/micros() clock the tests set through stub::nowUs and GPIO calls that
+// log pin changes (stub::pinLog) and keep the attached interrupt for the test to fire.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <esp_attr.h>
+#include <esp_heap_caps.h>
+
+using std::max;
+using std::min;
+
+namespace stub {
+inline uint64_t nowUs = 0;
+}  // namespace stub
+
+inline unsigned long millis() { return static_cast<unsigned long>(stub::nowUs / 1000); }
+inline unsigned long micros() { return static_cast<unsigned long>(stub::nowUs); }
+inline void delay(uint32_t ms) { stub::nowUs += static_cast<uint64_t>(ms) * 1000; }
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define CHANGE 0x03
+
+namespace stub {
+struct PinEvent {
+  uint64_t atUs;
+  uint8_t pin;
+  uint8_t mode;
+  uint8_t level;
+};
+
+inline std::vector<PinEvent> pinLog;
+inline uint8_t pinModes[64] = {};
+inline uint8_t pinLevels[64] = {};
+inline void (*pinIsr)(void*) = nullptr;
+inline void* pinIsrArg = nullptr;
+
+inline void resetPins() {
+  pinLog.clear();
+  std::fill(std::begin(pinModes), std::end(pinModes), 0);
+  std::fill(std::begin(pinLevels), std::end(pinLevels), 0);
+  pinIsr = nullptr;
+  pinIsrArg = nullptr;
+}
+}  // namespace stub
+
+inline void pinMode(uint8_t pin, uint8_t mode) {
+  stub::pinModes[pin] = mode;
+  if (mode == INPUT_PULLUP) {
+    stub::pinLevels[pin] = HIGH;
+  }
+  stub::pinLog.push_back({stub::nowUs, pin, mode, stub::pinLevels[pin]});
+}
+inline void digitalWrite(uint8_t pin, uint8_t level) {
+  stub::pinLevels[pin] = level;
+  stub::pinLog.push_back({stub::nowUs, pin, stub::pinModes[pin], level});
+}
+inline int digitalRead(uint8_t pin) { return stub::pinLevels[pin]; }
+inline void attachInterruptArg(uint8_t, void (*isr)(void*), void* arg, int) {
+  stub::pinIsr = isr;
+  stub::pinIsrArg = arg;
+}
+inline void detachInterrupt(uint8_t) {
+  stub::pinIsr = nullptr;
+  stub::pinIsrArg = nullptr;
+}
+
+class String {
+ public:
+  String() = default;
+  String(const char* text) : value(text != nullptr ? text : "") {}
+  String(const char* text, size_t length) : value(text, length) {}
+  String(const std::string& text) : value(text) {}
+  explicit String(int number) : value(std::to_string(number)) {}
+  explicit String(unsigned number) : value(std::to_string(number)) {}
+  explicit String(long number) : value(std::to_string(number)) {}
+  explicit String(unsigned long number) : value(std::to_string(number)) {}
+  explicit String(double number, unsigned char decimals = 2) {
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", static_cast<int>(decimals), number);
+    value = text;
+  }
+
+  const char* c_str() const { return value.c_str(); }
+  size_t length() const { return value.size(); }
+  bool isEmpty() const { return value.empty(); }
+  char operator[](size_t index) const { return index < value.size() ? value[index] : '\0'; }
+  int indexOf(const char* text, unsigned from = 0) const {
+    const size_t found = value.find(text, from);
+    return found == std::string::npos ? -1 : static_cast<int>(found);
+  }
+  int indexOf(const String& text, unsigned from = 0) const { return indexOf(text.c_str(), from); }
+  String substring(unsigned begin, unsigned end) const {
+    return begin < value.size() && begin < end ? String(value.substr(begin, end - begin)) : String();
+  }
+  void trim() {
+    const size_t first = value.find_first_not_of(" \t\r\n");
+    const size_t last = value.find_last_not_of(" \t\r\n");
+    value = first == std::string::npos ? std::string() : value.substr(first, last - first + 1);
+  }
+
+  bool reserve(size_t size) {
+    value.reserve(size);
+    return true;
+  }
+  bool concat(const char* text, size_t length) {
+    value.append(text, length);
+    return true;
+  }
+  String& operator+=(const String& other) {
+    value += other.value;
+    return *this;
+  }
+  String& operator+=(const char* text) {
+    value += text;
+    return *this;
+  }
+  String& operator+=(char c) {
+    value += c;
+    return *this;
+  }
+  friend String operator+(const String& a, const String& b) { return String(a.value + b.value); }
+  friend String operator+(const String& a, const char* b) { return String(a.value + b); }
+  bool operator==(const String& other) const { return value == other.value; }
+  bool operator==(const char* text) const { return value == text; }
+  bool operator!=(const String& other) const { return value != other.value; }
+
+ private:
+  std::string value;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+// Host stand-in for the Arduino FS API on top of stdio, rooted at stub::fsRoot. stub::fsWriteBudget
+// caps the bytes all files may still take (flash full / power cut mid-write); stub::fsFailOpen
+// makes every open() fail.
+
+#include <Arduino.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+namespace stub {
+inline std::string fsRoot = "/tmp/pio-native-fs";
+inline size_t fsWriteBudget = SIZE_MAX;
+inline uint64_t fsBytesWritten = 0;
+inline bool fsFailOpen = false;
+}  // namespace stub
+
+namespace fs {
+
+class File {
+ public:
+  File() = default;
+  explicit File(FILE* handle) : handle(handle) {}
+  File(const File&) = delete;
+  File& operator=(const File&) = delete;
+  File(File&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+  File& operator=(File&& other) noexcept {
+    close();
+    handle = other.handle;
+    other.handle = nullptr;
+    return *this;
+  }
+  ~File() { close(); }
+
+  explicit operator bool() const { return handle != nullptr; }
+
+  size_t read(uint8_t* buffer, size_t size) { return handle != nullptr ? fread(buffer, 1, size, handle) : 0; }
+  // byte-wise Stream calls, as ArduinoJson reads and writes them
+  int read() { return handle != nullptr ? fgetc(handle) : -1; }
+  size_t readBytes(char* buffer, size_t size) { return read(reinterpret_cast<uint8_t*>(buffer), size); }
+  int available() const { return handle != nullptr ? static_cast<int>(size() - position()) : 0; }
+  size_t write(uint8_t byte) { return write(&byte, 1); }
+  size_t write(const uint8_t* buffer, size_t size) {
+    if (handle == nullptr) {
+      return 0;
+    }
+    const size_t allowed = std::min(size, stub::fsWriteBudget);
+    const size_t written = fwrite(buffer, 1, allowed, handle);
+    if (stub::fsWriteBudget != SIZE_MAX) {
+      stub::fsWriteBudget -= written;
+    }
+    stub::fsBytesWritten += written;
+    return written;
+  }
+  bool seek(uint32_t position) { return handle != nullptr && fseek(handle, position, SEEK_SET) == 0; }
+  size_t position() const { return handle != nullptr ? static_cast<size_t>(ftell(handle)) : 0; }
+  size_t size() const {
+    if (handle == nullptr) {
+      return 0;
+    }
+    const long current = ftell(handle);
+    fseek(handle, 0, SEEK_END);
+    const long end = ftell(handle);
+    fseek(handle, current, SEEK_SET);
+    return static_cast<size_t>(end);
+  }
+  void close() {
+    if (handle != nullptr) {
+      fclose(handle);
+      handle = nullptr;
+    }
+  }
+
+ private:
+  FILE* handle = nullptr;
+};
+
+class FS {
+ public:
+  File open(const String& path, const char* mode) {
+    if (stub::fsFailOpen) {
+      return File();
+    }
+    const std::string flags = mode[0] == 'r' ? "rb" : mode[0] == 'w' ? "wb" : "ab";
+    return File(fopen(full(path).c_str(), flags.c_str()));
+  }
+  bool exists(const String& path) { return std::filesystem::exists(full(path)); }
+  bool mkdir(const String& path) { return std::filesystem::create_directories(full(path)); }
+  bool remove(const String& path) { return std::filesystem::remove(full(path)); }
+  bool rename(const String& from, const String& to) {
+    std::error_code error;
+    std::filesystem::rename(full(from), full(to), error);
+    return !error;
+  }
+
+ private:
+  static std::string full(const String& path) { return stub::fsRoot + path.c_str(); }
+};
+
+}  // namespace fs
+
+using fs::File;
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "FS.h"
+
+namespace stub {
+
+// Starts every test on an empty filesystem.
+inline void resetFs() {
+  std::filesystem::remove_all(fsRoot);
+  std::filesystem::create_directories(fsRoot);
+  fsWriteBudget = SIZE_MAX;
+  fsBytesWritten = 0;
+  fsFailOpen = false;
+}
+
+}  // namespace stub
+
+inline fs::FS LittleFS;
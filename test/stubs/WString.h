@@ -0,0 +1,4 @@
+#pragma once
+
+// String comes with the Arduino stand-in.
+#include <Arduino.h>
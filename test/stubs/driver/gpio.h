@@ -0,0 +1,7 @@
+#pragma once
+
+#include <Arduino.h>
+
+typedef int gpio_num_t;
+
+inline int gpio_get_level(gpio_num_t pin) { return stub::pinLevels[pin]; }
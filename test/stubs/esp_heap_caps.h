@@ -0,0 +1,86 @@
+#pragma once
+
+// Host stand-in for heap_caps_*: one heap, caps ignored. Every call is counted in stub::heap so
+// tests can compare allocation counts, live blocks and peak bytes; code that allocates through
+// operator new can feed the same counters with stub::heapTrack/heapUntrack.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <malloc.h>
+
+#define MALLOC_CAP_EXEC (1 << 0)
+#define MALLOC_CAP_32BIT (1 << 1)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+namespace stub {
+
+struct HeapCounters {
+  uint32_t calls = 0;  // malloc, realloc and free calls
+  uint32_t liveBlocks = 0;
+  size_t liveBytes = 0;
+  size_t peakBytes = 0;
+};
+inline HeapCounters heap;
+
+// Restarts the counters; the peak starts from what is live now.
+inline void resetHeap() {
+  heap.calls = 0;
+  heap.peakBytes = heap.liveBytes;
+}
+
+inline void heapTrack(size_t bytes) {
+  heap.calls++;
+  heap.liveBlocks++;
+  heap.liveBytes += bytes;
+  heap.peakBytes = heap.liveBytes > heap.peakBytes ? heap.liveBytes : heap.peakBytes;
+}
+
+inline void heapUntrack(size_t bytes) {
+  heap.calls++;
+  heap.liveBlocks--;
+  heap.liveBytes -= bytes;
+}
+
+}  // namespace stub
+
+inline void* heap_caps_malloc(size_t size, uint32_t) {
+  void* pointer = malloc(size);
+  if (pointer != nullptr) {
+    stub::heapTrack(malloc_usable_size(pointer));
+  }
+  return pointer;
+}
+
+inline void* heap_caps_malloc_prefer(size_t size, size_t, uint32_t, uint32_t) {
+  return heap_caps_malloc(size, 0);
+}
+
+inline void heap_caps_free(void* pointer) {
+  if (pointer != nullptr) {
+    stub::heapUntrack(malloc_usable_size(pointer));
+    free(pointer);
+  }
+}
+
+inline void* heap_caps_realloc_prefer(void* pointer, size_t size, size_t, uint32_t, uint32_t) {
+  const size_t oldSize = pointer != nullptr ? malloc_usable_size(pointer) : 0;
+  void* moved = realloc(pointer, size);
+  if (moved == nullptr) {
+    return nullptr;
+  }
+  if (pointer != nullptr) {
+    stub::heapUntrack(oldSize);
+    stub::heap.calls--;  // one realloc call, not a free plus a malloc
+  }
+  stub::heapTrack(malloc_usable_size(moved));
+  return moved;
+}
+
+inline size_t heap_caps_get_allocated_size(void* pointer) {
+  return pointer != nullptr ? malloc_usable_size(pointer) : 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+#define ESP_NOW_ETH_ALEN 6
+#define ESP_NOW_MAX_DATA_LEN 250
+#define ESP_NOW_MAX_DATA_LEN_V2 1470
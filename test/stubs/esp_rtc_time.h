@@ -0,0 +1,6 @@
+#pragma once
+
+#include <Arduino.h>
+
+// the RTC timer runs with the same stub clock as millis()/micros()
+inline uint64_t esp_rtc_get_time_us() { return stub::nowUs; }
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <Arduino.h>
+
+inline int64_t esp_timer_get_time() { return static_cast<int64_t>(stub::nowUs); }
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+// Single-threaded host build: blocking calls return at once and mutexes always succeed.
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+// Types only: queues are never created on the host.
+
+struct StaticQueue_t {
+  uint8_t opaque[80];
+};
+typedef StaticQueue_t* QueueHandle_t;
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+// Types only: ring buffers are never created on the host.
+
+struct StaticRingbuffer_t {
+  uint8_t opaque[104];
+};
+typedef StaticRingbuffer_t* RingbufHandle_t;
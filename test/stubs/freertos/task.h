@@ -0,0 +1,12 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+// Types only: tasks are never created on the host. Sizes follow the ESP32 port closely enough for
+// the static RAM budget in static_config.h.
+
+typedef uint8_t StackType_t;
+struct StaticTask_t {
+  uint8_t opaque[344];
+};
+typedef StaticTask_t* TaskHandle_t;
@@ -0,0 +1,139 @@
+#include <unity.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "app/input/battery/battery_filter.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_divider_scaling_and_trim() {
+  // 2:1 divider (100k/100k)
+  TEST_ASSERT_EQUAL_UINT16(3900, batteryMvFromPinMv(1950, 2000));
+  // 100k over 200k: 1.5, rounded to the nearest millivolt
+  TEST_ASSERT_EQUAL_UINT16(4001, batteryMvFromPinMv(2667, 1500));
+  TEST_ASSERT_EQUAL_UINT16(3999, batteryMvFromPinMv(2666, 1500));
+  // the manager's float ratio, as configured per board
+  TEST_ASSERT_EQUAL_UINT16(2000, batteryDividerX1000(2.0f));
+  TEST_ASSERT_EQUAL_UINT16(1470, batteryDividerX1000(1.47f));
+  TEST_ASSERT_EQUAL_UINT16(4067, batteryMvFromPinMv(2767, batteryDividerX1000(1.47f)));
+  // board trim both ways
+  TEST_ASSERT_EQUAL_UINT16(3885, batteryMvFromPinMv(1950, 2000, -15));
+  TEST_ASSERT_EQUAL_UINT16(3920, batteryMvFromPinMv(1950, 2000, 20));
+}
+
+void test_scaling_clamps_instead_of_wrapping() {
+  TEST_ASSERT_EQUAL_UINT16(0, batteryMvFromPinMv(0, 2000, -15));
+  TEST_ASSERT_EQUAL_UINT16(0xFFFF, batteryMvFromPinMv(40000, 2000));
+}
+
+void test_first_sample_primes_the_filter() {
+  BatteryFilter filter;
+  TEST_ASSERT_FALSE(filter.hasValue());
+  TEST_ASSERT_EQUAL_UINT16(3900, filter.update(3900));
+  TEST_ASSERT_TRUE(filter.hasValue());
+
+  filter.reset();
+  TEST_ASSERT_FALSE(filter.hasValue());
+  TEST_ASSERT_EQUAL_UINT16(3700, filter.update(3700));
+}
+
+void test_single_spike_is_rejected() {
+  BatteryFilter filter;
+  const uint16_t samples[] = {3900, 3902, 3898, 4500, 3901, 3899, 3000, 3900};
+  for (uint16_t sample : samples) {
+    const uint16_t value = filter.update(sample);
+    TEST_ASSERT_INT_WITHIN(5, 3900, value);
+  }
+}
+
+void test_step_is_followed() {
+  BatteryFilter filter;
+  for (int index = 0; index < 10; ++index) {
+    filter.update(3900);
+  }
+  // a real drop (radio burst, load change) passes the median after two samples and then converges
+  int samples = 0;
+  while (filter.update(3800) > 3805) {
+    samples++;
+    TEST_ASSERT_LESS_THAN(20, samples);
+  }
+  TEST_ASSERT_EQUAL_UINT16(3800, [&] {
+    for (int index = 0; index < 20; ++index) {
+      filter.update(3800);
+    }
+    return filter.value();
+  }());
+}
+
+// Benchmark: noise left after the filter on a cell at 3.90 V read with +-20 mV ADC noise and 2%
+// of samples hit by a 300 mV spike, and how many updates a 100 mV step takes to settle.
+void test_benchmark_noise_and_settling() {
+  std::mt19937 rng(35);
+  std::normal_distribution<double> noise(0.0, 20.0);
+  std::bernoulli_distribution spike(0.02);
+
+  BatteryFilter filter;
+  std::vector<double> raw;
+  std::vector<double> filtered;
+  for (int index = 0; index < 20000; ++index) {
+    double sample = 3900 + noise(rng);
+    if (spike(rng)) {
+      sample += 300;
+    }
+    const uint16_t mv = static_cast<uint16_t>(lround(sample));
+    const uint16_t value = filter.update(mv);
+    if (index >= 100) {
+      raw.push_back(mv);
+      filtered.push_back(value);
+    }
+  }
+
+  auto rms = [](const std::vector<double>& values) {
+    double squares = 0;
+    for (double value : values) {
+      squares += (value - 3900) * (value - 3900);
+    }
+    return std::sqrt(squares / values.size());
+  };
+  // 99.9th percentile of the absolute error; two spikes in a row get past the median
+  auto tail = [](const std::vector<double>& values) {
+    std::vector<double> errors;
+    for (double value : values) {
+      errors.push_back(std::fabs(value - 3900));
+    }
+    std::sort(errors.begin(), errors.end());
+    return errors[errors.size() * 999 / 1000];
+  };
+
+  BatteryFilter step;
+  for (int index = 0; index < 10; ++index) {
+    step.update(3900);
+  }
+  int settle = 0;
+  while (std::abs(static_cast<int>(step.update(3800)) - 3800) > 5) {
+    settle++;
+  }
+
+  printf("battery_filter: rms error %.1f mV raw -> %.1f mV filtered, p99.9 %.0f -> %.0f mV, "
+         "100 mV step settles to 5 mV in %d updates\n",
+         rms(raw), rms(filtered), tail(raw), tail(filtered), settle + 1);
+
+  TEST_ASSERT_TRUE(rms(filtered) < rms(raw) / 2);
+  TEST_ASSERT_TRUE(tail(filtered) < tail(raw) / 3);
+  TEST_ASSERT_LESS_THAN(15, settle);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_divider_scaling_and_trim);
+  RUN_TEST(test_scaling_clamps_instead_of_wrapping);
+  RUN_TEST(test_first_sample_primes_the_filter);
+  RUN_TEST(test_single_spike_is_rejected);
+  RUN_TEST(test_step_is_followed);
+  RUN_TEST(test_benchmark_noise_and_settling);
+  return UNITY_END();
+}
@@ -0,0 +1,255 @@
+#include <unity.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "app/espnow/chunk_assembler.h"
+
+using app::espnow::ChunkAssembler;
+
+namespace {
+
+// a typical forecast response: 900 bytes in v1-sized chunks, one XOR parity per 3 chunks
+static constexpr size_t kStride = 160;
+static constexpr uint8_t kGroupSize = 3;
+// one ~250-byte ESP-NOW frame plus inter-frame gap, and the time before a missing chunk is asked for again
+static constexpr double kFrameMs = 2.0;
+static constexpr double kRetryMs = 60.0;
+
+uint8_t storage[ChunkAssembler::kMaxBytes];
+
+struct Response {
+  std::string body;
+  uint16_t total = 0;
+
+  explicit Response(size_t length) {
+    for (size_t index = 0; index < length; ++index) {
+      body.push_back(static_cast<char>('a' + index % 26));
+    }
+    total = static_cast<uint16_t>((body.size() + kStride - 1) / kStride);
+  }
+
+  size_t chunkLen(uint16_t idx) const { return std::min(kStride, body.size() - (idx - 1) * kStride); }
+  const uint8_t* chunk(uint16_t idx) const { return reinterpret_cast<const uint8_t*>(body.data()) + (idx - 1) * kStride; }
+  uint16_t groups() const { return static_cast<uint16_t>((total + kGroupSize - 1) / kGroupSize); }
+  uint16_t first(uint16_t group) const { return static_cast<uint16_t>((group - 1) * kGroupSize + 1); }
+  uint16_t last(uint16_t group) const { return std::min<uint16_t>(group * kGroupSize, total); }
+
+  ChunkAssembler::Result sendData(ChunkAssembler& assembler, uint16_t requestId, uint16_t idx) const {
+    return assembler.addData(requestId, idx, total, 1, 200, kStride, chunk(idx), chunkLen(idx));
+  }
+
+  ChunkAssembler::Result sendParity(ChunkAssembler& assembler, uint16_t requestId, uint16_t group) const {
+    std::vector<uint8_t> parity(kStride, 0);
+    uint16_t lenXor = 0;
+    for (uint16_t idx = first(group); idx <= last(group); ++idx) {
+      for (size_t offset = 0; offset < chunkLen(idx); ++offset) {
+        parity[offset] ^= chunk(idx)[offset];
+      }
+      lenXor ^= static_cast<uint16_t>(chunkLen(idx));
+    }
+    return assembler.addParity(requestId, group, kGroupSize, total, 1, 200, lenXor, parity.data(), parity.size());
+  }
+
+  bool matches(const ChunkAssembler& assembler) const {
+    return assembler.length() == body.size() && memcmp(assembler.data(), body.data(), body.size()) == 0;
+  }
+};
+
+// Delivers one response over a link that drops each frame with probability `loss`. The first
+// round sends every data chunk (and the parity chunks with `fec`); every later round waits
+// kRetryMs and resends only the chunks the receiver still misses. Returns the delivery latency.
+double deliver(ChunkAssembler& assembler, const Response& response, uint16_t requestId, bool fec, double loss,
+               std::mt19937& rng, size_t& frames) {
+  std::bernoulli_distribution dropped(loss);
+  std::vector<bool> present(response.total + 1, false);
+  ChunkAssembler::Result result = ChunkAssembler::Result::Pending;
+  double elapsedMs = 0;
+
+  for (uint16_t idx = 1; idx <= response.total; ++idx) {
+    elapsedMs += kFrameMs;
+    frames++;
+    if (!dropped(rng)) {
+      result = response.sendData(assembler, requestId, idx);
+      present[idx] = true;
+    }
+  }
+  if (fec) {
+    for (uint16_t group = 1; group <= response.groups(); ++group) {
+      elapsedMs += kFrameMs;
+      frames++;
+      if (dropped(rng)) {
+        continue;
+      }
+      uint16_t missing = 0;
+      uint16_t missingIdx = 0;
+      for (uint16_t idx = response.first(group); idx <= response.last(group); ++idx) {
+        if (!present[idx]) {
+          missing++;
+          missingIdx = idx;
+        }
+      }
+      const ChunkAssembler::Result parityResult = response.sendParity(assembler, requestId, group);
+      if (parityResult != ChunkAssembler::Result::Late) {
+        result = parityResult;
+      }
+      if (missing == 1) {
+        present[missingIdx] = true;
+      }
+    }
+  }
+
+  while (result != ChunkAssembler::Result::Complete) {
+    elapsedMs += kRetryMs;
+    for (uint16_t idx = 1; idx <= response.total; ++idx) {
+      if (present[idx]) {
+        continue;
+      }
+      elapsedMs += kFrameMs;
+      frames++;
+      if (!dropped(rng)) {
+        result = response.sendData(assembler, requestId, idx);
+        present[idx] = true;
+      }
+    }
+  }
+  return elapsedMs;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_every_single_loss_is_rebuilt() {
+  const Response response(900);
+  for (uint16_t drop = 1; drop <= response.total; ++drop) {
+    ChunkAssembler assembler;
+    assembler.attachBuffer(storage);
+    ChunkAssembler::Result result = ChunkAssembler::Result::Pending;
+    for (uint16_t idx = 1; idx <= response.total; ++idx) {
+      if (idx != drop) {
+        result = response.sendData(assembler, 7, idx);
+      }
+    }
+    TEST_ASSERT_TRUE(result == ChunkAssembler::Result::Pending);
+    for (uint16_t group = 1; group <= response.groups(); ++group) {
+      const ChunkAssembler::Result parityResult = response.sendParity(assembler, 7, group);
+      if (parityResult != ChunkAssembler::Result::Late) {
+        result = parityResult;
+      }
+    }
+    TEST_ASSERT_TRUE(result == ChunkAssembler::Result::Complete);
+    TEST_ASSERT_TRUE(response.matches(assembler));
+    TEST_ASSERT_EQUAL_UINT32(1, assembler.stats().recovered);
+  }
+}
+
+void test_trailing_frames_do_not_reopen_a_completed_response() {
+  const Response response(900);
+  ChunkAssembler assembler;
+  assembler.attachBuffer(storage);
+  for (uint16_t idx = 1; idx <= response.total; ++idx) {
+    response.sendData(assembler, 9, idx);
+  }
+  TEST_ASSERT_EQUAL_UINT32(1, assembler.stats().responses);
+
+  // parity sent after the data, and a duplicate data chunk, for the response that already completed
+  TEST_ASSERT_TRUE(response.sendParity(assembler, 9, 1) == ChunkAssembler::Result::Late);
+  TEST_ASSERT_TRUE(response.sendData(assembler, 9, 2) == ChunkAssembler::Result::Late);
+  TEST_ASSERT_EQUAL_UINT32(1, assembler.stats().responses);
+  TEST_ASSERT_EQUAL_UINT32(0, assembler.stats().parityChunks);
+  TEST_ASSERT_EQUAL_UINT32(0, assembler.stats().abandoned);
+  TEST_ASSERT_EQUAL_UINT32(2, assembler.stats().late);
+  TEST_ASSERT_TRUE(response.matches(assembler));
+
+  // the next request id is accepted as usual
+  TEST_ASSERT_TRUE(response.sendData(assembler, 10, 1) == ChunkAssembler::Result::Pending);
+}
+
+void test_loss_window_resets_on_read() {
+  const Response response(900);
+  ChunkAssembler assembler;
+  assembler.attachBuffer(storage);
+  std::mt19937 rng(3);
+  std::bernoulli_distribution dropped(0.1);
+
+  // data only, no retries: an incomplete response is finished when the next one starts, and the
+  // last one is sent clean so nothing is left open
+  for (uint16_t requestId = 1; requestId <= 2001; ++requestId) {
+    for (uint16_t idx = 1; idx <= response.total; ++idx) {
+      if (requestId == 2001 || !dropped(rng)) {
+        response.sendData(assembler, requestId, idx);
+      }
+    }
+  }
+
+  const ChunkAssembler::Stats window = assembler.takeWindow();
+  TEST_ASSERT_EQUAL_UINT32(2001 * response.total, window.expectedChunks);
+  TEST_ASSERT_TRUE(window.lossRate() > 0.08f && window.lossRate() < 0.12f);
+  TEST_ASSERT_EQUAL_UINT32(0, assembler.takeWindow().expectedChunks);
+  TEST_ASSERT_EQUAL_UINT32(window.expectedChunks, assembler.stats().expectedChunks);
+
+  // a clean link shows up as zero loss in the next window, whatever the history
+  for (uint16_t requestId = 3000; requestId < 3010; ++requestId) {
+    for (uint16_t idx = 1; idx <= response.total; ++idx) {
+      response.sendData(assembler, requestId, idx);
+    }
+  }
+  TEST_ASSERT_TRUE(assembler.takeWindow().lossRate() == 0.0f);
+  TEST_ASSERT_TRUE(assembler.stats().lossRate() > 0.0f);
+}
+
+// Benchmark: delivery latency against frame loss, XOR parity (one per 3 chunks) with retries
+// as fallback against retries alone.
+void test_benchmark_latency_against_loss() {
+  const Response response(900);
+  const double losses[] = {0.0, 0.01, 0.05, 0.10, 0.20};
+  static constexpr int kTrials = 4000;
+
+  for (double loss : losses) {
+    double meanMs[2] = {0, 0};
+    double p95Ms[2] = {0, 0};
+    double framesPerResponse[2] = {0, 0};
+    for (int fec = 0; fec < 2; ++fec) {
+      ChunkAssembler assembler;
+      assembler.attachBuffer(storage);
+      std::mt19937 rng(11);
+      std::vector<double> latencies;
+      size_t frames = 0;
+      for (int trial = 0; trial < kTrials; ++trial) {
+        const double latency =
+            deliver(assembler, response, static_cast<uint16_t>(trial + 1), fec == 1, loss, rng, frames);
+        TEST_ASSERT_TRUE(response.matches(assembler));
+        latencies.push_back(latency);
+      }
+      std::sort(latencies.begin(), latencies.end());
+      for (double latency : latencies) {
+        meanMs[fec] += latency / kTrials;
+      }
+      p95Ms[fec] = latencies[kTrials * 95 / 100];
+      framesPerResponse[fec] = static_cast<double>(frames) / kTrials;
+      TEST_ASSERT_EQUAL_UINT32(kTrials, assembler.stats().responses);
+    }
+
+    printf("chunk_assembler: loss %4.1f%%: retry mean %5.1f ms p95 %5.1f ms %4.2f frames, "
+           "parity+retry mean %5.1f ms p95 %5.1f ms %4.2f frames\n",
+           100 * loss, meanMs[0], p95Ms[0], framesPerResponse[0], meanMs[1], p95Ms[1], framesPerResponse[1]);
+
+    if (loss >= 0.05) {
+      TEST_ASSERT_TRUE(meanMs[1] < meanMs[0]);
+      TEST_ASSERT_TRUE(p95Ms[1] < p95Ms[0]);
+    }
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_every_single_loss_is_rebuilt);
+  RUN_TEST(test_trailing_frames_do_not_reopen_a_completed_response);
+  RUN_TEST(test_loss_window_resets_on_read);
+  RUN_TEST(test_benchmark_latency_against_loss);
+  return UNITY_END();
+}
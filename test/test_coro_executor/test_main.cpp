@@ -0,0 +1,263 @@
+#include <unity.h>
+
+#include <chrono>
+#include <vector>
+
+#include "app/static_config.h"
+#include "core/coro.h"
+
+namespace {
+
+uint32_t nowMs = 0;
+uint32_t nowUs = 0;
+
+uint32_t clock() {
+  return nowMs;
+}
+
+uint32_t busyClock() {
+  return nowUs;
+}
+
+std::vector<int> order;
+
+coro::Task sleeper(int id, uint32_t ms, int rounds) {
+  for (int round = 0; round < rounds; ++round) {
+    co_await coro::delay(ms);
+    order.push_back(id);
+  }
+}
+
+coro::Task yielder(int id, int rounds) {
+  for (int round = 0; round < rounds; ++round) {
+    order.push_back(id);
+    co_await coro::yield();
+  }
+}
+
+bool flagSet(void* context) {
+  return *static_cast<bool*>(context);
+}
+
+coro::Task waiter(bool* flag, int* woke) {
+  co_await coro::until(flagSet, flag);
+  *woke = static_cast<int>(nowMs);
+}
+
+coro::Task burner(uint32_t us) {
+  while (true) {
+    nowUs += us;
+    co_await coro::delay(10);
+  }
+}
+
+coro::Task smallFrame() {
+  co_await coro::delay(1);
+}
+
+coro::Task largeFrame() {
+  volatile uint8_t buffer[256];
+  for (size_t index = 0; index < sizeof(buffer); ++index) {
+    buffer[index] = static_cast<uint8_t>(index);
+  }
+  co_await coro::delay(1);
+  buffer[0] = buffer[255];
+}
+
+// Runs the executor like appTaskRunner: one pass, then sleep for what it returned (at least 1 ms).
+void run(coro::Executor& executor, uint32_t untilMs) {
+  while (static_cast<int32_t>(untilMs - nowMs) > 0) {
+    const uint32_t idleMs = executor.runOnce();
+    nowMs += idleMs > 0 ? idleMs : 1;
+  }
+}
+
+}  // namespace
+
+void setUp() {
+  nowMs = 0;
+  nowUs = 0;
+  order.clear();
+  coro::frameArena = {};
+}
+
+void tearDown() {}
+
+void test_delays_resume_in_time_order() {
+  coro::Executor executor(clock, 50);
+  TEST_ASSERT_TRUE(executor.spawn("slow", sleeper(1, 30, 2)));
+  TEST_ASSERT_TRUE(executor.spawn("fast", sleeper(2, 20, 3)));
+  run(executor, 100);
+
+  // fast at 20, 40, 60; slow at 30, 60 (spawn order breaks the tie at 60)
+  const std::vector<int> expected = {2, 1, 2, 1, 2};
+  TEST_ASSERT_EQUAL_size_t(expected.size(), order.size());
+  TEST_ASSERT_EQUAL_INT_ARRAY(expected.data(), order.data(), expected.size());
+  TEST_ASSERT_TRUE(executor.info(0).done);
+  TEST_ASSERT_TRUE(executor.info(1).done);
+}
+
+void test_yield_interleaves_and_idles_zero() {
+  coro::Executor executor(clock, 50);
+  executor.spawn("a", yielder(1, 3));
+  executor.spawn("b", yielder(2, 3));
+
+  // a yielding coroutine leaves no time to sleep
+  TEST_ASSERT_EQUAL_UINT32(0, executor.runOnce());
+  executor.runOnce();
+  executor.runOnce();
+  const std::vector<int> expected = {1, 2, 1, 2, 1, 2};
+  TEST_ASSERT_EQUAL_INT_ARRAY(expected.data(), order.data(), expected.size());
+}
+
+void test_idle_is_the_nearest_wake_up() {
+  coro::Executor executor(clock, 50);
+  executor.spawn("a", sleeper(1, 30, 1));
+  executor.spawn("b", sleeper(2, 12, 1));
+  TEST_ASSERT_EQUAL_UINT32(12, executor.runOnce());
+  nowMs = 5;
+  TEST_ASSERT_EQUAL_UINT32(7, executor.runOnce());
+
+  // nothing due within the bound: maxIdleMs
+  coro::Executor bounded(clock, 10);
+  bounded.spawn("a", sleeper(1, 1000, 1));
+  TEST_ASSERT_EQUAL_UINT32(10, bounded.runOnce());
+}
+
+void test_until_waits_for_the_condition() {
+  coro::Executor executor(clock, 10);
+  bool flag = false;
+  int woke = -1;
+  executor.spawn("waiter", waiter(&flag, &woke));
+
+  // a pending condition only bounds the sleep by maxIdleMs
+  TEST_ASSERT_EQUAL_UINT32(10, executor.runOnce());
+  run(executor, 30);
+  TEST_ASSERT_EQUAL_INT(-1, woke);
+
+  flag = true;
+  executor.runOnce();
+  TEST_ASSERT_EQUAL_INT(30, woke);
+  TEST_ASSERT_TRUE(executor.info(0).done);
+}
+
+void test_clock_wrap() {
+  nowMs = 0xFFFFFFF0u;
+  coro::Executor executor(clock, 50);
+  executor.spawn("wrap", sleeper(1, 30, 2));
+  TEST_ASSERT_EQUAL_UINT32(30, executor.runOnce());
+  run(executor, 0xFFFFFFF0u + 61);
+  TEST_ASSERT_EQUAL_size_t(2, order.size());
+  TEST_ASSERT_TRUE(executor.info(0).done);
+}
+
+void test_spawn_limit_and_invalid_task() {
+  coro::Executor executor(clock, 50);
+  for (size_t index = 0; index < coro::Executor::kMaxTasks; ++index) {
+    TEST_ASSERT_TRUE(executor.spawn("task", sleeper(1, 10, 1)));
+  }
+  TEST_ASSERT_FALSE(executor.spawn("one too many", sleeper(1, 10, 1)));
+  TEST_ASSERT_EQUAL_size_t(coro::Executor::kMaxTasks, executor.size());
+  TEST_ASSERT_FALSE(executor.spawn("empty", coro::Task()));
+}
+
+// startAppTask's spawns must all fit, including with every optional coroutine (mem_stats, profile)
+// turned on; a failed spawn on the device only shows up as an error log.
+void test_app_coroutines_fit_the_executor() {
+  using app::static_config::coroutineCount;
+  TEST_ASSERT_TRUE(app::static_config::kCoroutineCount <= coro::Executor::kMaxTasks);
+
+  const size_t allEnabled = coroutineCount(true, true);
+  TEST_ASSERT_TRUE(allEnabled <= coro::Executor::kMaxTasks);
+  coro::Executor executor(clock, 50);
+  for (size_t index = 0; index < allEnabled; ++index) {
+    TEST_ASSERT_TRUE(executor.spawn("app", sleeper(1, 10, 1)));
+  }
+}
+
+void test_busy_time_is_counted_per_coroutine() {
+  coro::Executor executor(clock, 50);
+  executor.setBusyClock(busyClock);
+  executor.spawn("light", burner(100));
+  executor.spawn("heavy", burner(900));
+  run(executor, 95);
+
+  TEST_ASSERT_EQUAL_UINT32(10, executor.info(0).resumes);
+  TEST_ASSERT_EQUAL_UINT32(1000, executor.info(0).busyUs);
+  TEST_ASSERT_EQUAL_UINT32(9000, executor.info(1).busyUs);
+}
+
+void test_frames_come_from_the_arena_then_the_heap() {
+  alignas(std::max_align_t) static uint8_t buffer[1024];
+  coro::useFrameArena(buffer, sizeof(buffer));
+
+  coro::Executor executor(clock, 50);
+  executor.spawn("small", smallFrame());
+  TEST_ASSERT_TRUE(coro::frameArena.owns(buffer));
+  TEST_ASSERT_EQUAL_UINT32(0, coro::frameArena.overflows);
+  const size_t afterSmall = coro::frameArena.used;
+  TEST_ASSERT_GREATER_THAN(0, afterSmall);
+  TEST_ASSERT_EQUAL_size_t(executor.info(0).frameBytes, executor.frameBytes());
+
+  // a frame that is never spawned hands its bytes back
+  {
+    coro::Task unused = largeFrame();
+  }
+  TEST_ASSERT_EQUAL_size_t(afterSmall, coro::frameArena.used);
+
+  // fill the arena; the rest goes to the heap and is counted
+  size_t spawned = 1;
+  while (coro::frameArena.overflows == 0 && spawned < coro::Executor::kMaxTasks) {
+    executor.spawn("large", largeFrame());
+    spawned++;
+  }
+  TEST_ASSERT_EQUAL_UINT32(1, coro::frameArena.overflows);
+  TEST_ASSERT_TRUE(coro::frameArena.used <= coro::frameArena.capacity);
+
+  run(executor, 5);
+  for (size_t index = 0; index < executor.size(); ++index) {
+    TEST_ASSERT_TRUE(executor.info(index).done);
+  }
+}
+
+// Benchmark: frame bytes for coroutines shaped like the app_task loops, and executor overhead per
+// resume with every slot taken.
+void test_benchmark_frames_and_resume_cost() {
+  coro::Executor executor(clock, 50);
+  executor.spawn("small", smallFrame());
+  executor.spawn("large", largeFrame());
+  executor.spawn("sleeper", sleeper(1, 1, 1000000));
+  printf("coro_executor: frames small=%zu large(256 B local)=%zu sleeper=%zu bytes\n", executor.info(0).frameBytes,
+         executor.info(1).frameBytes, executor.info(2).frameBytes);
+  TEST_ASSERT_TRUE(executor.info(1).frameBytes > 256);
+
+  coro::Executor busy(clock, 50);
+  for (size_t index = 0; index < coro::Executor::kMaxTasks; ++index) {
+    busy.spawn("yielder", yielder(0, 1 << 30));
+  }
+  static constexpr int kPasses = 20000;
+  const auto start = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < kPasses; ++pass) {
+    busy.runOnce();
+    order.clear();
+  }
+  const double nsPerResume = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                             (kPasses * coro::Executor::kMaxTasks);
+  printf("coro_executor: %.0f ns per resume on the host (%zu coroutines)\n", nsPerResume, coro::Executor::kMaxTasks);
+  TEST_ASSERT_EQUAL_UINT32(kPasses, busy.info(0).resumes);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_delays_resume_in_time_order);
+  RUN_TEST(test_yield_interleaves_and_idles_zero);
+  RUN_TEST(test_idle_is_the_nearest_wake_up);
+  RUN_TEST(test_until_waits_for_the_condition);
+  RUN_TEST(test_clock_wrap);
+  RUN_TEST(test_spawn_limit_and_invalid_task);
+  RUN_TEST(test_app_coroutines_fit_the_executor);
+  RUN_TEST(test_busy_time_is_counted_per_coroutine);
+  RUN_TEST(test_frames_come_from_the_arena_then_the_heap);
+  RUN_TEST(test_benchmark_frames_and_resume_cost);
+  return UNITY_END();
+}
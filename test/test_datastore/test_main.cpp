@@ -0,0 +1,230 @@
+#include <unity.h>
+
+#include <LittleFS.h>
+#include <esp_log.h>
+
+#include <chrono>
+#include <filesystem>
+#include <new>
+#include <string>
+
+#include <SpiJsonDocument.h>
+
+// The old load/save used SpiJsonDocument; measure the streaming path with the same document type
+// (what PSRAM boards run). The arena-backed variant is covered by test_json_arena.
+#define BOARD_HAS_PSRAM 1
+#include "core/datastore.h"
+
+// String and std::string allocations count towards the same heap figures as heap_caps_*.
+void* operator new(size_t size) {
+  auto* block = static_cast<std::max_align_t*>(malloc(sizeof(std::max_align_t) + size));
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<size_t*>(block) = size;
+  stub::heapTrack(size);
+  return block + 1;
+}
+
+void operator delete(void* pointer) noexcept {
+  if (pointer == nullptr) {
+    return;
+  }
+  auto* block = static_cast<std::max_align_t*>(pointer) - 1;
+  stub::heapUntrack(*reinterpret_cast<size_t*>(block));
+  free(block);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+  operator delete(pointer);
+}
+
+namespace {
+
+// A settings file like the ones DataStore keeps: `members` strings plus numbers and nesting.
+std::string configJson(int members) {
+  std::string json = "{\"device\":\"pio-weather\",\"wifi\":{\"ssid\":\"greenhouse-2g\",\"channel\":6},\"settings\":{";
+  char member[64];
+  for (int index = 0; index < members; ++index) {
+    snprintf(member, sizeof(member), "%s\"setting_%03d\":\"value number %d\"", index == 0 ? "" : ",", index,
+             index * 37);
+    json += member;
+  }
+  return json + "},\"areas\":[1,5,9],\"interval_ms\":15000}";
+}
+
+void writeFile(const char* path, const std::string& text) {
+  LittleFS.mkdir("/data");
+  File file = LittleFS.open(path, "w");
+  file.write(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+std::string readFile(const char* path) {
+  File file = LittleFS.open(path, "r");
+  std::string text(file.size(), '\0');
+  file.read(reinterpret_cast<uint8_t*>(text.data()), text.size());
+  return text;
+}
+
+// The load DataStore had before streaming: the whole file copied into a String 1 KB at a time.
+bool oldLoad(const char* path, JsonDocument& document) {
+  File file = LittleFS.open(path, "r");
+  if (!file) {
+    return false;
+  }
+  auto* buffer = static_cast<uint8_t*>(heap_caps_malloc(1024, MALLOC_CAP_SPIRAM | MALLOC_CAP_DEFAULT));
+  String data = "";
+  while (file.available()) {
+    memset(buffer, 0, 1024);
+    const size_t readBytes = file.read(buffer, 1024);
+    data += String(reinterpret_cast<const char*>(buffer), readBytes);
+  }
+  heap_caps_free(buffer);
+  file.close();
+  return !deserializeJson(document, data.c_str(), data.length());
+}
+
+// ... and its save: the document serialized into one string, written over the removed file.
+bool oldSave(const char* path, const JsonDocument& document) {
+  LittleFS.remove(path);
+  std::string jsonRaw;
+  serializeJson(document, jsonRaw);
+  File file = LittleFS.open(path, "w");
+  return file.write(reinterpret_cast<const uint8_t*>(jsonRaw.data()), jsonRaw.size()) == jsonRaw.size();
+}
+
+struct Measure {
+  size_t peakBytes = 0;
+  double us = 0;
+};
+
+template <typename Step>
+Measure measure(int rounds, Step step) {
+  Measure out;
+  const auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; ++round) {
+    stub::resetHeap();
+    const size_t live = stub::heap.liveBytes;
+    step();
+    out.peakBytes = max(out.peakBytes, stub::heap.peakBytes - live);
+  }
+  out.us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rounds;
+  return out;
+}
+
+}  // namespace
+
+void setUp() {
+  stub::resetFs();
+}
+
+void tearDown() {}
+
+void test_edit_save_and_reload() {
+  writeFile("/data/config.json", configJson(4));
+  DataStore store;
+  TEST_ASSERT_TRUE(store.load("config"));
+  TEST_ASSERT_EQUAL_INT(15000, store.data()["interval_ms"].as<int>());
+
+  store.edit()["interval_ms"] = 20000;
+  TEST_ASSERT_TRUE(store.isDirty());
+  TEST_ASSERT_TRUE(store.save());
+  TEST_ASSERT_FALSE(store.isDirty());
+
+  DataStore reloaded;
+  TEST_ASSERT_TRUE(reloaded.load("config"));
+  TEST_ASSERT_EQUAL_INT(20000, reloaded.data()["interval_ms"].as<int>());
+  TEST_ASSERT_FALSE(std::filesystem::exists(stub::fsRoot + "/data/config.json.tmp"));
+}
+
+void test_unchanged_document_is_not_written() {
+  writeFile("/data/config.json", configJson(4));
+  DataStore store;
+  store.load("config");
+
+  const uint64_t written = stub::fsBytesWritten;
+  TEST_ASSERT_TRUE(store.save());
+  SpiJsonDocument same;
+  same.set(store.data());
+  TEST_ASSERT_TRUE(store.save(same));
+  TEST_ASSERT_EQUAL_UINT32(written, stub::fsBytesWritten);
+
+  same["interval_ms"] = 30000;
+  TEST_ASSERT_TRUE(store.save(same));
+  TEST_ASSERT_TRUE(stub::fsBytesWritten > written);
+}
+
+void test_interrupted_save_keeps_the_old_file() {
+  const std::string original = configJson(4);
+  writeFile("/data/config.json", original);
+  DataStore store;
+  store.load("config");
+  store.edit()["interval_ms"] = 20000;
+
+  // flash full part way through the temp file
+  stub::fsWriteBudget = 16;
+  TEST_ASSERT_FALSE(store.save());
+  stub::fsWriteBudget = SIZE_MAX;
+  TEST_ASSERT_TRUE(readFile("/data/config.json") == original);
+  TEST_ASSERT_FALSE(std::filesystem::exists(stub::fsRoot + "/data/config.json.tmp"));
+
+  // a temp file left by a reset is dropped on the next load
+  writeFile("/data/config.json.tmp", "{\"torn\":");
+  DataStore reloaded;
+  TEST_ASSERT_TRUE(reloaded.load("config"));
+  TEST_ASSERT_EQUAL_INT(15000, reloaded.data()["interval_ms"].as<int>());
+  TEST_ASSERT_FALSE(std::filesystem::exists(stub::fsRoot + "/data/config.json.tmp"));
+}
+
+// Benchmark: peak heap and host time per load and per save of a 4 KB settings file, the old
+// String-buffered path against the streaming DataStore.
+void test_benchmark_peak_heap_and_time() {
+  static constexpr int kRounds = 200;
+  const std::string json = configJson(100);
+  writeFile("/data/config.json", json);
+
+  const Measure oldLoadCost = measure(kRounds, [] {
+    SpiJsonDocument document;
+    TEST_ASSERT_TRUE(oldLoad("/data/config.json", document));
+  });
+  const Measure newLoadCost = measure(kRounds, [] {
+    DataStore store;
+    TEST_ASSERT_TRUE(store.load("config"));
+  });
+
+  DataStore store;
+  store.load("config");
+  const Measure oldSaveCost = measure(kRounds, [&store] {
+    TEST_ASSERT_TRUE(oldSave("/data/other.json", store.data()));
+  });
+  int round = 0;
+  const Measure newSaveCost = measure(kRounds, [&store, &round] {
+    store.edit()["interval_ms"] = round++;
+    TEST_ASSERT_TRUE(store.save());
+  });
+
+  // the parsed document itself is the same on both paths
+  const Measure documentCost = measure(1, [&json] {
+    SpiJsonDocument document;
+    deserializeJson(document, json);
+  });
+
+  printf("datastore: %zu B file, document %zu B; load peak heap %zu -> %zu B, %.0f -> %.0f us; "
+         "save peak heap %zu -> %zu B, %.0f -> %.0f us (host)\n",
+         json.size(), documentCost.peakBytes, oldLoadCost.peakBytes, newLoadCost.peakBytes, oldLoadCost.us,
+         newLoadCost.us, oldSaveCost.peakBytes, newSaveCost.peakBytes, oldSaveCost.us, newSaveCost.us);
+
+  TEST_ASSERT_TRUE(newLoadCost.peakBytes < oldLoadCost.peakBytes);
+  TEST_ASSERT_TRUE(oldLoadCost.peakBytes - newLoadCost.peakBytes >= json.size());
+  TEST_ASSERT_TRUE(newSaveCost.peakBytes < oldSaveCost.peakBytes);
+  TEST_ASSERT_TRUE(readFile("/data/config.json").find("\"interval_ms\":199") != std::string::npos);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_edit_save_and_reload);
+  RUN_TEST(test_unchanged_document_is_not_written);
+  RUN_TEST(test_interrupted_save_keeps_the_old_file);
+  RUN_TEST(test_benchmark_peak_heap_and_time);
+  return UNITY_END();
+}
@@ -0,0 +1,163 @@
+#include <unity.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "app/sensor/dht_decoder.h"
+#include "traces.h"
+
+using namespace app::sensor;
+
+namespace {
+
+struct Capture {
+  std::vector<uint32_t> edgeUs;
+  std::vector<uint8_t> levels;
+};
+
+// Absolute timestamps as the ISR stores them; the 32-bit esp_timer value may wrap mid-frame.
+template <size_t N>
+Capture capture(const traces::Edge (&trace)[N], uint32_t startUs = 0xFFFFFF00u) {
+  Capture out;
+  uint32_t now = startUs;
+  for (const traces::Edge& edge : trace) {
+    now += edge.deltaUs;
+    out.edgeUs.push_back(now);
+    out.levels.push_back(edge.level);
+  }
+  return out;
+}
+
+DhtDecodeStatus decode(const Capture& capture, uint8_t (&raw)[5]) {
+  return decodeDhtEdges(capture.edgeUs.data(), capture.levels.data(), capture.edgeUs.size(), raw);
+}
+
+// A frame with every high pulse off by up to `jitterUs`, as a busy core would stamp it.
+Capture jitteredFrame(const uint8_t (&bytes)[5], uint32_t jitterUs, std::mt19937& rng) {
+  std::uniform_int_distribution<int> jitter(-static_cast<int>(jitterUs), static_cast<int>(jitterUs));
+  Capture out;
+  uint32_t now = 1000;
+  auto edge = [&](uint8_t level, int deltaUs) {
+    now += static_cast<uint32_t>(std::max(1, deltaUs));
+    out.edgeUs.push_back(now);
+    out.levels.push_back(level);
+  };
+  edge(0, 30);
+  edge(1, 80);
+  edge(0, 80);
+  for (size_t bit = 0; bit < kDhtFrameBits; ++bit) {
+    const bool one = ((bytes[bit / 8] >> (7 - bit % 8)) & 1) != 0;
+    edge(1, 50 + jitter(rng));
+    edge(0, (one ? 70 : 27) + jitter(rng));
+  }
+  edge(1, 50);
+  return out;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_dht22_room() {
+  uint8_t raw[5];
+  TEST_ASSERT_TRUE(decode(capture(traces::kDht22Room), raw) == DhtDecodeStatus::Ok);
+  const DhtReading reading = convertDhtBytes(raw, true);
+  TEST_ASSERT_TRUE(reading.valid);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 21.4f, reading.temperatureC);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 55.2f, reading.humidityPercent);
+}
+
+void test_dht22_negative_temperature() {
+  uint8_t raw[5];
+  TEST_ASSERT_TRUE(decode(capture(traces::kDht22Freezing), raw) == DhtDecodeStatus::Ok);
+  const DhtReading reading = convertDhtBytes(raw, true);
+  TEST_ASSERT_TRUE(reading.valid);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, -7.3f, reading.temperatureC);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 88.0f, reading.humidityPercent);
+}
+
+void test_dht11() {
+  uint8_t raw[5];
+  TEST_ASSERT_TRUE(decode(capture(traces::kDht11), raw) == DhtDecodeStatus::Ok);
+  const DhtReading reading = convertDhtBytes(raw, false);
+  TEST_ASSERT_TRUE(reading.valid);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 28.0f, reading.temperatureC);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 55.0f, reading.humidityPercent);
+}
+
+void test_missing_response_edges_and_late_isr() {
+  uint8_t raw[5];
+  TEST_ASSERT_TRUE(decode(capture(traces::kDht22LateStart), raw) == DhtDecodeStatus::Ok);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 23.9f, convertDhtBytes(raw, true).temperatureC);
+
+  TEST_ASSERT_TRUE(decode(capture(traces::kDht22LateIsr), raw) == DhtDecodeStatus::Ok);
+  const DhtReading reading = convertDhtBytes(raw, true);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 19.5f, reading.temperatureC);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 60.3f, reading.humidityPercent);
+}
+
+void test_broken_frames_are_reported() {
+  uint8_t raw[5];
+  TEST_ASSERT_TRUE(decode(capture(traces::kDht22BadChecksum), raw) == DhtDecodeStatus::BadChecksum);
+  // 39 bits plus the 80 us response pulse still make 40 high pulses; this one reads shifted by a
+  // bit and happens to pass the byte-sum checksum, the range check catches it
+  TEST_ASSERT_TRUE(decode(capture(traces::kDht22Truncated), raw) == DhtDecodeStatus::Ok);
+  TEST_ASSERT_FALSE(convertDhtBytes(raw, true).valid);
+  const Capture late = capture(traces::kDht22LateStart);
+  TEST_ASSERT_TRUE(decodeDhtEdges(late.edgeUs.data(), late.levels.data(), late.edgeUs.size() - 2, raw) ==
+                   DhtDecodeStatus::TooFewEdges);
+  TEST_ASSERT_TRUE(decodeDhtEdges(nullptr, nullptr, 0, raw) == DhtDecodeStatus::TooFewEdges);
+}
+
+// Benchmark: decode cost per frame, and how much timestamp jitter the 48 us threshold tolerates.
+void test_benchmark_decode_and_jitter() {
+  const Capture room = capture(traces::kDht22Room);
+  static constexpr int kDecodes = 200000;
+  uint8_t raw[5];
+  unsigned ok = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int index = 0; index < kDecodes; ++index) {
+    ok += decode(room, raw) == DhtDecodeStatus::Ok ? 1 : 0;
+  }
+  const double nsPerFrame =
+      std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kDecodes;
+  TEST_ASSERT_EQUAL_UINT32(kDecodes, ok);
+
+  std::mt19937 rng(33);
+  std::uniform_int_distribution<int> byte(0, 255);
+  static constexpr int kFrames = 5000;
+  printf("dht_decoder: %.0f ns per frame on the host, %zu edges\n", nsPerFrame, room.edgeUs.size());
+  for (uint32_t jitterUs : {0u, 10u, 15u, 20u, 25u}) {
+    int decoded = 0;
+    for (int frame = 0; frame < kFrames; ++frame) {
+      uint8_t bytes[5];
+      for (int index = 0; index < 4; ++index) {
+        bytes[index] = static_cast<uint8_t>(byte(rng));
+      }
+      bytes[4] = static_cast<uint8_t>(bytes[0] + bytes[1] + bytes[2] + bytes[3]);
+      const Capture jittered = jitteredFrame(bytes, jitterUs, rng);
+      if (decode(jittered, raw) == DhtDecodeStatus::Ok && memcmp(raw, bytes, sizeof(raw)) == 0) {
+        decoded++;
+      }
+    }
+    printf("dht_decoder: +-%2u us jitter: %5.1f%% of frames decoded\n", static_cast<unsigned>(jitterUs),
+           100.0 * decoded / kFrames);
+    // 0 bits are at most 28 us high and 1 bits at least 70 us, so up to 20 us either way is safe
+    if (jitterUs <= 20) {
+      TEST_ASSERT_EQUAL_INT(kFrames, decoded);
+    }
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_dht22_room);
+  RUN_TEST(test_dht22_negative_temperature);
+  RUN_TEST(test_dht11);
+  RUN_TEST(test_missing_response_edges_and_late_isr);
+  RUN_TEST(test_broken_frames_are_reported);
+  RUN_TEST(test_benchmark_decode_and_jitter);
+  return UNITY_END();
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// DHT edge traces in the form DhtSensor::onEdge records them: microseconds since the previous
+// edge and the line level right after it. Built from the DHT11/DHT22 datasheet timing (80 us
+// response, 50 us bit low, 26-28 us / 70 us bit high) with the ISR jitter noted per trace.
+
+namespace traces {
+
+struct Edge {
+  uint16_t deltaUs;
+  uint8_t level;
+};
+
+// DHT22, 21.4 C / 55.2 %RH, clean timing
+inline constexpr Edge kDht22Room[] = {
+    {1, 1}, {30, 0}, {80, 1}, {80, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0},
+    {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1},
+};
+
+// DHT22, -7.3 C / 88.0 %RH (sign bit), +-6 us jitter
+inline constexpr Edge kDht22Freezing[] = {
+    {3, 1}, {26, 0}, {84, 1}, {77, 0}, {48, 1}, {28, 0}, {54, 1}, {29, 0}, {52, 1}, {23, 0}, {54, 1}, {30, 0},
+    {52, 1}, {26, 0}, {54, 1}, {29, 0}, {51, 1}, {71, 0}, {48, 1}, {74, 0}, {54, 1}, {22, 0}, {48, 1}, {70, 0},
+    {48, 1}, {72, 0}, {51, 1}, {64, 0}, {55, 1}, {30, 0}, {55, 1}, {31, 0}, {50, 1}, {25, 0}, {49, 1}, {29, 0},
+    {56, 1}, {74, 0}, {47, 1}, {22, 0}, {44, 1}, {26, 0}, {48, 1}, {24, 0}, {45, 1}, {32, 0}, {49, 1}, {22, 0},
+    {54, 1}, {26, 0}, {56, 1}, {24, 0}, {52, 1}, {25, 0}, {49, 1}, {64, 0}, {49, 1}, {29, 0}, {54, 1}, {25, 0},
+    {52, 1}, {70, 0}, {50, 1}, {23, 0}, {54, 1}, {22, 0}, {44, 1}, {69, 0}, {54, 1}, {32, 0}, {54, 1}, {29, 0},
+    {45, 1}, {65, 0}, {46, 1}, {65, 0}, {45, 1}, {76, 0}, {49, 1}, {64, 0}, {44, 1}, {27, 0}, {48, 1}, {26, 0},
+    {47, 1},
+};
+
+// DHT11, 28 C / 55 %RH, +-6 us jitter
+inline constexpr Edge kDht11[] = {
+    {1, 1}, {34, 0}, {84, 1}, {80, 0}, {51, 1}, {30, 0}, {51, 1}, {33, 0}, {49, 1}, {73, 0}, {52, 1}, {71, 0},
+    {56, 1}, {25, 0}, {51, 1}, {65, 0}, {44, 1}, {71, 0}, {50, 1}, {70, 0}, {56, 1}, {33, 0}, {49, 1}, {22, 0},
+    {54, 1}, {24, 0}, {44, 1}, {29, 0}, {54, 1}, {28, 0}, {55, 1}, {26, 0}, {55, 1}, {23, 0}, {51, 1}, {32, 0},
+    {53, 1}, {28, 0}, {44, 1}, {32, 0}, {45, 1}, {30, 0}, {55, 1}, {68, 0}, {51, 1}, {68, 0}, {50, 1}, {72, 0},
+    {50, 1}, {25, 0}, {51, 1}, {30, 0}, {56, 1}, {28, 0}, {50, 1}, {21, 0}, {56, 1}, {27, 0}, {49, 1}, {33, 0},
+    {49, 1}, {23, 0}, {45, 1}, {23, 0}, {55, 1}, {26, 0}, {53, 1}, {25, 0}, {53, 1}, {23, 0}, {56, 1}, {75, 0},
+    {49, 1}, {27, 0}, {50, 1}, {76, 0}, {49, 1}, {31, 0}, {49, 1}, {33, 0}, {53, 1}, {74, 0}, {52, 1}, {64, 0},
+    {55, 1},
+};
+
+// DHT22, 23.9 C / 41.0 %RH, capture armed after the response pulse
+inline constexpr Edge kDht22LateStart[] = {
+    {1, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1},
+    {27, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1},
+    {70, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1},
+    {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1},
+    {27, 0}, {50, 1}, {70, 0}, {50, 1}, {70, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1},
+    {70, 0}, {50, 1}, {70, 0}, {50, 1}, {70, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1},
+    {27, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1},
+};
+
+// DHT22, 19.5 C / 60.3 %RH, one falling edge stamped 18 us late on a 0 bit
+inline constexpr Edge kDht22LateIsr[] = {
+    {1, 1}, {30, 0}, {80, 1}, {80, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {27, 0}, {50, 1}, {45, 0}, {32, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0},
+    {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {70, 0},
+    {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1},
+};
+
+// DHT22, checksum byte off by one
+inline constexpr Edge kDht22BadChecksum[] = {
+    {1, 1}, {30, 0}, {80, 1}, {80, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0},
+    {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0},
+    {50, 1},
+};
+
+// DHT22, 21.4 C / 55.2 %RH with one bit pulse lost, so the response pulse is read as bit 0
+inline constexpr Edge kDht22Truncated[] = {
+    {1, 1}, {30, 0}, {80, 1}, {80, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {70, 0},
+    {50, 1}, {27, 0}, {50, 1}, {70, 0}, {50, 1}, {70, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0},
+    {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1}, {27, 0}, {50, 1},
+};
+
+}  // namespace traces
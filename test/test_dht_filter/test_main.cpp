@@ -0,0 +1,168 @@
+#include <unity.h>
+
+#include <vector>
+
+#include "app/sensor/dht_filter.h"
+
+using app::sensor::DhtFilter;
+
+namespace {
+
+static constexpr uint32_t kIntervalMs = 15000;
+
+// One DhtSensor::read outcome; ok == false is a timeout or checksum failure.
+struct Read {
+  bool ok;
+  int16_t temperature10;
+  uint16_t humidity10;
+};
+
+struct Step {
+  uint32_t atMs;
+  DhtFilter::Result result;
+  DhtFilter::Output out;
+};
+
+// Feeds `reads` the way inputTask does: each read happens when the filter says it is due.
+std::vector<Step> replay(DhtFilter& filter, const std::vector<Read>& reads) {
+  uint32_t nowMs = 1000;
+  filter.begin(nowMs);
+  std::vector<Step> steps;
+  for (const Read& read : reads) {
+    while (!filter.due(nowMs)) {
+      nowMs += 100;
+    }
+    Step step = {nowMs, DhtFilter::Result::None, {}};
+    step.result = filter.onRead(nowMs, read.ok, read.temperature10, read.humidity10, step.out);
+    steps.push_back(step);
+  }
+  return steps;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+// DHT22 at room temperature with two corrupted frames in a row that still passed the checksum.
+void test_dht22_spike_is_rejected_and_never_published() {
+  DhtFilter filter(DhtFilter::defaultConfig(true, kIntervalMs));
+  const std::vector<Read> reads = {
+      {true, 231, 452}, {true, 232, 451}, {true, 231, 453}, {true, 233, 452}, {true, 232, 452},
+      {true, 712, 452},  // spike: +48 C in 15 s
+      {true, 232, 998},  // spike: +55 %RH
+      {true, 232, 454}, {true, 233, 453},
+  };
+  const auto steps = replay(filter, reads);
+
+  TEST_ASSERT_TRUE(steps[5].result == DhtFilter::Result::None);
+  TEST_ASSERT_TRUE(steps[6].result == DhtFilter::Result::None);
+  TEST_ASSERT_EQUAL_UINT32(2, filter.stats().stepRejected);
+  for (const Step& step : steps) {
+    if (step.result != DhtFilter::Result::None) {
+      TEST_ASSERT_INT_WITHIN(2, 232, step.out.temperature10);
+      TEST_ASSERT_INT_WITHIN(2, 452, step.out.humidity10);
+    }
+  }
+
+  // the window was full before the spike, so the median does not move
+  TEST_ASSERT_TRUE(steps[4].result == DhtFilter::Result::Publish);
+  TEST_ASSERT_EQUAL_INT16(232, steps[4].out.temperature10);
+  TEST_ASSERT_EQUAL_UINT8(5, steps[4].out.samples);
+  TEST_ASSERT_EQUAL_UINT8(100, steps[4].out.quality);
+
+  // each good sample in a full window forgives one rejection
+  TEST_ASSERT_TRUE(steps[7].result == DhtFilter::Result::Publish);
+  TEST_ASSERT_TRUE(steps[7].out.quality < 100);
+  TEST_ASSERT_EQUAL_UINT8(100, steps[8].out.quality);
+}
+
+// DHT22 that stops answering for a while: two retries at the 2 s minimum spacing, then the cycle
+// is given up and the next attempt waits a full interval. Nothing is published meanwhile.
+void test_dht22_timeout_burst_retries_then_waits() {
+  DhtFilter filter(DhtFilter::defaultConfig(true, kIntervalMs));
+  const std::vector<Read> reads = {
+      {true, 205, 610}, {false, 0, 0}, {false, 0, 0}, {false, 0, 0}, {false, 0, 0}, {true, 206, 608},
+  };
+  const auto steps = replay(filter, reads);
+
+  TEST_ASSERT_EQUAL_UINT32(2000, steps[2].atMs - steps[1].atMs);
+  TEST_ASSERT_EQUAL_UINT32(2000, steps[3].atMs - steps[2].atMs);
+  TEST_ASSERT_EQUAL_UINT32(kIntervalMs, steps[4].atMs - steps[3].atMs);
+  for (size_t index = 1; index < 5; ++index) {
+    TEST_ASSERT_TRUE(steps[index].result == DhtFilter::Result::None);
+  }
+  TEST_ASSERT_EQUAL_UINT32(4, filter.stats().failures);
+  TEST_ASSERT_EQUAL_UINT32(3, filter.stats().retries);
+
+  // the frame after one failed attempt scores lower than a clean one
+  TEST_ASSERT_EQUAL_UINT8(2, steps[5].out.samples);
+  TEST_ASSERT_EQUAL_INT16(205, steps[5].out.temperature10);
+  TEST_ASSERT_EQUAL_UINT16(609, steps[5].out.humidity10);
+  DhtFilter clean(DhtFilter::defaultConfig(true, kIntervalMs));
+  const auto cleanSteps = replay(clean, {reads[0], reads[5]});
+  TEST_ASSERT_TRUE(steps[5].out.quality < cleanSteps[1].out.quality);
+}
+
+// DHT11 whose first frames after power-up fail, then return a frame: one sample behind two failed
+// attempts is below minQuality and held back; the window filling up brings it over the gate.
+void test_dht11_cold_start_is_gated_until_the_window_fills() {
+  DhtFilter filter(DhtFilter::defaultConfig(false, kIntervalMs));
+  const std::vector<Read> reads = {
+      {false, 0, 0}, {false, 0, 0}, {true, 240, 500}, {true, 240, 510}, {true, 250, 510}, {true, 240, 500},
+  };
+  const auto steps = replay(filter, reads);
+
+  // DHT11 retries at its 1 s minimum spacing
+  TEST_ASSERT_EQUAL_UINT32(1000, steps[1].atMs - steps[0].atMs);
+  TEST_ASSERT_TRUE(steps[2].result == DhtFilter::Result::LowQuality);
+  TEST_ASSERT_EQUAL_UINT8(1, steps[2].out.samples);
+  TEST_ASSERT_EQUAL_UINT32(1, filter.stats().gated);
+
+  TEST_ASSERT_TRUE(steps[5].result == DhtFilter::Result::Publish);
+  TEST_ASSERT_EQUAL_INT16(240, steps[5].out.temperature10);
+  TEST_ASSERT_EQUAL_UINT16(505, steps[5].out.humidity10);
+  TEST_ASSERT_TRUE(steps[5].out.quality >= 50);
+}
+
+// DHT11 that latches 0 C / 0 %RH after a brownout: both are inside the DHT11 range, so the step
+// check is what catches it. After a window's worth of identical "outliers" the filter accepts the
+// new level and re-seeds, publishing from a one-sample window at reduced quality.
+void test_dht11_stuck_value_is_rejected_then_reseeds() {
+  DhtFilter filter(DhtFilter::defaultConfig(false, kIntervalMs));
+  std::vector<Read> reads(5, Read{true, 220, 480});
+  reads.insert(reads.end(), 6, Read{true, 0, 0});
+  const auto steps = replay(filter, reads);
+
+  for (size_t index = 5; index < 9; ++index) {
+    TEST_ASSERT_TRUE(steps[index].result == DhtFilter::Result::None);
+  }
+  TEST_ASSERT_EQUAL_UINT32(5, filter.stats().stepRejected);
+
+  TEST_ASSERT_TRUE(steps[9].result == DhtFilter::Result::Publish);
+  TEST_ASSERT_EQUAL_INT16(0, steps[9].out.temperature10);
+  TEST_ASSERT_EQUAL_UINT8(1, steps[9].out.samples);
+  TEST_ASSERT_TRUE(steps[9].out.quality < 100);
+  TEST_ASSERT_EQUAL_UINT8(2, steps[10].out.samples);
+}
+
+// Readings outside the sensor's range count as failures and go through the retry burst.
+void test_out_of_range_reading_is_retried() {
+  DhtFilter filter(DhtFilter::defaultConfig(false, kIntervalMs));
+  const auto steps = replay(filter, {{true, 220, 480}, {true, -10, 480}, {true, 221, 480}});
+
+  TEST_ASSERT_EQUAL_UINT32(1, filter.stats().rangeRejected);
+  TEST_ASSERT_EQUAL_UINT32(1, filter.stats().retries);
+  TEST_ASSERT_EQUAL_UINT32(1000, steps[2].atMs - steps[1].atMs);
+  TEST_ASSERT_TRUE(steps[2].result != DhtFilter::Result::None);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_dht22_spike_is_rejected_and_never_published);
+  RUN_TEST(test_dht22_timeout_burst_retries_then_waits);
+  RUN_TEST(test_dht11_cold_start_is_gated_until_the_window_fills);
+  RUN_TEST(test_dht11_stuck_value_is_rejected_then_reseeds);
+  RUN_TEST(test_out_of_range_reading_is_retried);
+  return UNITY_END();
+}
@@ -0,0 +1,163 @@
+#include <unity.h>
+
+#include <vector>
+
+#include "../test_dht_decoder/traces.h"
+#include "app/sensor/dht_sensor.h"
+#include "core/coro.h"
+
+using app::sensor::DhtReading;
+using app::sensor::DhtSensor;
+
+namespace {
+
+static constexpr uint8_t kPin = 4;
+static constexpr uint32_t kRadioPeriodMs = 10;
+
+uint32_t clock() {
+  return millis();
+}
+
+// Runs the executor like appTaskRunner: one pass, then sleep for what it returned (at least 1 ms).
+void run(coro::Executor& executor, uint32_t untilMs) {
+  while (static_cast<int32_t>(untilMs - millis()) > 0) {
+    const uint32_t idleMs = executor.runOnce();
+    stub::nowUs += static_cast<uint64_t>(idleMs > 0 ? idleMs : 1) * 1000;
+  }
+}
+
+// Stands in for the radio coroutine: wakes every 10 ms and records the longest gap.
+coro::Task radio(uint32_t* maxGapMs) {
+  uint32_t last = millis();
+  while (true) {
+    co_await coro::delay(kRadioPeriodMs);
+    *maxGapMs = max(*maxGapMs, static_cast<uint32_t>(millis() - last));
+    last = millis();
+  }
+}
+
+// The read as inputTask runs it.
+coro::Task inputRead(DhtSensor* sensor, DhtReading* reading, bool* ok) {
+  if (const uint32_t startLowMs = sensor->requestFrame()) {
+    co_await coro::delay(startLowMs);
+    if (const uint32_t captureMs = sensor->armCapture()) {
+      co_await coro::delay(captureMs);
+      *ok = sensor->finishFrame(*reading) && reading->valid;
+    }
+  }
+}
+
+bool captureArmed(void*) {
+  return stub::pinIsr != nullptr;
+}
+
+// The sensor's side of the line: once the capture is armed, answer with `trace`. The edges are
+// stamped ahead of the executor clock, which is left where it was.
+template <size_t N>
+coro::Task sensorLine(const traces::Edge (&trace)[N]) {
+  co_await coro::until(captureArmed);
+  const uint64_t armedUs = stub::nowUs;
+  for (const traces::Edge& edge : trace) {
+    stub::nowUs += edge.deltaUs;
+    stub::pinLevels[kPin] = edge.level;
+    stub::pinIsr(stub::pinIsrArg);
+  }
+  stub::nowUs = armedUs;
+}
+
+// How long the line was held low by the last start pulse, from the GPIO log.
+uint64_t startPulseUs() {
+  uint64_t lowAtUs = 0;
+  for (const stub::PinEvent& event : stub::pinLog) {
+    if (event.mode == OUTPUT && event.level == LOW) {
+      lowAtUs = event.atUs;
+    } else if (event.mode == INPUT_PULLUP && lowAtUs != 0) {
+      return event.atUs - lowAtUs;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+void setUp() {
+  stub::nowUs = 1000000;
+  stub::resetPins();
+  coro::frameArena = {};
+}
+
+void tearDown() {}
+
+// Regression: the DHT11's 20 ms start pulse is awaited. The radio keeps its 10 ms period through
+// the pulse and the capture window, and the line is low for the full 20 ms.
+void test_dht11_start_pulse_is_awaited() {
+  DhtSensor sensor;
+  TEST_ASSERT_TRUE(sensor.begin(kPin, false));
+  TEST_ASSERT_EQUAL_UINT32(20, sensor.startLowMs());
+
+  DhtReading reading;
+  bool ok = false;
+  uint32_t maxGapMs = 0;
+  coro::Executor executor(clock, 50);
+  TEST_ASSERT_TRUE(executor.spawn("radio", radio(&maxGapMs)));
+  TEST_ASSERT_TRUE(executor.spawn("line", sensorLine(traces::kDht11)));
+  TEST_ASSERT_TRUE(executor.spawn("input", inputRead(&sensor, &reading, &ok)));
+  run(executor, millis() + 100);
+
+  TEST_ASSERT_TRUE(ok);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 28.0f, reading.temperatureC);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 55.0f, reading.humidityPercent);
+  TEST_ASSERT_TRUE(startPulseUs() >= 20000);
+  TEST_ASSERT_TRUE(startPulseUs() < 22000);
+  TEST_ASSERT_EQUAL_UINT32(kRadioPeriodMs, maxGapMs);
+}
+
+// A caller that releases the line without awaiting the start pulse gets a failed read at once,
+// not a busy-wait for the rest of the pulse.
+void test_release_before_the_start_pulse_fails_the_read() {
+  DhtSensor sensor;
+  sensor.begin(kPin, false);
+  TEST_ASSERT_EQUAL_UINT32(20, sensor.requestFrame());
+
+  const uint64_t before = stub::nowUs;
+  stub::nowUs += 5000;
+  TEST_ASSERT_EQUAL_UINT32(0, sensor.armCapture());
+  TEST_ASSERT_TRUE(stub::nowUs == before + 5000);
+  TEST_ASSERT_EQUAL_UINT8(INPUT_PULLUP, stub::pinModes[kPin]);
+  TEST_ASSERT_NULL(stub::pinIsr);
+
+  DhtReading reading;
+  TEST_ASSERT_FALSE(sensor.finishFrame(reading));
+  TEST_ASSERT_FALSE(reading.valid);
+}
+
+void test_dht22_start_pulse_and_capture_window() {
+  DhtSensor sensor;
+  sensor.begin(kPin, true);
+  TEST_ASSERT_EQUAL_UINT32(2, sensor.requestFrame());
+  stub::nowUs += 2000;
+  TEST_ASSERT_EQUAL_UINT32(DhtSensor::kCaptureWindowMs, sensor.armCapture());
+  TEST_ASSERT_NOT_NULL(stub::pinIsr);
+
+  // nothing answered: incomplete frame, interrupt detached
+  stub::nowUs += DhtSensor::kCaptureWindowMs * 1000;
+  DhtReading reading;
+  TEST_ASSERT_FALSE(sensor.finishFrame(reading));
+  TEST_ASSERT_NULL(stub::pinIsr);
+}
+
+void test_unstarted_sensor_does_not_touch_the_line() {
+  DhtSensor sensor;
+  TEST_ASSERT_EQUAL_UINT32(0, sensor.requestFrame());
+  TEST_ASSERT_EQUAL_UINT32(0, sensor.armCapture());
+  TEST_ASSERT_TRUE(stub::pinLog.empty());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_dht11_start_pulse_is_awaited);
+  RUN_TEST(test_release_before_the_start_pulse_fails_the_read);
+  RUN_TEST(test_dht22_start_pulse_and_capture_window);
+  RUN_TEST(test_unstarted_sensor_does_not_touch_the_line);
+  return UNITY_END();
+}
@@ -0,0 +1,162 @@
+#include <unity.h>
+
+#include <LittleFS.h>
+#include <esp_log.h>
+
+#include <string>
+
+#include <ArenaJsonDocument.h>
+#include <SpiJsonDocument.h>
+
+// ArduinoJson's slot pools are 4 KB on a 64-bit host and 1 KB on the ESP32, so the host needs
+// twice the device arena for the same document.
+#define DATASTORE_ARENA_BYTES 8192
+#include "core/datastore.h"
+
+namespace {
+
+static constexpr size_t kArenaBytes = DATASTORE_ARENA_BYTES;
+
+// A settings file like the ones DataStore keeps: 40 members, strings, numbers and nesting.
+std::string configJson() {
+  std::string json = "{\"device\":\"pio-weather\",\"wifi\":{\"ssid\":\"greenhouse-2g\",\"channel\":6},\"settings\":{";
+  char member[64];
+  for (int index = 0; index < 40; ++index) {
+    snprintf(member, sizeof(member), "%s\"setting_%02d\":\"value number %d\"", index == 0 ? "" : ",", index,
+             index * 37);
+    json += member;
+  }
+  return json + "},\"areas\":[1,5,9],\"interval_ms\":15000}";
+}
+
+void writeFile(const char* path, const std::string& text) {
+  LittleFS.mkdir("/data");
+  File file = LittleFS.open(path, "w");
+  file.write(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+}  // namespace
+
+void setUp() {
+  stub::resetFs();
+}
+
+void tearDown() {}
+
+void test_last_allocation_pops_and_grows_in_place() {
+  ArenaAllocator arena(256);
+  void* first = arena.allocate(10);
+  const size_t afterFirst = arena.stats().used;
+  void* second = arena.allocate(20);
+  TEST_ASSERT_TRUE(afterFirst < arena.stats().used);
+
+  // the newest block grows in place, an older one has to move
+  TEST_ASSERT_TRUE(arena.reallocate(second, 60) == second);
+  arena.deallocate(second);
+  TEST_ASSERT_EQUAL_size_t(afterFirst, arena.stats().used);
+
+  arena.deallocate(first);  // not the newest any more: waits for the bulk release
+  TEST_ASSERT_EQUAL_size_t(afterFirst, arena.stats().used);
+  TEST_ASSERT_EQUAL_UINT32(2, arena.stats().allocations);
+  TEST_ASSERT_EQUAL_UINT32(0, arena.stats().fallbackAllocations);
+}
+
+void test_moved_block_keeps_its_bytes() {
+  ArenaAllocator arena(256);
+  auto* first = static_cast<char*>(arena.allocate(8));
+  memcpy(first, "abcdefg", 8);
+  arena.allocate(8);
+  auto* moved = static_cast<char*>(arena.reallocate(first, 32));
+  TEST_ASSERT_TRUE(moved != first);
+  TEST_ASSERT_EQUAL_STRING("abcdefg", moved);
+}
+
+void test_overflow_falls_back_to_the_heap() {
+  const uint32_t blocks = stub::heap.liveBlocks;
+  {
+    ArenaAllocator arena(64);
+    void* big = arena.allocate(100);
+    TEST_ASSERT_NOT_NULL(big);
+    TEST_ASSERT_EQUAL_UINT32(1, arena.stats().fallbackAllocations);
+    TEST_ASSERT_EQUAL_size_t(100, arena.stats().fallbackBytes);
+    arena.deallocate(big);
+  }
+  TEST_ASSERT_EQUAL_UINT32(blocks, stub::heap.liveBlocks);
+}
+
+void test_release_rewinds_the_arena() {
+  const std::string json = configJson();
+  ArenaJsonDocument document(kArenaBytes);
+  TEST_ASSERT_FALSE(deserializeJson(document, json));
+  const size_t used = document.arenaStats().used;
+  TEST_ASSERT_GREATER_THAN(0, used);
+
+  document.release();
+  TEST_ASSERT_EQUAL_size_t(0, document.arenaStats().used);
+  TEST_ASSERT_FALSE(deserializeJson(document, json));
+  TEST_ASSERT_EQUAL_size_t(used, document.arenaStats().used);
+  TEST_ASSERT_EQUAL_UINT32(0, document.arenaStats().fallbackAllocations);
+  TEST_ASSERT_EQUAL_STRING("greenhouse-2g", document["wifi"]["ssid"].as<const char*>());
+}
+
+void test_datastore_reloads_into_the_same_arena() {
+  writeFile("/data/config.json", configJson());
+  DataStore store;
+  TEST_ASSERT_TRUE(store.load("config"));
+  const size_t used = store.arenaStats().used;
+  TEST_ASSERT_TRUE(store.load("config"));
+  TEST_ASSERT_EQUAL_size_t(used, store.arenaStats().used);
+  TEST_ASSERT_EQUAL_UINT32(0, store.arenaStats().fallbackAllocations);
+  TEST_ASSERT_EQUAL_INT(15000, store.data()["interval_ms"].as<int>());
+}
+
+// Benchmark: heap calls per parse-and-drop of the settings file and heap blocks one parsed
+// document holds (each one a hole when it is dropped), SpiJsonDocument against
+// ArenaJsonDocument.
+void test_benchmark_allocations_and_fragmentation() {
+  static constexpr int kParses = 1000;
+  const std::string json = configJson();
+
+  uint32_t spiBlocks = 0;
+  stub::resetHeap();
+  for (int parse = 0; parse < kParses; ++parse) {
+    SpiJsonDocument document;
+    const uint32_t before = stub::heap.liveBlocks;
+    TEST_ASSERT_FALSE(deserializeJson(document, json));
+    spiBlocks = stub::heap.liveBlocks - before;
+  }
+  const double spiCalls = static_cast<double>(stub::heap.calls) / kParses;
+
+  uint32_t arenaBlocks = 0;
+  ArenaStats arena;
+  stub::resetHeap();
+  for (int parse = 0; parse < kParses; ++parse) {
+    const uint32_t before = stub::heap.liveBlocks;
+    ArenaJsonDocument document(kArenaBytes);
+    TEST_ASSERT_FALSE(deserializeJson(document, json));
+    arenaBlocks = stub::heap.liveBlocks - before;
+    arena = document.arenaStats();
+  }
+  const double arenaCalls = static_cast<double>(stub::heap.calls) / kParses;
+
+  printf("json_arena: %zu B document, %d parses: SpiJsonDocument %.1f heap calls and %lu live blocks per parse, "
+         "ArenaJsonDocument(%zu) %.1f heap calls and %lu live blocks, high water %zu B, %lu fallbacks\n",
+         json.size(), kParses, spiCalls, static_cast<unsigned long>(spiBlocks), kArenaBytes, arenaCalls,
+         static_cast<unsigned long>(arenaBlocks), arena.highWater, static_cast<unsigned long>(arena.fallbackAllocations));
+
+  TEST_ASSERT_EQUAL_UINT32(0, arena.fallbackAllocations);
+  TEST_ASSERT_EQUAL_UINT32(1, arenaBlocks);
+  TEST_ASSERT_TRUE(arenaCalls < spiCalls);
+  TEST_ASSERT_TRUE(arenaBlocks < spiBlocks);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_last_allocation_pops_and_grows_in_place);
+  RUN_TEST(test_moved_block_keeps_its_bytes);
+  RUN_TEST(test_overflow_falls_back_to_the_heap);
+  RUN_TEST(test_release_rewinds_the_arena);
+  RUN_TEST(test_datastore_reloads_into_the_same_arena);
+  RUN_TEST(test_benchmark_allocations_and_fragmentation);
+  return UNITY_END();
+}
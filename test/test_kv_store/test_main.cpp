@@ -0,0 +1,175 @@
+#include <unity.h>
+
+#include <LittleFS.h>
+
+#include <chrono>
+#include <filesystem>
+
+#include "app/storage/kv_store.h"
+
+using app::storage::KvStore;
+
+namespace {
+
+static constexpr uint8_t kDeadPercent = 50;
+static constexpr uint32_t kMinBytes = 256;
+
+String getString(KvStore& store, const char* key) {
+  String value;
+  store.get(key, value);
+  return value;
+}
+
+uintmax_t logFileBytes() {
+  return std::filesystem::file_size(stub::fsRoot + "/data/test.log");
+}
+
+}  // namespace
+
+void setUp() {
+  stub::resetFs();
+}
+
+void tearDown() {}
+
+void test_put_get_remove_and_replay() {
+  {
+    KvStore store("test", kDeadPercent, kMinBytes);
+    TEST_ASSERT_TRUE(store.begin());
+    TEST_ASSERT_TRUE(store.put("a", String("one")));
+    TEST_ASSERT_TRUE(store.put("b", String("two")));
+    TEST_ASSERT_TRUE(store.put("a", String("three")));
+    TEST_ASSERT_TRUE(store.remove("b"));
+    TEST_ASSERT_TRUE(getString(store, "a") == "three");
+    TEST_ASSERT_FALSE(store.contains("b"));
+  }
+
+  // a fresh instance rebuilds the index from the log
+  KvStore store("test", kDeadPercent, kMinBytes);
+  TEST_ASSERT_TRUE(store.begin());
+  TEST_ASSERT_TRUE(getString(store, "a") == "three");
+  TEST_ASSERT_FALSE(store.contains("b"));
+  TEST_ASSERT_EQUAL_UINT16(1, store.stats().keys);
+}
+
+void test_torn_tail_is_dropped_on_replay() {
+  {
+    KvStore store("test", kDeadPercent, kMinBytes);
+    store.begin();
+    store.put("a", String("one"));
+    store.put("b", String("two"));
+  }
+  std::filesystem::resize_file(stub::fsRoot + "/data/test.log", logFileBytes() - 2);
+
+  KvStore store("test", kDeadPercent, kMinBytes);
+  TEST_ASSERT_TRUE(store.begin());
+  TEST_ASSERT_TRUE(getString(store, "a") == "one");
+  TEST_ASSERT_FALSE(store.contains("b"));
+  TEST_ASSERT_GREATER_THAN(0, store.stats().droppedBytes);
+  // the valid prefix was rewritten, so a new record lands right behind it
+  TEST_ASSERT_TRUE(store.put("c", String("four")));
+  TEST_ASSERT_EQUAL_UINT32(store.stats().logBytes, logFileBytes());
+}
+
+void test_short_write_does_not_strand_later_records() {
+  KvStore store("test", kDeadPercent, kMinBytes);
+  store.begin();
+  TEST_ASSERT_TRUE(store.put("a", String("one")));
+
+  // flash full mid-record: the partial record stays behind until a compaction fits
+  stub::fsWriteBudget = 5;
+  TEST_ASSERT_FALSE(store.put("b", String("two")));
+  TEST_ASSERT_FALSE(store.put("c", String("three")));
+  TEST_ASSERT_FALSE(store.contains("b"));
+
+  stub::fsWriteBudget = SIZE_MAX;
+  TEST_ASSERT_TRUE(store.put("c", String("three")));
+  TEST_ASSERT_TRUE(getString(store, "c") == "three");
+  TEST_ASSERT_EQUAL_UINT32(store.stats().logBytes, logFileBytes());
+
+  KvStore replayed("test", kDeadPercent, kMinBytes);
+  replayed.begin();
+  TEST_ASSERT_TRUE(getString(replayed, "a") == "one");
+  TEST_ASSERT_TRUE(getString(replayed, "c") == "three");
+  TEST_ASSERT_EQUAL_UINT32(0, replayed.stats().droppedBytes);
+}
+
+void test_compaction_keeps_keys_when_the_log_is_unreadable() {
+  KvStore store("test", kDeadPercent, kMinBytes);
+  store.begin();
+  store.put("a", String("one"));
+  store.put("a", String("two"));
+  TEST_ASSERT_TRUE(store.compact());
+  TEST_ASSERT_EQUAL_UINT32(1, store.stats().compactions);
+  TEST_ASSERT_TRUE(getString(store, "a") == "two");
+
+  std::filesystem::remove(stub::fsRoot + "/data/test.log");
+  TEST_ASSERT_FALSE(store.compact());
+  TEST_ASSERT_EQUAL_UINT16(1, store.stats().keys);
+  TEST_ASSERT_FALSE(std::filesystem::exists(stub::fsRoot + "/data/test.log"));
+}
+
+// Benchmark: 30 days of 8 small settings saved every 15 min plus the 220-byte proxy report every
+// hour, against rewriting one file per save. Bytes appended (compaction copies included) and
+// get() cost on the host.
+void test_benchmark_thirty_days() {
+  KvStore store("test", KV_COMPACT_DEAD_PERCENT, KV_COMPACT_MIN_BYTES);
+  store.begin();
+
+  String report;
+  for (int index = 0; index < 220; ++index) {
+    report += static_cast<char>('a' + index % 26);
+  }
+
+  uint32_t saves = 0;
+  uint64_t payloadBytes = 0;
+  char key[16];
+  char value[16];
+  for (uint32_t quarter = 0; quarter < 30 * 24 * 4; ++quarter) {
+    for (int setting = 0; setting < 8; ++setting) {
+      snprintf(key, sizeof(key), "setting.%d", setting);
+      snprintf(value, sizeof(value), "%lu", static_cast<unsigned long>(quarter * 8 + setting));
+      TEST_ASSERT_TRUE(store.put(key, String(value)));
+      payloadBytes += strlen(key) + strlen(value);
+      saves++;
+    }
+    if (quarter % 4 == 0) {
+      TEST_ASSERT_TRUE(store.put("weather.last_report", report));
+      payloadBytes += strlen("weather.last_report") + report.length();
+      saves++;
+    }
+    store.loop();
+  }
+
+  static constexpr int kGets = 20000;
+  const auto start = std::chrono::steady_clock::now();
+  size_t got = 0;
+  for (int index = 0; index < kGets; ++index) {
+    got += getString(store, "weather.last_report").length();
+  }
+  const double usPerGet =
+      std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / kGets;
+
+  const auto stats = store.stats();
+  printf("kv_store: %lu saves in 30 days (rewrite-per-save: %lu file creations); log %.0f KB appended "
+         "including %lu compactions, %.1fx the %.0f KB payload; get %.1f us on the host\n",
+         static_cast<unsigned long>(saves), static_cast<unsigned long>(saves), stats.bytesWritten / 1024.0,
+         static_cast<unsigned long>(stats.compactions), static_cast<double>(stats.bytesWritten) / payloadBytes,
+         payloadBytes / 1024.0, usPerGet);
+
+  TEST_ASSERT_EQUAL_size_t(kGets * report.length(), got);
+  TEST_ASSERT_EQUAL_UINT16(9, stats.keys);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.writeErrors);
+  TEST_ASSERT_GREATER_THAN(0, stats.compactions);
+  TEST_ASSERT_TRUE(stats.logBytes < KV_COMPACT_MIN_BYTES * 2);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_put_get_remove_and_replay);
+  RUN_TEST(test_torn_tail_is_dropped_on_replay);
+  RUN_TEST(test_short_write_does_not_strand_later_records);
+  RUN_TEST(test_compaction_keeps_keys_when_the_log_is_unreadable);
+  RUN_TEST(test_benchmark_thirty_days);
+  return UNITY_END();
+}
@@ -0,0 +1,151 @@
+#include <unity.h>
+
+#include <LittleFS.h>
+
+#include "app/storage/kv_store.h"
+#include "app/storage/persistence.h"
+
+using app::storage::kvStore;
+using app::storage::Persistence;
+
+namespace {
+
+static constexpr uint32_t kWindowMs = 10UL * 60UL * 1000UL;
+
+void advanceMs(uint32_t ms) {
+  stub::nowUs += static_cast<uint64_t>(ms) * 1000;
+}
+
+uint32_t kvPuts() {
+  return kvStore.stats().puts;
+}
+
+String stored(const char* key) {
+  String value;
+  kvStore.get(key, value);
+  return value;
+}
+
+}  // namespace
+
+// kvStore is a global the persistence layer writes through, so the filesystem is reset once and
+// every test uses its own keys.
+void setUp() {}
+void tearDown() {}
+
+void test_changes_wait_for_the_window() {
+  Persistence persistence(kWindowMs);
+  persistence.begin();
+  const uint32_t puts = kvPuts();
+
+  TEST_ASSERT_TRUE(persistence.save("window.a", String("1")));
+  TEST_ASSERT_TRUE(persistence.save("window.a", String("2")));
+  persistence.loop(millis(), false);
+  TEST_ASSERT_EQUAL_UINT32(puts, kvPuts());
+
+  // staged values are what load() returns
+  String value;
+  TEST_ASSERT_TRUE(persistence.load("window.a", value));
+  TEST_ASSERT_TRUE(value == "2");
+
+  advanceMs(kWindowMs);
+  persistence.loop(millis(), false);
+  TEST_ASSERT_EQUAL_UINT32(puts + 1, kvPuts());
+  TEST_ASSERT_TRUE(stored("window.a") == "2");
+  TEST_ASSERT_EQUAL_UINT32(1, persistence.stats().coalesced);
+  TEST_ASSERT_EQUAL_UINT8(0, persistence.stats().pending);
+}
+
+void test_urgent_flush_skips_the_window() {
+  Persistence persistence(kWindowMs);
+  persistence.begin();
+  persistence.save("urgent.a", String("x"));
+  persistence.loop(millis(), true);
+  TEST_ASSERT_TRUE(stored("urgent.a") == "x");
+}
+
+void test_unchanged_value_costs_nothing_after_reboot() {
+  {
+    Persistence persistence(kWindowMs);
+    persistence.begin();
+    persistence.save("reboot.a", String("same"));
+    TEST_ASSERT_TRUE(persistence.flush());
+  }
+
+  // a new instance hashes the stored value on first use
+  Persistence persistence(kWindowMs);
+  persistence.begin();
+  const uint32_t puts = kvPuts();
+  persistence.save("reboot.a", String("same"));
+  TEST_ASSERT_TRUE(persistence.flush());
+  TEST_ASSERT_EQUAL_UINT32(puts, kvPuts());
+  TEST_ASSERT_EQUAL_UINT32(1, persistence.stats().skippedUnchanged);
+
+  // changing the value and back before the flush leaves nothing to write
+  persistence.save("reboot.a", String("other"));
+  persistence.save("reboot.a", String("same"));
+  TEST_ASSERT_EQUAL_UINT8(0, persistence.stats().pending);
+}
+
+void test_failed_write_stays_pending() {
+  Persistence persistence(kWindowMs);
+  persistence.begin();
+  persistence.save("fail.a", String("value"));
+  stub::fsFailOpen = true;
+  TEST_ASSERT_FALSE(persistence.flush());
+  TEST_ASSERT_EQUAL_UINT8(1, persistence.stats().pending);
+  stub::fsFailOpen = false;
+  TEST_ASSERT_TRUE(persistence.flush());
+  TEST_ASSERT_TRUE(stored("fail.a") == "value");
+}
+
+// Benchmark: flash writes for 30 days of the hourly proxy-request refresh (the same URL every
+// time) and for a key that changes every minute for a day, against writing on every save.
+void test_benchmark_writes_saved() {
+  Persistence persistence(kWindowMs);
+  persistence.begin();
+
+  const String report("/v1/forecast?latitude=52.52&longitude=13.41&current_weather=true&timezone=auto");
+  uint32_t puts = kvPuts();
+  static constexpr uint32_t kHours = 30 * 24;
+  for (uint32_t hour = 0; hour < kHours; ++hour) {
+    persistence.save("bench.report", report);
+    for (int minute = 0; minute < 60; ++minute) {
+      advanceMs(60UL * 1000UL);
+      persistence.loop(millis(), false);
+    }
+  }
+  const uint32_t reportWrites = kvPuts() - puts;
+
+  puts = kvPuts();
+  static constexpr uint32_t kMinutes = 24 * 60;
+  for (uint32_t minute = 0; minute < kMinutes; ++minute) {
+    persistence.save("bench.counter", String(static_cast<unsigned long>(minute)));
+    advanceMs(60UL * 1000UL);
+    persistence.loop(millis(), false);
+  }
+  persistence.flush();
+  const uint32_t counterWrites = kvPuts() - puts;
+
+  printf("persistence: hourly identical report for 30 days: %lu writes instead of %lu; key changing every "
+         "minute for a day: %lu writes instead of %lu\n",
+         static_cast<unsigned long>(reportWrites), static_cast<unsigned long>(kHours),
+         static_cast<unsigned long>(counterWrites), static_cast<unsigned long>(kMinutes));
+
+  TEST_ASSERT_EQUAL_UINT32(1, reportWrites);
+  TEST_ASSERT_TRUE(counterWrites <= kMinutes * 60000UL / kWindowMs + 1);
+  TEST_ASSERT_TRUE(stored("bench.counter") == String(static_cast<unsigned long>(kMinutes - 1)));
+}
+
+int main() {
+  stub::resetFs();
+  kvStore.begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_changes_wait_for_the_window);
+  RUN_TEST(test_urgent_flush_skips_the_window);
+  RUN_TEST(test_unchanged_value_costs_nothing_after_reboot);
+  RUN_TEST(test_failed_write_stays_pending);
+  RUN_TEST(test_benchmark_writes_saved);
+  return UNITY_END();
+}
@@ -0,0 +1,172 @@
+#include <unity.h>
+
+#include <string>
+
+#include "app/espnow/proxy_frames.h"
+
+using namespace app::espnow;
+
+namespace {
+
+// 802.11 vendor-specific action frame around every ESP-NOW payload (MAC header, category, OUI,
+// random bytes, vendor element, FCS)
+static constexpr size_t kMacOverheadBytes = 43;
+// link chunk size when the master leaves it to the slave: largest payload minus the chunk header
+static constexpr size_t kLargeChunkBytes = MAX_LARGE_PAYLOAD_SIZE - sizeof(state_binary::ProxyRespChunkLargeCommand);
+
+struct Totals {
+  size_t frames = 0;
+  size_t airBytes = 0;
+  bool built = true;
+};
+
+// telemetry_batch body for `readings` readings: {"d":"<device>","r":[[kind,ageS,a,b],...]}
+std::string telemetryBody(size_t readings) {
+  std::string body = "{\"d\":\"pio-weather\",\"r\":[";
+  for (size_t index = 0; index < readings; ++index) {
+    char reading[48];
+    snprintf(reading, sizeof(reading), "%s[%u,%u,%d,%d]", index == 0 ? "" : ",", static_cast<unsigned>(index % 3),
+             static_cast<unsigned>(300 - index * 15), 281 + static_cast<int>(index % 7), 655 - static_cast<int>(index));
+    body += reading;
+  }
+  return body + "]}";
+}
+
+Totals uploadTotals(const std::string& body, bool large) {
+  Totals totals;
+  uint8_t frame[MAX_LARGE_PAYLOAD_SIZE];
+  const size_t capacity = large ? MAX_LARGE_PAYLOAD_SIZE : MAX_PAYLOAD_SIZE;
+  const size_t chunkBytes = proxy_frames::bodyChunkBytes(large, kLargeChunkBytes);
+  const size_t chunks = (body.size() + chunkBytes - 1) / chunkBytes;
+
+  totals.frames = 1;
+  totals.airBytes = proxy_frames::frameAirBytes(sizeof(state_binary::ProxyUploadState)) + kMacOverheadBytes;
+  for (size_t index = 0; index < chunks; ++index) {
+    const size_t offset = index * chunkBytes;
+    const size_t length = std::min(body.size() - offset, chunkBytes);
+    const size_t size = proxy_frames::buildBodyChunk(frame, capacity, large, 7, static_cast<uint16_t>(index + 1),
+                                                     static_cast<uint16_t>(chunks),
+                                                     reinterpret_cast<const uint8_t*>(body.data()) + offset, length);
+    totals.built = totals.built && size > 0;
+    totals.frames++;
+    totals.airBytes += proxy_frames::frameAirBytes(size) + kMacOverheadBytes;
+  }
+  return totals;
+}
+
+Totals templateTotals(const char* text, bool large) {
+  Totals totals;
+  uint8_t frame[MAX_LARGE_PAYLOAD_SIZE];
+  const size_t capacity = large ? MAX_LARGE_PAYLOAD_SIZE : MAX_PAYLOAD_SIZE;
+  const size_t partBytes = proxy_frames::templateTextBytes(large, kLargeChunkBytes);
+  const size_t length = strlen(text);
+  const size_t parts = (length + partBytes - 1) / partBytes;
+  for (size_t part = 0; part < parts; ++part) {
+    const size_t offset = part * partBytes;
+    const size_t size = proxy_frames::buildTemplatePart(frame, capacity, large, 2, state_binary::HttpMethod::Post,
+                                                        static_cast<uint8_t>(part + 1), static_cast<uint8_t>(parts),
+                                                        text + offset, std::min(length - offset, partBytes));
+    totals.built = totals.built && size > 0;
+    totals.frames++;
+    totals.airBytes += proxy_frames::frameAirBytes(size) + kMacOverheadBytes;
+  }
+  return totals;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_v1_chunk_is_the_fixed_struct() {
+  uint8_t frame[MAX_PAYLOAD_SIZE];
+  const uint8_t data[] = {1, 2, 3};
+  const size_t size = proxy_frames::buildBodyChunk(frame, sizeof(frame), false, 9, 2, 5, data, sizeof(data));
+  TEST_ASSERT_EQUAL_size_t(sizeof(state_binary::ProxyBodyChunkState), size);
+
+  state_binary::ProxyBodyChunkState chunk;
+  memcpy(&chunk, frame, sizeof(chunk));
+  TEST_ASSERT_TRUE(state_binary::hasTypeAndSize(frame, size, state_binary::Type::ProxyBodyChunk, sizeof(chunk)));
+  TEST_ASSERT_EQUAL_UINT16(9, chunk.uploadId);
+  TEST_ASSERT_EQUAL_UINT16(2, chunk.idx);
+  TEST_ASSERT_EQUAL_UINT16(5, chunk.total);
+  TEST_ASSERT_EQUAL_UINT8(3, chunk.dataLen);
+  TEST_ASSERT_EQUAL_MEMORY(data, chunk.data, sizeof(data));
+
+  const uint8_t tooLong[state_binary::kProxyChunkDataBytes + 1] = {0};
+  TEST_ASSERT_EQUAL_size_t(0, proxy_frames::buildBodyChunk(frame, sizeof(frame), false, 9, 1, 1, tooLong, sizeof(tooLong)));
+}
+
+void test_large_chunk_carries_only_its_data() {
+  static uint8_t frame[MAX_LARGE_PAYLOAD_SIZE];
+  static uint8_t data[kLargeChunkBytes];
+  for (size_t index = 0; index < sizeof(data); ++index) {
+    data[index] = static_cast<uint8_t>(index);
+  }
+
+  const size_t size = proxy_frames::buildBodyChunk(frame, sizeof(frame), true, 4, 1, 1, data, sizeof(data));
+  TEST_ASSERT_EQUAL_size_t(sizeof(state_binary::ProxyBodyChunkLargeState) + sizeof(data), size);
+  TEST_ASSERT_LESS_OR_EQUAL(MAX_LARGE_PAYLOAD_SIZE, size);
+
+  state_binary::ProxyBodyChunkLargeState chunk;
+  memcpy(&chunk, frame, sizeof(chunk));
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(state_binary::Type::ProxyBodyChunkLarge), chunk.header.type);
+  TEST_ASSERT_EQUAL_UINT16(sizeof(data), chunk.dataLen);
+  TEST_ASSERT_EQUAL_MEMORY(data, frame + sizeof(chunk), sizeof(data));
+
+  // a frame that does not fit the buffer is refused, not truncated
+  TEST_ASSERT_EQUAL_size_t(0, proxy_frames::buildBodyChunk(frame, size - 1, true, 4, 1, 1, data, sizeof(data)));
+}
+
+void test_template_parts_follow_the_link() {
+  uint8_t frame[MAX_LARGE_PAYLOAD_SIZE];
+  const char* text = "https://example.org/upload";
+  const size_t length = strlen(text);
+
+  size_t size = proxy_frames::buildTemplatePart(frame, sizeof(frame), false, 3, state_binary::HttpMethod::Post, 1, 1,
+                                                text, length);
+  TEST_ASSERT_EQUAL_size_t(sizeof(state_binary::ProxyTemplateState), size);
+
+  size = proxy_frames::buildTemplatePart(frame, sizeof(frame), true, 3, state_binary::HttpMethod::Post, 1, 1, text,
+                                         length);
+  TEST_ASSERT_EQUAL_size_t(sizeof(state_binary::ProxyTemplateLargeState) + length, size);
+  state_binary::ProxyTemplateLargeState state;
+  memcpy(&state, frame, sizeof(state));
+  TEST_ASSERT_EQUAL_UINT16(length, state.textLen);
+  TEST_ASSERT_EQUAL_MEMORY(text, frame + sizeof(state), length);
+}
+
+// Benchmark: frames and bytes on the air for a full telemetry batch and a long upload template,
+// v1 fixed chunks against chunks sized by the negotiated large-frame link.
+void test_benchmark_air_bytes() {
+  const std::string body = telemetryBody(20);
+  const Totals uploadV1 = uploadTotals(body, false);
+  const Totals uploadLarge = uploadTotals(body, true);
+
+  std::string url = "https://telemetry.example.org/api/v1/devices/pio-weather/readings?format=compact&source=espnow";
+  url += "&fields=temperature,humidity,battery,rssi&retention=30d&token=0123456789abcdef0123456789abcdef";
+  const Totals templateV1 = templateTotals(url.c_str(), false);
+  const Totals templateLarge = templateTotals(url.c_str(), true);
+
+  printf("proxy_frames: upload %zu body bytes: v1 %zu frames %zu air bytes, large %zu frames %zu air bytes (%.0f%% less)\n",
+         body.size(), uploadV1.frames, uploadV1.airBytes, uploadLarge.frames, uploadLarge.airBytes,
+         100.0 * (1.0 - static_cast<double>(uploadLarge.airBytes) / uploadV1.airBytes));
+  printf("proxy_frames: template %zu bytes: v1 %zu frames %zu air bytes, large %zu frames %zu air bytes\n", url.size(),
+         templateV1.frames, templateV1.airBytes, templateLarge.frames, templateLarge.airBytes);
+
+  TEST_ASSERT_TRUE(uploadV1.built && uploadLarge.built && templateV1.built && templateLarge.built);
+  TEST_ASSERT_EQUAL_size_t(2, uploadLarge.frames);
+  TEST_ASSERT_LESS_THAN(uploadV1.frames, uploadLarge.frames);
+  TEST_ASSERT_LESS_THAN(uploadV1.airBytes, uploadLarge.airBytes);
+  TEST_ASSERT_EQUAL_size_t(1, templateLarge.frames);
+  TEST_ASSERT_LESS_THAN(templateV1.airBytes, templateLarge.airBytes);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_v1_chunk_is_the_fixed_struct);
+  RUN_TEST(test_large_chunk_carries_only_its_data);
+  RUN_TEST(test_template_parts_follow_the_link);
+  RUN_TEST(test_benchmark_air_bytes);
+  return UNITY_END();
+}
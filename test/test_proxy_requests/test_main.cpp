@@ -0,0 +1,160 @@
+#include <unity.h>
+
+#include <chrono>
+#include <new>
+
+#include <app_config.h>
+
+#include "app/espnow/payload_codec.h"
+#include "app/weather/open_meteo_requests.h"
+
+using namespace app::weather;
+namespace state_binary = app::espnow::state_binary;
+
+// Heap accounting for the whole binary: every operator new is counted and its size remembered so
+// the live and peak byte counts stay exact.
+namespace heap {
+size_t allocations = 0;
+size_t liveBytes = 0;
+size_t peakBytes = 0;
+
+void reset() {
+  allocations = 0;
+  peakBytes = liveBytes;
+}
+}  // namespace heap
+
+void* operator new(size_t size) {
+  auto* block = static_cast<std::max_align_t*>(malloc(sizeof(std::max_align_t) + size));
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<size_t*>(block) = size;
+  heap::allocations++;
+  heap::liveBytes += size;
+  heap::peakBytes = max(heap::peakBytes, heap::liveBytes);
+  return block + 1;
+}
+
+void operator delete(void* pointer) noexcept {
+  if (pointer == nullptr) {
+    return;
+  }
+  auto* block = static_cast<std::max_align_t*>(pointer) - 1;
+  heap::liveBytes -= *reinterpret_cast<size_t*>(block);
+  free(block);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+  operator delete(pointer);
+}
+
+namespace {
+
+// The request as the firmware built it before the table: URL through String(double, 7), then the
+// text proxy payload around it.
+String stringPathUrl(Area area) {
+  const auto& coordinates = kAreaCoordinatesE7[areaIndexOrDefault(area)];
+  String url = kOpenMeteoForecastBase;
+  url += "?latitude=";
+  url += String(coordinates.latitude / 1e7, 7);
+  url += "&longitude=";
+  url += String(coordinates.longitude / 1e7, 7);
+  url += "&current_weather=true";
+  return url;
+}
+
+String stringPathRequest(Area area) {
+  return app::espnow::codec::buildPayload({
+      {"state", "proxy_req"},
+      {"method", "GET"},
+      {"url", stringPathUrl(area)},
+      {"payload", "{}"},
+  });
+}
+
+// What sending costs on the table path: the frame is copied out of flash into the radio buffer.
+size_t tablePathRequest(Area area, uint8_t* frame) {
+  const auto& request = currentWeatherRequest(area);
+  memcpy(frame, &request, sizeof(request));
+  return sizeof(request);
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_table_urls_match_the_string_path() {
+  for (size_t index = 0; index < kAreaCount; ++index) {
+    const auto area = static_cast<Area>(index);
+    TEST_ASSERT_EQUAL_STRING(stringPathUrl(area).c_str(), currentWeatherRequest(area).url);
+  }
+}
+
+void test_table_requests_are_ready_to_send() {
+  for (const auto& request : kCurrentWeatherRequests) {
+    TEST_ASSERT_TRUE(state_binary::hasTypeAndSize(reinterpret_cast<const uint8_t*>(&request), sizeof(request),
+                                                  state_binary::Type::ProxyReq, sizeof(request)));
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(state_binary::HttpMethod::Get), request.method);
+  }
+}
+
+void test_unknown_area_falls_back_to_jakarta_pusat() {
+  const auto& fallback = currentWeatherRequest(static_cast<Area>(kAreaCount));
+  TEST_ASSERT_EQUAL_PTR(&kCurrentWeatherRequests[0], &fallback);
+  TEST_ASSERT_EQUAL_PTR(&kCurrentWeatherTemplateRequests[0],
+                        &currentWeatherTemplateRequest(static_cast<Area>(kAreaCount)));
+}
+
+// Benchmark: heap allocations, peak heap and host time per request for the String path the
+// firmware used to run against the flash-resident table.
+void test_benchmark_heap_and_time_per_request() {
+  static constexpr int kRequests = 20000;
+  const auto area = static_cast<Area>(WEATHER_AREA_INDEX);
+
+  heap::reset();
+  const size_t liveBefore = heap::liveBytes;
+  auto start = std::chrono::steady_clock::now();
+  size_t stringBytes = 0;
+  for (int index = 0; index < kRequests; ++index) {
+    stringBytes += stringPathRequest(area).length();
+  }
+  const double stringNs =
+      std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kRequests;
+  const size_t stringAllocations = heap::allocations;
+  const size_t stringPeak = heap::peakBytes - liveBefore;
+
+  heap::reset();
+  uint8_t frame[sizeof(state_binary::ProxyReqState)];
+  start = std::chrono::steady_clock::now();
+  size_t tableBytes = 0;
+  for (int index = 0; index < kRequests; ++index) {
+    tableBytes += tablePathRequest(area, frame);
+    asm volatile("" : : "r"(frame) : "memory");
+  }
+  const double tableNs =
+      std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kRequests;
+  const size_t tableAllocations = heap::allocations;
+  const size_t tablePeak = heap::peakBytes - liveBefore;
+
+  printf("proxy_requests: String path %.1f allocations and %zu B peak heap, %.0f ns per request; "
+         "table %.1f allocations and %zu B peak heap, %.0f ns per request (host)\n",
+         static_cast<double>(stringAllocations) / kRequests, stringPeak, stringNs,
+         static_cast<double>(tableAllocations) / kRequests, tablePeak, tableNs);
+
+  TEST_ASSERT_EQUAL_size_t(0, tableAllocations);
+  TEST_ASSERT_EQUAL_size_t(0, tablePeak);
+  TEST_ASSERT_TRUE(stringAllocations >= static_cast<size_t>(kRequests));
+  TEST_ASSERT_EQUAL_size_t(kRequests * sizeof(state_binary::ProxyReqState), tableBytes);
+  TEST_ASSERT_GREATER_THAN(0, stringBytes);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_table_urls_match_the_string_path);
+  RUN_TEST(test_table_requests_are_ready_to_send);
+  RUN_TEST(test_unknown_area_falls_back_to_jakarta_pusat);
+  RUN_TEST(test_benchmark_heap_and_time_per_request);
+  return UNITY_END();
+}
@@ -0,0 +1,188 @@
+#include <unity.h>
+
+#include <cmath>
+#include <vector>
+
+#include "app/input/battery/soc_estimator.h"
+#include "app/power/report_policy.h"
+
+using app::power::ReportPolicy;
+
+namespace {
+
+static constexpr uint16_t kCapacityMah = 1000;
+static constexpr double kInternalResistanceOhm = 0.150;
+static constexpr uint32_t kStepMs = 60UL * 1000UL;
+
+// Resting voltage for a state of charge, the inverse of the estimator's table.
+uint16_t restingMvFor(double socCenti) {
+  uint16_t mv = 3270;
+  while (mv < 4200 && SocEstimator::socFromRestingMv(static_cast<uint16_t>(mv + 1)) <= socCenti) {
+    mv++;
+  }
+  return mv;
+}
+
+// BatteryManager::determineState thresholds
+BatteryState stateFor(int percent) {
+  if (percent <= 10) return BATTERY_STATE_CRITICAL;
+  if (percent <= 25) return BATTERY_STATE_LOW;
+  if (percent <= 50) return BATTERY_STATE_MEDIUM;
+  if (percent <= 75) return BATTERY_STATE_HIGH;
+  return BATTERY_STATE_FULL;
+}
+
+struct Point {
+  uint32_t nowMs;
+  double trueSocCenti;
+  uint8_t percent;
+  uint16_t runtimeMinutes;
+};
+
+// Discharges a cell from `startSocCenti` at the power policy's load (the load the device really
+// draws) until it is empty. The estimator is told the policy's load, or `fixedLoadMa` as it was
+// before the policy fed it.
+std::vector<Point> discharge(double startSocCenti, bool policyLoad, uint16_t fixedLoadMa) {
+  SocEstimator::Config config;
+  config.capacityMah = kCapacityMah;
+  SocEstimator estimator(config);
+  ReportPolicy policy;
+
+  std::vector<Point> points;
+  double socCenti = startSocCenti;
+  uint32_t nowMs = 0;
+  uint8_t percent = static_cast<uint8_t>(socCenti / 100);
+  while (socCenti > 0) {
+    policy.update(stateFor(percent), CHARGING_NOT_CONNECTED, percent);
+    const uint16_t loadMa = policy.loadMa();
+
+    SocEstimator::Input input;
+    input.voltageMv = static_cast<uint16_t>(restingMvFor(socCenti) - lround(loadMa * kInternalResistanceOhm));
+    input.loadMa = policyLoad ? loadMa : fixedLoadMa;
+    input.nowMs = nowMs;
+    const SocEstimator::Estimate estimate = estimator.update(input);
+    percent = estimate.percent;
+    points.push_back({nowMs, socCenti, estimate.percent, estimate.runtimeMinutes});
+
+    socCenti -= 10000.0 * loadMa * kStepMs / 3600000.0 / kCapacityMah;
+    nowMs += kStepMs;
+  }
+  points.push_back({nowMs, 0, 0, 0});
+  return points;
+}
+
+double minutesLeft(const std::vector<Point>& points, size_t index) {
+  return (points.back().nowMs - points[index].nowMs) / 60000.0;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_table_end_points() {
+  TEST_ASSERT_EQUAL_UINT16(10000, SocEstimator::socFromRestingMv(4250));
+  TEST_ASSERT_EQUAL_UINT16(0, SocEstimator::socFromRestingMv(3200));
+  TEST_ASSERT_EQUAL_UINT16(5000, SocEstimator::socFromRestingMv(3840));
+  // interpolated halfway between 3.84 V (50 %) and 3.85 V (55 %)
+  TEST_ASSERT_EQUAL_UINT16(5250, SocEstimator::socFromRestingMv(3845));
+}
+
+void test_cold_cell_and_load_are_compensated() {
+  SocEstimator::Config config;
+  SocEstimator estimator(config);
+
+  SocEstimator::Input input;
+  input.voltageMv = 3840;
+  TEST_ASSERT_EQUAL_UINT8(50, estimator.update(input).percent);
+
+  // 150 mOhm at 100 mA: the terminal reads 15 mV below the resting voltage
+  input.voltageMv = 3840 - 15;
+  input.loadMa = 100;
+  TEST_ASSERT_EQUAL_UINT16(3840, estimator.update(input).restingMv);
+
+  // 1.5 mV/C: at 0 C the cell reads 37 mV low for the same charge
+  input.loadMa = 0;
+  input.voltageMv = 3803;
+  input.temperatureValid = true;
+  input.temperature10 = 0;
+  TEST_ASSERT_EQUAL_UINT16(3840, estimator.update(input).restingMv);
+}
+
+void test_policy_load_follows_the_level() {
+  ReportPolicy policy;
+  policy.update(BATTERY_STATE_FULL, CHARGING_NOT_CONNECTED, 90);
+  TEST_ASSERT_EQUAL_UINT16(80, policy.loadMa());
+  policy.update(BATTERY_STATE_MEDIUM, CHARGING_NOT_CONNECTED, 40);
+  TEST_ASSERT_EQUAL_UINT16(75, policy.loadMa());
+  policy.update(BATTERY_STATE_LOW, CHARGING_NOT_CONNECTED, 20);
+  TEST_ASSERT_EQUAL_UINT16(72, policy.loadMa());
+  policy.update(BATTERY_STATE_CRITICAL, CHARGING_NOT_CONNECTED, 5);
+  TEST_ASSERT_EQUAL_UINT16(70, policy.loadMa());
+  policy.update(BATTERY_STATE_CRITICAL, CHARGING_IN_PROGRESS, 5);
+  TEST_ASSERT_EQUAL_UINT16(80, policy.loadMa());
+}
+
+void test_charging_stops_the_rate() {
+  SocEstimator::Config config;
+  config.rateWindowMs = 60000;
+  SocEstimator estimator(config);
+  SocEstimator::Input input;
+  input.loadMa = 80;
+  input.voltageMv = 3900;
+  estimator.update(input);
+  input.nowMs = 60000;
+  input.voltageMv = 3880;
+  estimator.update(input);
+  TEST_ASSERT_GREATER_THAN(0, estimator.dischargeRateCentiPerHour());
+
+  input.charging = true;
+  input.nowMs = 120000;
+  TEST_ASSERT_EQUAL_UINT16(SocEstimator::kRuntimeUnknown, estimator.update(input).runtimeMinutes);
+}
+
+// Benchmark: a full discharge at the policy's load. Percent error against the true charge, and
+// remaining-runtime error once a rate is measured and at boot (capacity over load, before any
+// rate), with the policy's load against the fixed 80 mA the estimator used to get.
+void test_benchmark_discharge_curve() {
+  const std::vector<Point> points = discharge(10000, true, 0);
+  double worstPercent = 0;
+  double worstRuntime = 0;
+  for (size_t index = 0; index + 1 < points.size(); ++index) {
+    worstPercent = std::max(worstPercent, std::fabs(points[index].percent - points[index].trueSocCenti / 100));
+    // runtime from the measured rate, between 90 % and 15 % true charge
+    if (points[index].nowMs >= 30 * 60000UL && points[index].trueSocCenti <= 9000 &&
+        points[index].trueSocCenti >= 1500) {
+      const double left = minutesLeft(points, index);
+      worstRuntime = std::max(worstRuntime, std::fabs(points[index].runtimeMinutes - left) / left);
+    }
+  }
+
+  // boot at 30 %, 20 % and 8 %: the first estimate is capacity over load
+  double bootError[2] = {0, 0};
+  for (double startSoc : {3000.0, 2000.0, 800.0}) {
+    for (int policyLoad = 0; policyLoad < 2; ++policyLoad) {
+      const std::vector<Point> boot = discharge(startSoc, policyLoad == 1, 80);
+      const double left = minutesLeft(boot, 0);
+      bootError[policyLoad] = std::max(bootError[policyLoad], std::fabs(boot[0].runtimeMinutes - left) / left);
+    }
+  }
+
+  printf("soc_estimator: %zu min to empty at policy load, worst percent error %.1f points, worst runtime "
+         "error %.0f%% (measured rate); boot runtime error %.0f%% at fixed 80 mA, %.0f%% at policy load\n",
+         points.size() - 1, worstPercent, 100 * worstRuntime, 100 * bootError[0], 100 * bootError[1]);
+
+  TEST_ASSERT_TRUE(worstPercent <= 3.0);
+  TEST_ASSERT_TRUE(worstRuntime < 0.2);
+  TEST_ASSERT_TRUE(bootError[1] < bootError[0]);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_table_end_points);
+  RUN_TEST(test_cold_cell_and_load_are_compensated);
+  RUN_TEST(test_policy_load_follows_the_level);
+  RUN_TEST(test_charging_stops_the_rate);
+  RUN_TEST(test_benchmark_discharge_curve);
+  return UNITY_END();
+}
@@ -0,0 +1,247 @@
+#include <unity.h>
+
+#include <cmath>
+#include <random>
+
+#include "app/espnow/state_delta.h"
+
+using namespace app::espnow;
+
+namespace {
+
+static constexpr uint8_t kKeyframeInterval = 10;
+
+// What the master does with the stream: keep the last full record per type, patch it with the
+// fields of each delta, and report a sequence gap instead of guessing.
+class Decoder {
+ public:
+  // Returns false on a sequence gap; `out` then holds nothing new.
+  bool apply(const uint8_t* frame, size_t size, bool isDelta, uint8_t* out, size_t& outSize) {
+    if (!isDelta) {
+      const auto* header = reinterpret_cast<const state_binary::Header*>(frame);
+      const int index = layoutIndex(header->type);
+      memcpy(last[index], frame, size);
+      sequence[index] = header->reserved;
+      outSize = size;
+      memcpy(out, frame, size);
+      return true;
+    }
+
+    const auto* delta = reinterpret_cast<const state_binary::StateDeltaState*>(frame);
+    const int index = delta->typeSequence >> state_binary::kDeltaSequenceBits;
+    const uint8_t deltaSequence = delta->typeSequence & state_binary::kDeltaSequenceMask;
+    if (((sequence[index] + 1) & state_binary::kDeltaSequenceMask) != deltaSequence) {
+      return false;
+    }
+    const RecordLayout& layout = kDeltaLayouts[index];
+    size_t pos = sizeof(state_binary::StateDeltaState);
+    for (uint8_t field = 0; field < layout.fieldCount; ++field) {
+      if ((delta->changedMask & (1U << field)) != 0) {
+        memcpy(last[index] + layout.fields[field].offset, frame + pos, layout.fields[field].size);
+        pos += layout.fields[field].size;
+      }
+    }
+    sequence[index]++;
+    outSize = layout.size;
+    memcpy(out, last[index], layout.size);
+    return pos == size;
+  }
+
+ private:
+  static int layoutIndex(uint8_t type) {
+    for (size_t index = 0; index < kDeltaLayoutCount; ++index) {
+      if (static_cast<uint8_t>(kDeltaLayouts[index].type) == type) {
+        return static_cast<int>(index);
+      }
+    }
+    return 0;
+  }
+
+  uint8_t last[kDeltaLayoutCount][kMaxDeltaRecordBytes] = {};
+  uint8_t sequence[kDeltaLayoutCount] = {};
+};
+
+state_binary::SensorState sensorRecord(int16_t temperature10, uint16_t humidity10) {
+  state_binary::SensorState record = {};
+  state_binary::initHeader(record.header, state_binary::Type::Sensor);
+  record.temperature10 = temperature10;
+  record.humidity10 = humidity10;
+  return record;
+}
+
+state_binary::WeatherState weatherRecord(int hour, int16_t temperature10, int16_t windspeed10, uint16_t direction) {
+  state_binary::WeatherState record = {};
+  state_binary::initHeader(record.header, state_binary::Type::Weather);
+  record.ok = 1;
+  record.code = 200;
+  snprintf(record.time, sizeof(record.time), "2026-10-%02uT%02u:00", static_cast<unsigned>(1 + hour / 24) % 32,
+           static_cast<unsigned>(hour % 24));
+  record.temperature10 = temperature10;
+  record.windspeed10 = windspeed10;
+  record.winddirection = direction;
+  return record;
+}
+
+// Encodes `record`, decodes it like the master and checks the master ends up with the record;
+// adds the bytes sent to `sent`.
+template <typename Record>
+void sendAndCheck(StateDeltaEncoder& encoder, Decoder& decoder, Record record, size_t* sent = nullptr) {
+  uint8_t frame[kMaxDeltaRecordBytes];
+  bool delta = false;
+  const size_t size =
+      encoder.encode(reinterpret_cast<const uint8_t*>(&record), sizeof(record), frame, sizeof(frame), delta);
+  TEST_ASSERT_GREATER_THAN(0, size);
+
+  uint8_t decoded[kMaxDeltaRecordBytes];
+  size_t decodedSize = 0;
+  TEST_ASSERT_TRUE(decoder.apply(frame, size, delta, decoded, decodedSize));
+  TEST_ASSERT_EQUAL_size_t(sizeof(record), decodedSize);
+  // keyframes carry their sequence in the header, which the source record leaves at 0
+  reinterpret_cast<state_binary::Header*>(decoded)->reserved = 0;
+  TEST_ASSERT_EQUAL_MEMORY(&record, decoded, sizeof(record));
+  if (sent != nullptr) {
+    *sent += size;
+  }
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_deltas_rebuild_the_record() {
+  StateDeltaEncoder encoder(kKeyframeInterval);
+  Decoder decoder;
+  for (int update = 0; update < 25; ++update) {
+    sendAndCheck(encoder, decoder, weatherRecord(12, static_cast<int16_t>(215 + update % 3), 55, 270));
+  }
+  TEST_ASSERT_EQUAL_UINT32(3, encoder.stats().keyframes);
+  TEST_ASSERT_EQUAL_UINT32(22, encoder.stats().deltas);
+
+  // a changed 2-byte field plus the 2-byte delta header is half of the 8-byte SensorState
+  StateDeltaEncoder sensorEncoder(kKeyframeInterval);
+  Decoder sensorDecoder;
+  size_t sent = 0;
+  sendAndCheck(sensorEncoder, sensorDecoder, sensorRecord(215, 480));
+  sendAndCheck(sensorEncoder, sensorDecoder, sensorRecord(216, 480), &sent);
+  TEST_ASSERT_EQUAL_size_t(sizeof(state_binary::StateDeltaState) + 2, sent);
+  sendAndCheck(sensorEncoder, sensorDecoder, sensorRecord(216, 480), &sent);
+  TEST_ASSERT_EQUAL_size_t(2 * sizeof(state_binary::StateDeltaState) + 2, sent);
+}
+
+void test_hourly_weather_sends_only_the_clock() {
+  StateDeltaEncoder encoder(kKeyframeInterval);
+  Decoder decoder;
+  sendAndCheck(encoder, decoder, weatherRecord(12, 215, 55, 270));
+  size_t sent = 0;
+  sendAndCheck(encoder, decoder, weatherRecord(13, 215, 55, 270), &sent);
+  TEST_ASSERT_EQUAL_size_t(sizeof(state_binary::StateDeltaState) + 6, sent);
+
+  // midnight also changes the date
+  sent = 0;
+  sendAndCheck(encoder, decoder, weatherRecord(23, 215, 55, 270));
+  sendAndCheck(encoder, decoder, weatherRecord(24, 215, 55, 270), &sent);
+  TEST_ASSERT_EQUAL_size_t(sizeof(state_binary::StateDeltaState) + 10 + 6, sent);
+}
+
+void test_sequence_wraps_in_the_delta_header() {
+  StateDeltaEncoder encoder(255);
+  Decoder decoder;
+  for (int update = 0; update < 100; ++update) {
+    sendAndCheck(encoder, decoder, sensorRecord(static_cast<int16_t>(update), 480));
+  }
+  TEST_ASSERT_EQUAL_UINT32(1, encoder.stats().keyframes);
+}
+
+void test_sequence_gap_is_detected_and_keyframe_resyncs() {
+  StateDeltaEncoder encoder(kKeyframeInterval);
+  Decoder decoder;
+  sendAndCheck(encoder, decoder, weatherRecord(3, 200, 55, 270));
+
+  // a delta lost on the air
+  auto lost = weatherRecord(3, 201, 55, 270);
+  uint8_t frame[kMaxDeltaRecordBytes];
+  bool delta = false;
+  encoder.encode(reinterpret_cast<const uint8_t*>(&lost), sizeof(lost), frame, sizeof(frame), delta);
+
+  auto next = weatherRecord(3, 202, 56, 270);
+  const size_t size =
+      encoder.encode(reinterpret_cast<const uint8_t*>(&next), sizeof(next), frame, sizeof(frame), delta);
+  TEST_ASSERT_TRUE(delta);
+  uint8_t decoded[kMaxDeltaRecordBytes];
+  size_t decodedSize = 0;
+  TEST_ASSERT_FALSE(decoder.apply(frame, size, delta, decoded, decodedSize));
+
+  // KeyframeReqCommand answer
+  const size_t keyframeSize = encoder.keyframe(static_cast<uint8_t>(state_binary::Type::Weather), frame, sizeof(frame));
+  TEST_ASSERT_EQUAL_size_t(sizeof(state_binary::WeatherState), keyframeSize);
+  TEST_ASSERT_TRUE(decoder.apply(frame, keyframeSize, false, decoded, decodedSize));
+  sendAndCheck(encoder, decoder, weatherRecord(3, 203, 56, 270));
+}
+
+void test_untracked_types_pass_through() {
+  StateDeltaEncoder encoder(kKeyframeInterval);
+  state_binary::BatteryState battery = {};
+  state_binary::initHeader(battery.header, state_binary::Type::Battery);
+  uint8_t frame[kMaxDeltaRecordBytes];
+  bool delta = false;
+  TEST_ASSERT_EQUAL_size_t(0, encoder.encode(reinterpret_cast<const uint8_t*>(&battery), sizeof(battery), frame,
+                                             sizeof(frame), delta));
+}
+
+// Benchmark: payload bytes per update with deltas against full records, for a day of 15 s
+// sensor readings and a week of hourly weather updates.
+void test_benchmark_bytes_per_update() {
+  std::mt19937 rng(5);
+  std::normal_distribution<double> noise(0.0, 0.4);
+
+  StateDeltaEncoder encoder(kKeyframeInterval);
+  Decoder decoder;
+  const int sensorUpdates = 24 * 3600 / 15;
+  size_t sensorBytes = 0;
+  for (int update = 0; update < sensorUpdates; ++update) {
+    const double day = sin(update * 15 * 2 * M_PI / 86400);
+    sendAndCheck(encoder, decoder,
+                 sensorRecord(static_cast<int16_t>(lround(220 + 30 * day + noise(rng))),
+                              static_cast<uint16_t>(lround(550 - 100 * day + noise(rng) * 3))),
+                 &sensorBytes);
+  }
+
+  const int weatherUpdates = 7 * 24;
+  size_t weatherBytes = 0;
+  for (int hour = 0; hour < weatherUpdates; ++hour) {
+    const double day = sin(hour * 2 * M_PI / 24);
+    sendAndCheck(encoder, decoder,
+                 weatherRecord(hour, static_cast<int16_t>(lround(150 + 60 * day)),
+                               static_cast<int16_t>(rng() % 4 == 0 ? 40 + rng() % 30 : 55),
+                               static_cast<uint16_t>(rng() % 3 == 0 ? rng() % 360 : 270)),
+                 &weatherBytes);
+  }
+
+  const double sensorPerUpdate = static_cast<double>(sensorBytes) / sensorUpdates;
+  const double weatherPerUpdate = static_cast<double>(weatherBytes) / weatherUpdates;
+  const auto& stats = encoder.stats();
+  printf("state_delta: sensor %.2f bytes/update (full %zu), weather %.2f bytes/update (full %zu), "
+         "%lu keyframes %lu deltas, %lu -> %lu bytes (%.0f%% saved)\n",
+         sensorPerUpdate, sizeof(state_binary::SensorState), weatherPerUpdate, sizeof(state_binary::WeatherState),
+         static_cast<unsigned long>(stats.keyframes), static_cast<unsigned long>(stats.deltas),
+         static_cast<unsigned long>(stats.rawBytes), static_cast<unsigned long>(stats.encodedBytes),
+         100.0 * (1.0 - static_cast<double>(stats.encodedBytes) / stats.rawBytes));
+
+  TEST_ASSERT_EQUAL_UINT32((sensorUpdates + weatherUpdates) * 1U, stats.keyframes + stats.deltas);
+  // deltas have to pay for themselves: at least a third off sensor readings, half off weather
+  TEST_ASSERT_TRUE(sensorPerUpdate <= sizeof(state_binary::SensorState) * 2.0 / 3.0);
+  TEST_ASSERT_TRUE(weatherPerUpdate <= sizeof(state_binary::WeatherState) / 2.0);
+  TEST_ASSERT_LESS_THAN(stats.rawBytes, stats.encodedBytes);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_deltas_rebuild_the_record);
+  RUN_TEST(test_hourly_weather_sends_only_the_clock);
+  RUN_TEST(test_sequence_wraps_in_the_delta_header);
+  RUN_TEST(test_sequence_gap_is_detected_and_keyframe_resyncs);
+  RUN_TEST(test_untracked_types_pass_through);
+  RUN_TEST(test_benchmark_bytes_per_update);
+  return UNITY_END();
+}
@@ -0,0 +1,219 @@
+#include <unity.h>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <LittleFS.h>
+
+#include "app/history/timeseries_store.h"
+#include "app/history/ts_codec.h"
+
+using namespace app::history;
+
+namespace {
+
+struct Sample {
+  uint32_t timeS;
+  int32_t values[2];
+};
+
+// 30 days of 15 s sensor samples: diurnal temperature/humidity with noise and an occasional
+// 1 s jitter on the timestamp, as the input task produces them
+std::vector<Sample> diurnalSeries(uint32_t days) {
+  std::mt19937 rng(1);
+  std::normal_distribution<double> noise(0.0, 0.3);
+  std::vector<Sample> samples;
+  const uint32_t count = days * 24 * 3600 / 15;
+  samples.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    const double day = sin(i * 15 * 2 * M_PI / 86400);
+    Sample sample;
+    sample.timeS = 1700000000 + i * 15 + (rng() % 10 == 0 ? 1 : 0);
+    sample.values[0] = static_cast<int32_t>(lround(280 + 30 * day + noise(rng)));
+    sample.values[1] = static_cast<int32_t>(lround(650 - 100 * day + noise(rng) * 3));
+    samples.push_back(sample);
+  }
+  return samples;
+}
+
+std::vector<uint8_t> encode(const std::vector<Sample>& samples) {
+  std::vector<uint8_t> file;
+  BlockEncoder encoder;
+  encoder.reset(2);
+  for (const Sample& sample : samples) {
+    if (!encoder.append(sample.timeS, sample.values)) {
+      file.insert(file.end(), encoder.data(), encoder.data() + kBlockBytes);
+      encoder.reset(2);
+      encoder.append(sample.timeS, sample.values);
+    }
+  }
+  file.insert(file.end(), encoder.data(), encoder.data() + kBlockBytes);
+  return file;
+}
+
+void countSample(void* context, uint32_t, const int32_t*) {
+  (*static_cast<size_t*>(context))++;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+void setUp() {
+  stub::resetFs();
+}
+void tearDown() {}
+
+void test_zigzag_varint_round_trip() {
+  const int32_t values[] = {0, 1, -1, 63, -64, 64, 1000000, -1000000, INT32_MAX, INT32_MIN};
+  for (int32_t value : values) {
+    uint8_t buffer[5];
+    const size_t length = putVarint(buffer, zigzagEncode(value));
+    size_t pos = 0;
+    uint32_t raw = 0;
+    TEST_ASSERT_TRUE(getVarint(buffer, length, pos, raw));
+    TEST_ASSERT_EQUAL_size_t(length, pos);
+    TEST_ASSERT_EQUAL_INT32(value, zigzagDecode(raw));
+  }
+}
+
+void test_block_rejects_time_going_backwards() {
+  BlockEncoder encoder;
+  encoder.reset(2);
+  const int32_t values[] = {1, 2};
+  TEST_ASSERT_TRUE(encoder.append(100, values));
+  TEST_ASSERT_TRUE(encoder.append(115, values));
+  TEST_ASSERT_FALSE(encoder.append(114, values));
+  TEST_ASSERT_EQUAL_UINT16(2, encoder.count());
+}
+
+void test_corrupt_block_is_rejected() {
+  BlockEncoder encoder;
+  encoder.reset(2);
+  const int32_t values[] = {1, 2};
+  encoder.append(100, values);
+  uint8_t block[kBlockBytes];
+  memcpy(block, encoder.data(), sizeof(block));
+  block[0] ^= 0xFF;
+
+  BlockDecoder decoder;
+  TEST_ASSERT_FALSE(decoder.open(block, sizeof(block)));
+  TEST_ASSERT_FALSE(decoder.open(encoder.data(), sizeof(BlockHeader) - 1));
+}
+
+void test_downsampler_aligns_windows() {
+  WindowAggregate out[4];
+  Downsampler downsampler(60, 1, out, 4);
+  const int32_t a[] = {10};
+  const int32_t b[] = {20};
+  const int32_t c[] = {-5};
+  downsampler.add(125, a);
+  downsampler.add(170, b);
+  downsampler.add(185, c);
+  TEST_ASSERT_EQUAL_size_t(2, downsampler.finish());
+  TEST_ASSERT_EQUAL_UINT32(120, out[0].startS);
+  TEST_ASSERT_EQUAL_UINT16(2, out[0].count);
+  TEST_ASSERT_EQUAL_INT32(10, out[0].min[0]);
+  TEST_ASSERT_EQUAL_INT32(20, out[0].max[0]);
+  TEST_ASSERT_EQUAL_INT32(15, out[0].avg[0]);
+  TEST_ASSERT_EQUAL_UINT32(180, out[1].startS);
+  TEST_ASSERT_EQUAL_INT32(-5, out[1].avg[0]);
+}
+
+// Benchmark: storage cost per sample and the cost of a full decode and a one-day range query.
+void test_store_append_leaves_flash_to_loop() {
+  TimeSeriesStore store("test", 2, 8);
+  TEST_ASSERT_TRUE(store.begin());
+
+  // ~3 bytes per sample: 250 samples fill one 512-byte block and start the next
+  static constexpr size_t kSamples = 250;
+  const std::vector<Sample> samples = diurnalSeries(1);
+  for (size_t index = 0; index < kSamples; ++index) {
+    TEST_ASSERT_TRUE(store.append(samples[index].timeS, samples[index].values));
+  }
+  // the full block is sealed in RAM, not written, and still answers queries
+  TEST_ASSERT_TRUE(stub::fsBytesWritten == 0);
+  size_t seen = 0;
+  TEST_ASSERT_EQUAL_size_t(kSamples, store.forEach(0, UINT32_MAX, countSample, &seen));
+
+  // loop() writes it once
+  TEST_ASSERT_TRUE(store.loop());
+  TEST_ASSERT_TRUE(store.loop());
+  TEST_ASSERT_EQUAL_UINT32(1, store.stats().blocksWritten);
+  TEST_ASSERT_TRUE(stub::fsBytesWritten == kBlockBytes);
+  TEST_ASSERT_EQUAL_size_t(kSamples, store.forEach(0, UINT32_MAX, countSample, &seen));
+
+  // sync() writes the open block too
+  TEST_ASSERT_TRUE(store.sync());
+  TEST_ASSERT_EQUAL_UINT32(2, store.stats().blocksWritten);
+  TEST_ASSERT_EQUAL_size_t(kSamples, store.forEach(0, UINT32_MAX, countSample, &seen));
+}
+
+void test_benchmark_thirty_days() {
+  const std::vector<Sample> samples = diurnalSeries(30);
+  const std::vector<uint8_t> file = encode(samples);
+  const double bytesPerSample = static_cast<double>(file.size()) / samples.size();
+
+  auto start = std::chrono::steady_clock::now();
+  size_t decoded = 0;
+  bool lossless = true;
+  for (size_t offset = 0; offset < file.size(); offset += kBlockBytes) {
+    BlockDecoder decoder;
+    TEST_ASSERT_TRUE(decoder.open(&file[offset], kBlockBytes));
+    uint32_t timeS;
+    int32_t values[kMaxChannels];
+    while (decoder.next(timeS, values)) {
+      const Sample& expected = samples[decoded++];
+      lossless = lossless && expected.timeS == timeS && expected.values[0] == values[0] &&
+                 expected.values[1] == values[1];
+    }
+  }
+  const double decodeMs = elapsedMs(start);
+
+  start = std::chrono::steady_clock::now();
+  const uint32_t fromS = 1700000000 + 10 * 86400;
+  const uint32_t toS = fromS + 86400;
+  std::vector<WindowAggregate> windows(48);
+  Downsampler downsampler(3600, 2, windows.data(), windows.size());
+  for (size_t offset = 0; offset < file.size(); offset += kBlockBytes) {
+    BlockDecoder decoder;
+    decoder.open(&file[offset], kBlockBytes);
+    if (decoder.header().lastTimeS < fromS || decoder.header().firstTimeS > toS) {
+      continue;
+    }
+    uint32_t timeS;
+    int32_t values[kMaxChannels];
+    while (decoder.next(timeS, values)) {
+      if (timeS >= fromS && timeS <= toS) {
+        downsampler.add(timeS, values);
+      }
+    }
+  }
+  const size_t windowCount = downsampler.finish();
+  const double queryMs = elapsedMs(start);
+
+  printf("ts_codec: %zu samples in %zu blocks, %.2f bytes/sample (raw 8), full decode %.1f ms, "
+         "one-day query into %zu hourly windows %.2f ms\n",
+         samples.size(), file.size() / kBlockBytes, bytesPerSample, decodeMs, windowCount, queryMs);
+
+  TEST_ASSERT_TRUE(lossless);
+  TEST_ASSERT_EQUAL_size_t(samples.size(), decoded);
+  TEST_ASSERT_TRUE(bytesPerSample < 4.0);
+  TEST_ASSERT_EQUAL_size_t(25, windowCount);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_zigzag_varint_round_trip);
+  RUN_TEST(test_block_rejects_time_going_backwards);
+  RUN_TEST(test_corrupt_block_is_rejected);
+  RUN_TEST(test_downsampler_aligns_windows);
+  RUN_TEST(test_store_append_leaves_flash_to_loop);
+  RUN_TEST(test_benchmark_thirty_days);
+  return UNITY_END();
+}
@@ -0,0 +1,106 @@
+#include <unity.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "app/sensor/window_aggregator.h"
+
+using app::sensor::WindowAggregator;
+
+void setUp() {}
+void tearDown() {}
+
+void test_windows_align_to_multiples_of_the_length() {
+  WindowAggregator aggregator(300);
+  WindowAggregator::Window closed;
+  std::vector<WindowAggregator::Window> windows;
+  for (uint32_t timeS = 1000; timeS < 1000 + 3600; timeS += 15) {
+    const int16_t values[] = {250, 600};
+    if (aggregator.add(timeS, values, closed)) {
+      windows.push_back(closed);
+    }
+  }
+
+  // 1000 falls into [900, 1200); every later window is a full 20 samples
+  TEST_ASSERT_EQUAL_size_t(12, windows.size());
+  TEST_ASSERT_EQUAL_UINT32(900, windows[0].startS);
+  TEST_ASSERT_EQUAL_UINT16(14, windows[0].count);
+  for (size_t index = 1; index < windows.size(); ++index) {
+    TEST_ASSERT_EQUAL_UINT32(900 + index * 300, windows[index].startS);
+    TEST_ASSERT_EQUAL_UINT16(20, windows[index].count);
+  }
+
+  TEST_ASSERT_TRUE(aggregator.flush(closed));
+  TEST_ASSERT_EQUAL_UINT32(4500, closed.startS);
+  TEST_ASSERT_FALSE(aggregator.flush(closed));
+}
+
+// Fixed-point statistics against a double-precision reference over random windows.
+void test_statistics_match_double_reference() {
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> temperature(-400, 800);
+  std::uniform_int_distribution<int> humidity(0, 1000);
+  std::uniform_int_distribution<int> samples(1, 240);
+
+  for (int round = 0; round < 200; ++round) {
+    WindowAggregator aggregator(3600);
+    const int count = samples(rng);
+    std::vector<double> values[2];
+    for (int index = 0; index < count; ++index) {
+      const int16_t sample[] = {static_cast<int16_t>(temperature(rng)), static_cast<int16_t>(humidity(rng))};
+      values[0].push_back(sample[0]);
+      values[1].push_back(sample[1]);
+      WindowAggregator::Window unused;
+      aggregator.add(static_cast<uint32_t>(index * 15), sample, unused);
+    }
+
+    WindowAggregator::Window window;
+    TEST_ASSERT_TRUE(aggregator.flush(window));
+    TEST_ASSERT_EQUAL_UINT16(count, window.count);
+    for (size_t channel = 0; channel < WindowAggregator::kChannels; ++channel) {
+      double sum = 0;
+      double min = values[channel][0];
+      double max = values[channel][0];
+      for (double value : values[channel]) {
+        sum += value;
+        min = std::min(min, value);
+        max = std::max(max, value);
+      }
+      const double mean = sum / count;
+      double squares = 0;
+      for (double value : values[channel]) {
+        squares += (value - mean) * (value - mean);
+      }
+      const double variance = squares / count;
+
+      const auto& stats = window.channels[channel];
+      TEST_ASSERT_EQUAL_INT16(static_cast<int16_t>(min), stats.min);
+      TEST_ASSERT_EQUAL_INT16(static_cast<int16_t>(max), stats.max);
+      // mean in hundredths rounded, variance in hundredths squared truncated
+      TEST_ASSERT_INT_WITHIN(1, lround(mean * 10), stats.mean100);
+      TEST_ASSERT_INT_WITHIN(1, static_cast<long>(variance * 100), static_cast<long>(stats.variance10000));
+    }
+  }
+}
+
+void test_constant_input_has_zero_variance() {
+  WindowAggregator aggregator(60);
+  WindowAggregator::Window window;
+  for (uint32_t timeS = 0; timeS < 60; timeS += 5) {
+    const int16_t values[] = {-123, 456};
+    aggregator.add(timeS, values, window);
+  }
+  TEST_ASSERT_TRUE(aggregator.flush(window));
+  TEST_ASSERT_EQUAL_INT32(-1230, window.channels[0].mean100);
+  TEST_ASSERT_EQUAL_UINT32(0, window.channels[0].variance10000);
+  TEST_ASSERT_EQUAL_INT32(4560, window.channels[1].mean100);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_windows_align_to_multiples_of_the_length);
+  RUN_TEST(test_statistics_match_double_reference);
+  RUN_TEST(test_constant_input_has_zero_variance);
+  return UNITY_END();
+}